@@ -0,0 +1,46 @@
+#version 130
+#extension GL_ARB_uniform_buffer_object : require
+precision mediump float;
+
+//Per frame, see UniformBlocks.h
+layout(std140) uniform Frame
+{
+	mat4  uView;
+	mat4  uProjection;
+	mat4  uViewProjection;
+	vec4  uCameraPosition;
+	ivec4 uNbLights;
+	vec4  uLightPos[4];
+	vec4  uLightColor[4];
+};
+
+uniform vec4 uMtlCts;
+uniform sampler2DArray uTextures;
+
+varying vec3 vary_normal;
+varying vec4 vary_world_position;
+varying vec2 vary_UV;
+varying vec4 vary_color_layer;
+
+void main()
+{
+	float layer   = floor(vary_color_layer.a + 0.5);
+	vec3 texColor = layer < 0.0 ? vec3(0.0) : texture(uTextures, vec3(vary_UV, layer)).rgb;
+	vec3 color    = texColor + vary_color_layer.rgb;
+	vec3 normal   = normalize(vary_normal);
+	vec3 V        = normalize(uCameraPosition.xyz - vary_world_position.xyz);
+
+	vec3 light    = vec3(0.0);
+	for(int i = 0; i < uNbLights.x; i++)
+	{
+		vec3 lightDir = normalize(uLightPos[i].xyz - vary_world_position.xyz);
+		vec3 R        = reflect(-lightDir, normal);
+
+		vec3 ambient  = uMtlCts.x * color * uLightColor[i].rgb;
+		vec3 diffuse  = uMtlCts.y * max(0.0, dot(normal, lightDir)) * color * uLightColor[i].rgb;
+		vec3 specular = uMtlCts.z * pow(max(0.0, dot(R, V)), uMtlCts.w) * uLightColor[i].rgb;
+		light += ambient + diffuse + specular;
+	}
+
+	gl_FragColor  = vec4(light, 1.0);
+}
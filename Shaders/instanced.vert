@@ -0,0 +1,48 @@
+#version 130
+#extension GL_ARB_uniform_buffer_object : require
+precision mediump float;
+
+attribute vec3 vPosition;
+attribute vec2 vNormal; //octahedral
+attribute vec2 vUV;
+
+//Per instance
+attribute mat4 iModel;
+attribute vec4 iColorLayer; //rgb : color added to the texture, a : layer of the texture array (-1 : no texture)
+
+//Per frame, see UniformBlocks.h
+layout(std140) uniform Frame
+{
+	mat4  uView;
+	mat4  uProjection;
+	mat4  uViewProjection;
+	vec4  uCameraPosition;
+	ivec4 uNbLights;
+	vec4  uLightPos[4];
+	vec4  uLightColor[4];
+};
+
+varying vec3 vary_normal;
+varying vec4 vary_world_position;
+varying vec2 vary_UV;
+varying vec4 vary_color_layer;
+
+//The normals are octahedral encoded (see VertexFormat) : unfold them back on the unit sphere
+vec3 decodeNormal(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if(n.z < 0.0)
+		n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return normalize(n);
+}
+
+void main()
+{
+	vary_world_position = iModel * vec4(vPosition, 1.0);
+	gl_Position = uViewProjection * vary_world_position;
+
+	//The instances are only uniformly scaled : the model matrix transforms the normals correctly up to a scale factor
+	vary_normal = mat3(iModel) * decodeNormal(vNormal);
+	vary_UV = vUV;
+	vary_color_layer = iColorLayer;
+}
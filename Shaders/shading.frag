@@ -1,11 +1,28 @@
 #version 130
+#extension GL_ARB_uniform_buffer_object : require
 precision mediump float;
 
-uniform vec3 uMtlColor;
-uniform vec4 uMtlCts;
-uniform vec3 uLightPos;
-uniform vec3 uLightColor;
-uniform vec3 uCameraPosition;
+//Per frame, see UniformBlocks.h
+layout(std140) uniform Frame
+{
+	mat4  uView;
+	mat4  uProjection;
+	mat4  uViewProjection;
+	vec4  uCameraPosition;
+	ivec4 uNbLights;
+	vec4  uLightPos[4];
+	vec4  uLightColor[4];
+};
+
+//Per draw
+layout(std140) uniform Object
+{
+	mat4 uModel;
+	mat3 uInvModel3x3;
+	vec3 uMtlColor;
+	vec4 uMtlCts;
+};
+
 uniform sampler2D uTexture;
 
 varying vec3 vary_normal;
@@ -16,14 +33,19 @@ void main()
 {
     vec3 color    = texture2D(uTexture, vary_UV).rgb + uMtlColor;
 	vec3 normal   = normalize(vary_normal);
-	vec3 lightDir = normalize(uLightPos - vary_world_position.xyz);
-	vec3 V        = normalize(uCameraPosition - vary_world_position.xyz);
-	vec3 R        = reflect(-lightDir, normal);
-	
-	vec3 ambient  = uMtlCts.x * color * uLightColor;
-	vec3 diffuse  = uMtlCts.y * max(0.0, dot(normal, lightDir)) * color * uLightColor;
-	vec3 specular = uMtlCts.z * pow(max(0.0, dot(R, V)), uMtlCts.w) * uLightColor;
-    
-	
-	gl_FragColor  = vec4(ambient + diffuse + specular, 1.0);
+	vec3 V        = normalize(uCameraPosition.xyz - vary_world_position.xyz);
+
+	vec3 light    = vec3(0.0);
+	for(int i = 0; i < uNbLights.x; i++)
+	{
+		vec3 lightDir = normalize(uLightPos[i].xyz - vary_world_position.xyz);
+		vec3 R        = reflect(-lightDir, normal);
+
+		vec3 ambient  = uMtlCts.x * color * uLightColor[i].rgb;
+		vec3 diffuse  = uMtlCts.y * max(0.0, dot(normal, lightDir)) * color * uLightColor[i].rgb;
+		vec3 specular = uMtlCts.z * pow(max(0.0, dot(R, V)), uMtlCts.w) * uLightColor[i].rgb;
+		light += ambient + diffuse + specular;
+	}
+
+	gl_FragColor  = vec4(light, 1.0);
 }
@@ -1,25 +1,52 @@
 #version 130
+#extension GL_ARB_uniform_buffer_object : require
 precision mediump float;
 
 attribute vec3 vPosition;
-attribute vec3 vNormal;
+attribute vec2 vNormal; //octahedral
 attribute vec2 vUV;
 
-uniform mat4 uMVP;
-uniform mat4 uModel;
-uniform mat3 uInvModel3x3;
+//Per frame, see UniformBlocks.h
+layout(std140) uniform Frame
+{
+	mat4  uView;
+	mat4  uProjection;
+	mat4  uViewProjection;
+	vec4  uCameraPosition;
+	ivec4 uNbLights;
+	vec4  uLightPos[4];
+	vec4  uLightColor[4];
+};
+
+//Per draw
+layout(std140) uniform Object
+{
+	mat4 uModel;
+	mat3 uInvModel3x3;
+	vec3 uMtlColor;
+	vec4 uMtlCts;
+};
 
 varying vec3 vary_normal;
 varying vec4 vary_world_position;
 varying vec2 vary_UV;
 //varying vec4 varyColor;
 
+//The normals are octahedral encoded (see VertexFormat) : unfold them back on the unit sphere
+vec3 decodeNormal(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if(n.z < 0.0)
+		n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return normalize(n);
+}
+
 void main()
 {
-	gl_Position = uMVP*vec4(vPosition, 1.0);
+	gl_Position = uViewProjection * uModel * vec4(vPosition, 1.0);
 
   	//varyColor   = vec4(vColor, 1.0);
-	vary_normal = transpose(uInvModel3x3) * vNormal;
+	vary_normal = transpose(uInvModel3x3) * decodeNormal(vNormal);
 	vary_UV = vUV;
 	
 	vary_world_position = uModel * vec4(vPosition, 1.0);
@@ -0,0 +1,82 @@
+#ifndef BVH_H_
+#define BVH_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "Bounds.h"
+#include "Frustum.h"
+
+/**
+ *  A bounding volume hierarchy over a fixed set of items, one item per leaf.
+ *  It is built once (median split on the largest axis), then refitted when items move :
+ *  only the ancestors of the moved items get their boxes recomputed.
+ *  Refitting keeps the tree valid but not optimal, build() again if the items move a lot relative to each other
+ */
+class BVH {
+
+    public:
+        /**
+         *  Builds the tree
+         *   - bounds (std::vector<AABB> const&) : the box of each item, the items are their indices in this array
+         */
+        void build(std::vector<AABB> const& bounds);
+
+        /**
+         *  Changes the box of an item. The tree is updated by the next refit()
+         *   - item (uint32_t) : the item
+         *   - box (AABB const&) : its new box
+         */
+        void setBounds(uint32_t item, AABB const& box);
+
+        /**
+         *  Recomputes the boxes of the nodes containing a moved item
+         */
+        void refit();
+
+        /**
+         *  Finds the items in a frustum. The subtrees fully inside the frustum are not tested further
+         *   - frustum (Frustum const&) : the frustum
+         *   - visible (std::vector<uint32_t>&) : receives the visible items (it is cleared first)
+         */
+        void cull(Frustum const& frustum, std::vector<uint32_t>& visible) const;
+
+        /**
+         *  Finds the items whose box is crossed by a ray
+         *   - origin, dir (glm::vec3 const&) : the ray
+         *   - hits (std::vector<uint32_t>&) : receives the crossed items (it is cleared first)
+         */
+        void raycast(glm::vec3 const& origin, glm::vec3 const& dir, std::vector<uint32_t>& hits) const;
+
+        /**
+         *  Returns the number of items in the tree
+         */
+        uint32_t getNbItems() const { return (uint32_t)leafOf.size(); }
+
+    private:
+        static constexpr uint32_t NO_NODE = ~0u;
+
+        struct Node {
+            AABB bounds;
+            uint32_t parent;
+            uint32_t left, right; // the childs, or left == NO_NODE and right is the item of a leaf
+        };
+
+        /**
+         *  Builds the subtree of a range of items, returns its root
+         */
+        uint32_t build(std::vector<AABB> const& bounds, uint32_t* items, uint32_t count, uint32_t parent);
+
+        /**
+         *  Adds every item of a subtree to visible, without testing them
+         */
+        void addAll(uint32_t node, std::vector<uint32_t>& visible) const;
+
+        // the childs of a node are always after it : refitting in reverse order sees the childs first
+        std::vector<Node> nodes;
+        std::vector<uint32_t> leafOf; // the leaf of each item
+        std::vector<uint8_t> dirty;   // the box of the node must be recomputed
+        bool anyDirty = false;
+};
+
+#endif // BVH_H_
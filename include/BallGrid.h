@@ -0,0 +1,89 @@
+#ifndef BALLGRID_H_
+#define BALLGRID_H_
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+/**
+ *  The broadphase of the collisions between balls : a uniform grid over the table, its cells as wide as a ball.
+ *  Two touching balls are then in the same cell or in neighbouring cells, so the candidate pairs of a ball are
+ *  the balls of the 3x3 cells around it. Each cell is a linked list of its balls : a ball moving is only
+ *  relinked when it changes cell, which most moves do not
+ */
+class BallGrid {
+
+    public:
+        struct Pair {
+            uint32_t i, j;
+        };
+
+        /**
+         *  Constructor :
+         *   - length, width (float) : the table, centered on the origin (x along the length, z along the width)
+         *   - radius (float) : the balls
+         */
+        BallGrid(float length, float width, float radius);
+
+        /**
+         *  Adds a ball, its index is the number of balls added before it
+         *   - p (glm::vec2) : its center (x, z)
+         */
+        void add(glm::vec2 p);
+
+        /**
+         *  Updates the cell of a ball. Returns true if it changed
+         *   - i (uint32_t) : the ball
+         *   - p (glm::vec2) : its new center (x, z)
+         */
+        bool move(uint32_t i, glm::vec2 p);
+
+        /**
+         *  Takes a ball out of the grid (it fell in a pocket) : it is no longer a candidate, and must not be moved anymore
+         *   - i (uint32_t) : the ball
+         */
+        void remove(uint32_t i);
+
+        /**
+         *  Appends the candidate pairs of some balls : them and each ball of the cells around them.
+         *  A pair of two queried balls is given once, from the one of lowest index. Returns false if there were more
+         *  than maxPairs pairs : the pairs after it are dropped
+         *   - balls (std::vector<uint32_t> const&) : the queried balls
+         *   - queried (const uint8_t*) : for each ball, non zero if it is in balls
+         *   - pairs (std::vector<Pair>&) : receives the pairs
+         *   - maxPairs (uint32_t) : the size pairs can reach (its capacity, for it not to allocate)
+         */
+        bool findPairs(std::vector<uint32_t> const& balls, const uint8_t* queried, std::vector<Pair>& pairs,
+                       uint32_t maxPairs = ~0u) const;
+
+        /**
+         *  Appends the balls of the cells around a ball, itself excluded : those closer than 2 * cells radius to it
+         *   - i (uint32_t) : the ball, nothing is found for a ball removed
+         *   - cells (uint32_t) : how far from its cell, 1 for the 3x3 cells around it
+         *   - balls (std::vector<uint32_t>&) : receives the balls
+         */
+        void findNear(uint32_t i, uint32_t cells, std::vector<uint32_t>& balls) const;
+
+        /**
+         *  Returns the number of balls, and of cells
+         */
+        uint32_t size() const { return (uint32_t)cell.size(); }
+        uint32_t getNbCells() const { return (uint32_t)head.size(); }
+
+    private:
+        static constexpr uint32_t NONE = ~0u;
+
+        uint32_t cellOf(glm::vec2 p) const;
+        void link(uint32_t i, uint32_t c);
+        void unlink(uint32_t i);
+
+        glm::vec2 origin;  // the corner of the table
+        float invCellSize;
+        uint32_t nx, nz;   // the cells along x and z
+
+        std::vector<uint32_t> head;        // the first ball of each cell
+        std::vector<uint32_t> next, prev;  // the lists of the cells, for each ball
+        std::vector<uint32_t> cell;        // the cell of each ball
+};
+
+#endif // BALLGRID_H_
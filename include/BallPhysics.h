@@ -0,0 +1,279 @@
+#ifndef BALLPHYSICS_H_
+#define BALLPHYSICS_H_
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "BallGrid.h"
+#include "TableCollision.h"
+#include "World.h"
+
+/**
+ *  The motion of the balls on the table, in table space (x along the length, z along the width, y up).
+ *  The state of the balls is stored by component (one array per coordinate) and sized by addBall() :
+ *  neither mode allocates while simulating (the event queue only grows when it is rebuilt).
+ *
+ *  Each ball is in one of five states, which decides the friction acting on it :
+ *   - Sliding : the contact point slips on the cloth, sliding friction brings it to rolling
+ *   - Rolling : the contact point does not slip, rolling friction slows the ball down
+ *   - Spinning : the ball turns on itself around the vertical axis, without moving
+ *   - Stationary : nothing to do
+ *   - Pocketed : the ball fell in a pocket, it is out of the simulation
+ *  The vertical spin decays in every state. Collisions (between balls, and against the rails of the table,
+ *  see TableCollision) change the velocity of the balls, which then slide again. The rails push the balls back
+ *  at the height of their noses, above the centers of the balls : the rebound depends on the spin (Han, 2005).
+ *
+ *  Between two events the acceleration of a ball is constant : its position is a quadratic of time, moved exactly.
+ *  The two modes only differ in how they find the collisions :
+ *   - FixedStep : the balls move by a fixed timestep, then the overlapping balls collide. The step is split in
+ *     substeps while a ball is fast enough to move more than maxTravel in it, so that balls do not pass through
+ *     each other. Only the balls not stationary are visited, and the pairs tested are the candidates of a BallGrid :
+ *     the cost of a step follows the moving balls, all the candidates of a step being tested at once by NarrowPhase
+ *   - EventDriven : the exact time of the next event (a contact, a state change) is solved from the trajectories,
+ *     and the simulation jumps straight to it. The events are kept in a priority queue : those of the balls
+ *     changed by an event are invalidated and computed again, the others stay. The contacts between balls are
+ *     only looked for among the balls of the BallGrid cells around, within the time a ball takes to move a radius :
+ *     a Window event then looks at the cells around it again
+ */
+class BallPhysics {
+
+    public:
+        enum class State : uint8_t { Stationary, Spinning, Rolling, Sliding, Pocketed };
+        enum class Mode : uint8_t { FixedStep, EventDriven };
+
+        // the events processed by a call of advance() at most, a guard : the rest of the frame is then taken in fixed steps
+        static constexpr uint32_t MAX_EVENTS = 100000;
+
+        struct Params {
+            float length, width;              // the table, centered on the origin (in scene units)
+            float radius;                     // the balls (in scene units)
+            float unitsPerMeter;              // the scale of the scene, for gravity and the friction coefficients
+            float timestep = 1.f / 120.f;     // in seconds, for the FixedStep mode
+            float maxTravel = 0.5f;           // in ball radius, the longest move of a ball in a substep of it
+            float slidingFriction = 0.2f;
+            float rollingFriction = 0.01f;
+            float spinningFriction = 0.044f;
+            float ballRestitution = 0.95f;
+            float cushionRestitution = 0.85f;
+            float cushionFriction = 0.2f;
+
+            // the rails (in scene units), 0 for the proportions of a pool table : the noses at 63.5% of the height
+            // of the balls, mouths of 2.05 (corners) and 2.2 (sides) ball diameters, rails 1.5 ball diameter wide
+            float noseHeight = 0.f;           // above the cloth
+            float cornerMouth = 0.f, sideMouth = 0.f;
+            float railWidth = 0.f;
+        };
+
+        /**
+         *  Constructor :
+         *   - params (Params const&) : the table, the balls and the coefficients
+         *   - mode (Mode) : how the collisions are found
+         */
+        BallPhysics(Params const& params, Mode mode = Mode::FixedStep);
+
+        /**
+         *  Adds a stationary ball. Returns its index
+         *   - position (glm::vec2) : its center on the table (x, z)
+         *   - orientation (glm::quat const&) : its orientation
+         */
+        uint32_t addBall(glm::vec2 position, glm::quat const& orientation = glm::quat(1.f, 0.f, 0.f, 0.f));
+
+        /**
+         *  Adds the ball of an entity having a body, from its transform. Returns its index
+         *   - world (World&) : the entities
+         *   - e (Entity) : the entity, written back by write()
+         */
+        uint32_t addBall(World& world, Entity e);
+
+        /**
+         *  Hits a ball : it starts sliding. A pocketed ball stays in its pocket
+         *   - i (uint32_t) : the ball
+         *   - velocity (glm::vec2) : its new velocity on the table (x, z), in scene units per second
+         *   - angularVelocity (glm::vec3) : its new angular velocity, in radians per second
+         */
+        void hit(uint32_t i, glm::vec2 velocity, glm::vec3 angularVelocity = glm::vec3(0.f));
+
+        /**
+         *  Changes how the collisions are found. The balls keep their state
+         *   - m (Mode) : the new mode
+         */
+        void setMode(Mode m) { mode = m; eventsValid = false; }
+        Mode getMode() const { return mode; }
+
+        /**
+         *  Advances the simulation by one timestep (FixedStep mode), in as many substeps as the fastest ball needs.
+         *  Returns the number of substeps
+         */
+        uint32_t step();
+
+        /**
+         *  Advances the simulation in the current mode : by whole timesteps, the remaining time being kept
+         *  for the next call, or from event to event up to the given time.
+         *  Returns the number of steps, or of events
+         *   - seconds (float) : the time elapsed
+         */
+        uint32_t advance(float seconds);
+
+        /**
+         *  Processes the next event (EventDriven mode). Returns its time, from the start of the simulation,
+         *  or a negative value if no ball moves anymore
+         */
+        double nextEvent();
+
+        /**
+         *  Writes the positions, orientations and velocities of the balls of entities back in them,
+         *  marking the transforms of the balls that moved. The orientations are only brought up to date here
+         *   - world (World&) : the entities
+         */
+        void write(World& world);
+
+        /**
+         *  Returns the table, the balls and the coefficients (the proportions of the rails filled in),
+         *  and what the balls hit on the table
+         */
+        Params const& getParams() const { return params; }
+        TableCollision const& getTable() const { return table; }
+
+        /**
+         *  Returns true if a ball is not stationary
+         */
+        bool isMoving() const { return nbMoving > 0; }
+
+        /**
+         *  Returns the number of balls, and the state of a ball
+         */
+        uint32_t size() const { return (uint32_t)px.size(); }
+        glm::vec2 getPosition(uint32_t i) const { return glm::vec2(px[i], pz[i]); }
+        glm::vec2 getVelocity(uint32_t i) const { return glm::vec2(vx[i], vz[i]); }
+        glm::vec3 getAngularVelocity(uint32_t i) const { return glm::vec3(wx[i], wy[i], wz[i]); }
+        glm::quat getOrientation(uint32_t i) const { return glm::quat(qw[i], qx[i], qy[i], qz[i]); }
+        State getState(uint32_t i) const { return state[i]; }
+
+    private:
+        enum class EventType : uint8_t { Transition, Cushion, Corner, Pocket, Ball, Window };
+
+        struct Event {
+            double time;
+            uint32_t i, j;               // the balls, j is the segment, corner or pocket of the table for the other types
+            uint32_t versionI, versionJ; // the versions of the balls when the event was computed
+            EventType type;
+        };
+
+        /**
+         *  Moves a ball by dt along its trajectory, changing its state at the transitions met
+         */
+        void move(uint32_t i, float dt);
+
+        /**
+         *  The transitions of a ball : sliding to rolling (snaps the angular velocity), rolling to spinning or stationary
+         */
+        void startRolling(uint32_t i);
+        void stop(uint32_t i);
+
+        /**
+         *  Stops a sliding or rolling ball whose velocity and slip are both below the resting speed : it would only
+         *  change state again an instant later. Two touching balls approaching slower than it rest on each other
+         *  (they stop approaching, without rebound)
+         */
+        void rest(uint32_t i);
+
+        /**
+         *  Adds a ball to the awake balls, those integrate() moves, if it is not one already
+         */
+        void wake(uint32_t i);
+        float getRestingSpeed() const { return 1e-3f * params.unitsPerMeter; } // 1 mm/s
+
+        /**
+         *  Returns the acceleration of a ball on the table, and in tau the time until its state changes
+         *  (infinity if it does not move)
+         */
+        glm::vec2 getAcceleration(uint32_t i, float& tau) const;
+
+        /**
+         *  Bounces a ball on the rails (normal : from the point of contact to the ball), or two touching balls on each other
+         */
+        void bounceRail(uint32_t i, glm::vec2 normal);
+        void bounceBalls(uint32_t i, uint32_t j);
+
+        /**
+         *  Drops a ball in a pocket
+         */
+        void pocketBall(uint32_t i, uint32_t pocket);
+
+        /**
+         *  The parts of step() : friction and motion, then the collisions found by overlap, solved where they happened
+         *  during the last dt (the balls are moved back along their velocities, bounced, then moved on)
+         */
+        void integrate(float dt);
+        void collideTable(float dt);
+        void collideBalls(float dt);
+
+        /**
+         *  Advances the balls by some time, in substeps as step() does. Returns their number
+         */
+        uint32_t stepFor(float seconds);
+
+        /**
+         *  The parts of nextEvent() : the events of every ball, those of one ball (with the balls around it but skip),
+         *  its window (until it moved a radius), and the delay before a contact along the current trajectories
+         *  (infinity if none before horizon)
+         */
+        void scheduleAll();
+        void schedule(uint32_t i, uint32_t skip);
+        void scheduleBall(uint32_t i);
+        void scheduleWindow(uint32_t i);
+        void scheduleNear(uint32_t i, uint32_t skip);
+        void schedulePair(uint32_t i, uint32_t j);
+        double segmentTime(uint32_t i, uint32_t k, double horizon) const;
+        double circleTime(uint32_t i, glm::vec2 center, float distance, bool solid, double horizon) const;
+        double ballTime(uint32_t i, uint32_t j, double horizon) const;
+        void push(double delay, EventType type, uint32_t i, uint32_t j);
+        uint32_t getMaxEventsPerBall() const;
+
+        /**
+         *  Removes the stale events from the top of the queue. Returns false if the queue is then empty
+         */
+        bool dropStale();
+
+        /**
+         *  Moves every ball to a time of the event simulation
+         */
+        void moveAllTo(double t);
+
+        Params params;
+        Mode mode;
+        float accumulator = 0.f;
+        uint32_t nbMoving = 0;
+
+        std::vector<float> px, pz;          // the position on the table
+        std::vector<float> vx, vz;          // the velocity
+        std::vector<float> wx, wy, wz;      // the angular velocity
+        std::vector<float> qw, qx, qy, qz;  // the orientation, as of the last write()
+        std::vector<float> ax, ay, az;      // the rotation since the last write() (axis times angle)
+        std::vector<State> state;
+
+        std::vector<Entity> entities;       // the entity of each ball, if it has one
+        std::vector<uint8_t> moved;         // the ball moved since the last write()
+        std::vector<uint32_t> awake;        // the balls that were not stationary at the last step, or were hit since
+        std::vector<uint8_t> isAwake;       // the balls of awake, as flags
+        std::vector<uint32_t> rolling;      // the balls sliding or rolling during the current step
+        std::vector<uint8_t> movedThisStep; // the balls of rolling, as flags
+        TableCollision table;
+        BallGrid grid;                      // the broadphase of collideBalls(), kept up to date by both modes
+        std::vector<BallGrid::Pair> pairs;  // the candidates of the current step
+        std::vector<float> candidateX, candidateZ; // the offsets of the candidates from their balls, for NarrowPhase
+        std::vector<uint32_t> contactMask;
+
+        // the event simulation : the balls are always at time now, the events are a heap (earliest first).
+        // An event is stale once one of its balls changed (its version was incremented), it is then skipped
+        double now = 0.0;
+        std::vector<Event> events;
+        std::vector<uint32_t> versions;
+        std::vector<double> windowEnd;      // when each ball will have moved a radius, infinity if it does not move
+        std::vector<uint32_t> near;         // the balls around the one scheduled
+        bool eventsValid = false;
+};
+
+#endif // BALLPHYSICS_H_
@@ -0,0 +1,122 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <chrono>
+#include <cstdint>
+
+#include "BallPhysics.h"
+
+class Benchmark {
+
+    public:
+        /**
+         *  Constructor :
+         *   - nbFrames (uint32_t) : how many frames are measured before the benchmark is done
+         *   - nbWarmupFrames (uint32_t) : how many frames are ignored at the start (driver warmup, first uploads)
+         */
+        Benchmark(uint32_t nbFrames, uint32_t nbWarmupFrames = 10);
+
+        /**
+         *  Marks the start and the end of a frame
+         */
+        void beginFrame();
+        void endFrame();
+
+        /**
+         *  Marks the start and the end of the draw call submission inside the frame
+         */
+        void beginSubmit();
+        void endSubmit();
+
+        /**
+         *  Marks the start and the end of a scene raycast inside the frame
+         */
+        void beginPick();
+        void endPick();
+
+        /**
+         *  Adds the number of openGL state calls of the frame (see GLState::Stats)
+         *   - issued (uint32_t) : the calls that reached the driver
+         *   - elided (uint32_t) : the calls skipped because they would not change anything
+         */
+        void countStateCalls(uint32_t issued, uint32_t elided);
+
+        /**
+         *  Adds the number of scene nodes whose matrices were recomputed during the frame
+         *   - updated (uint32_t) : the recomputed nodes
+         *   - total (uint32_t) : the nodes of the scene
+         */
+        void countUpdatedNodes(uint32_t updated, uint32_t total);
+
+        /**
+         *  Adds the number of scene drawables (nodes or static batches) sent or culled during the frame
+         *   - drawn (uint32_t) : the drawables inside the frustum
+         *   - culled (uint32_t) : the drawables skipped as outside the frustum
+         */
+        void countCulledNodes(uint32_t drawn, uint32_t culled);
+
+        /**
+         *  Returns true once every frame has been measured
+         */
+        bool isDone() const { return frame >= nbWarmup + nbFrames; }
+
+        /**
+         *  Prints the average timings
+         *   - label (const char*) : the name of the measured configuration
+         */
+        void report(const char* label) const;
+
+        /**
+         *  Micro-benchmark of TransformKernel : composes a random hierarchy of translate-rotate-scale nodes
+         *  (a few of them sheared) with glm and with the kernel, on each instruction set the processor has,
+         *  then prints the time per pass and the largest difference between the results
+         *   - nbNodes (uint32_t) : the number of nodes
+         *   - nbRuns (uint32_t) : the number of passes measured for each path
+         */
+        static void transforms(uint32_t nbNodes, uint32_t nbRuns = 200);
+
+        /**
+         *  Micro-benchmark of BallPhysics : simulates a break (the white ball shot into a rack of 15 balls)
+         *  until every ball stops, in both modes, then prints the simulated time, the number of steps or events
+         *  and the time it took. Then plays random breaks event driven, frame by frame, and checks none of them
+         *  gets stuck on balls resting on each other, and checks the modes against each other on a shot of
+         *  the white ball alone (they end it within half a ball radius). Returns false if a check failed
+         *   - params (BallPhysics::Params const&) : the table and the balls
+         *   - nbRuns (uint32_t) : the number of breaks measured
+         *   - nbRandomBreaks (uint32_t) : the number of random breaks checked
+         */
+        static bool physics(BallPhysics::Params const& params, uint32_t nbRuns = 20, uint32_t nbRandomBreaks = 300);
+
+        /**
+         *  Micro-benchmark of BallGrid : from 16 balls to maxBalls (by 10), on a table grown with them, moves
+         *  every ball and finds their candidate pairs, checks them against every pair, then times the fixed step
+         *  of BallPhysics with every ball moving. Prints the times per frame
+         *   - params (BallPhysics::Params const&) : the balls (the table is replaced)
+         *   - maxBalls (uint32_t) : the largest number of balls
+         *   - nbFrames (uint32_t) : the number of frames measured for each number of balls
+         */
+        static void broadphase(BallPhysics::Params const& params, uint32_t maxBalls = 100000, uint32_t nbFrames = 50);
+
+        /**
+         *  Micro-benchmark of NarrowPhase, with each instruction set the processor has : tests a ball against 1024 others
+         *  (contacts and times of impact), and evaluates a batch of shots of the white ball at the rack. Prints the times
+         *  and checks the results against the scalar path, with balls at the distance of contact too. Returns false
+         *  if a path finds other contacts or other times
+         *   - params (BallPhysics::Params const&) : the table and the balls
+         *   - nbRuns (uint32_t) : the number of tests measured
+         */
+        static bool narrowphase(BallPhysics::Params const& params, uint32_t nbRuns = 10000);
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        uint32_t nbFrames, nbWarmup;
+        uint32_t frame = 0;
+        Clock::time_point frameStart, submitStart, pickStart;
+        double frameTotal = 0.0, submitTotal = 0.0, submitMax = 0.0, pickTotal = 0.0; // in ms
+        uint64_t stateIssued = 0, stateElided = 0;
+        uint64_t nodesUpdated = 0, nodesTotal = 0;
+        uint64_t nodesDrawn = 0, nodesCulled = 0;
+};
+
+#endif // BENCHMARK_H_
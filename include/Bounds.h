@@ -0,0 +1,75 @@
+#ifndef  BOUNDS_INC
+#define  BOUNDS_INC
+
+#include <cmath>
+#include <glm/glm.hpp>
+
+/* \brief An axis aligned bounding box. An empty box has min > max*/
+struct AABB
+{
+    glm::vec3 min = glm::vec3( INFINITY);
+    glm::vec3 max = glm::vec3(-INFINITY);
+
+    /* \brief Tells if the box contains nothing
+     * \return true if nothing was added to the box*/
+    bool isEmpty() const {return min.x > max.x;}
+
+    /* \brief Grow the box to contain a point
+     * \param p the point*/
+    void extend(const glm::vec3& p) {min = glm::min(min, p); max = glm::max(max, p);}
+
+    /* \brief Grow the box to contain another box
+     * \param b the box*/
+    void extend(const AABB& b) {min = glm::min(min, b.min); max = glm::max(max, b.max);}
+
+    /* \brief Get the center of the box*/
+    glm::vec3 getCenter() const {return 0.5f * (min + max);}
+
+    /* \brief Get the half size of the box*/
+    glm::vec3 getExtents() const {return 0.5f * (max - min);}
+
+    /* \brief Intersect a ray with the box (slab test)
+     * \param origin the origin of the ray
+     * \param invDir 1 / the direction of the ray
+     * \param t receives the distance (in units of the direction) where the ray enters the box, 0 if it starts inside
+     * \return true if the ray crosses the box*/
+    bool intersects(const glm::vec3& origin, const glm::vec3& invDir, float& t) const
+    {
+        glm::vec3 t1 = (min - origin) * invDir;
+        glm::vec3 t2 = (max - origin) * invDir;
+        glm::vec3 tNear = glm::min(t1, t2), tFar = glm::max(t1, t2);
+        float enter = fmaxf(fmaxf(tNear.x, tNear.y), tNear.z);
+        float exit  = fminf(fminf(tFar.x, tFar.y), tFar.z);
+        t = fmaxf(enter, 0.0f);
+        return exit >= t;
+    }
+
+    /* \brief Get the box containing this box once transformed (Arvo's method : no need to transform the 8 corners)
+     * \param m the transformation
+     * \return the transformed box*/
+    AABB transformed(const glm::mat4& m) const
+    {
+        if(isEmpty())
+            return *this;
+        glm::vec3 c = glm::vec3(m * glm::vec4(getCenter(), 1.0f));
+        glm::vec3 e = getExtents();
+        glm::vec3 r = glm::abs(glm::vec3(m[0])) * e.x + glm::abs(glm::vec3(m[1])) * e.y + glm::abs(glm::vec3(m[2])) * e.z;
+        return {c - r, c + r};
+    }
+};
+
+/* \brief A bounding sphere*/
+struct BoundingSphere
+{
+    glm::vec3 center = glm::vec3(0.0f);
+    float     radius = 0.0f;
+};
+
+/* \brief A half line*/
+struct Ray
+{
+    glm::vec3 origin;
+    glm::vec3 dir;
+};
+
+#endif
@@ -3,6 +3,9 @@
 
 #include <glm/glm.hpp>
 
+#include "Frustum.h"
+#include "Bounds.h"
+
 class Camera {
 
     public:
@@ -19,6 +22,19 @@ class Camera {
          */
         glm::vec3 getPos() { return pos; }
 
+        /**
+         *  returns the frustum seen by this camera
+         *   - projection (glm::mat4 const&) : the projection matrix
+         */
+        Frustum getFrustum(glm::mat4 const& projection) { return Frustum(projection * viewMat); }
+
+        /**
+         *  returns the ray going from the camera through a point of the screen, in world space
+         *   - projection (glm::mat4 const&) : the projection matrix
+         *   - x, y (float) : the point, in normalized device coordinates ([-1, 1], y up)
+         */
+        Ray getRay(glm::mat4 const& projection, float x, float y);
+
         /**
          *  changes the camera position and rotation
          *   - pitch (float) : the variation of angle between the up plane and the up axis
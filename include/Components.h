@@ -0,0 +1,77 @@
+#ifndef COMPONENTS_H_
+#define COMPONENTS_H_
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Pool.h"
+#include "Material.h"
+#include "Light.h"
+#include "Scene.h"
+
+// the identifier of an entity of a World. It becomes invalid (World::get returns nullptr) when the entity is destroyed
+typedef PoolHandle Entity;
+
+/**
+ *  Where an entity is, relative to the parent of its scene node : the position and rotation are propagated
+ *  to the childs of the node, the scale only applies to the node itself
+ */
+struct TransformComponent
+{
+    glm::vec3 position = glm::vec3(0.f);
+    glm::quat rotation = glm::quat(1.f, 0.f, 0.f, 0.f);
+    glm::vec3 scale = glm::vec3(1.f);
+    bool moved = true; // changed since the last RenderSystem::sync, set by the systems writing it
+
+    glm::mat4 getPropagate() const { return glm::translate(glm::mat4(1.f), position) * glm::mat4_cast(rotation); }
+    glm::mat4 getSelf() const { return glm::scale(glm::mat4(1.f), scale); }
+};
+
+/**
+ *  The scene node drawing an entity (its shape, and how it is batched, are set on the node)
+ */
+struct MeshComponent
+{
+    PartHandle node;
+};
+
+/**
+ *  The material an entity is drawn with
+ */
+struct MaterialComponent
+{
+    Material* material = nullptr;
+};
+
+/**
+ *  A ball of the physics simulation, its position is the one of the TransformComponent
+ */
+struct BodyComponent
+{
+    glm::vec3 velocity = glm::vec3(0.f);
+    glm::vec3 angularVelocity = glm::vec3(0.f);
+    float radius = 0.f;
+    float mass = 1.f;
+};
+
+/**
+ *  A light placed at the position of the TransformComponent
+ */
+struct LightComponent
+{
+    Light* light = nullptr;
+};
+
+/**
+ *  The bit of each component type in the mask of an archetype : its place in World::Archetype::columns
+ */
+template <typename T> struct ComponentBit;
+template <> struct ComponentBit<TransformComponent> { static const uint32_t value = 0; };
+template <> struct ComponentBit<MeshComponent>      { static const uint32_t value = 1; };
+template <> struct ComponentBit<MaterialComponent>  { static const uint32_t value = 2; };
+template <> struct ComponentBit<BodyComponent>      { static const uint32_t value = 3; };
+template <> struct ComponentBit<LightComponent>     { static const uint32_t value = 4; };
+
+#endif // COMPONENTS_H_
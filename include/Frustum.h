@@ -0,0 +1,42 @@
+#ifndef FRUSTUM_H_
+#define FRUSTUM_H_
+
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+
+/**
+ *  The 6 planes of a camera frustum, extracted from its view-projection matrix.
+ *  The planes are stored by component (all the x, then all the y...) so that a box is tested
+ *  against 4 planes at once with SSE
+ */
+class Frustum {
+
+    public:
+        enum class Result { Outside, Intersects, Inside };
+
+        /**
+         *  Constructor :
+         *   - viewProjection (glm::mat4 const&) : projection * view of the camera
+         */
+        Frustum(glm::mat4 const& viewProjection);
+
+        /**
+         *  Tests a box against the planes
+         *   - box (AABB const&) : the box, in world space
+         */
+        Result test(AABB const& box) const;
+
+        /**
+         *  Tests a sphere against the planes, returns false if it is fully outside
+         *   - sphere (BoundingSphere const&) : the sphere, in world space
+         */
+        bool test(BoundingSphere const& sphere) const;
+
+    private:
+        // 6 planes (left, right, bottom, top, near, far) padded to 8 with planes that contain everything.
+        // A point p is inside a plane if x*p.x + y*p.y + z*p.z + w >= 0
+        alignas(16) float x[8], y[8], z[8], w[8];
+};
+
+#endif // FRUSTUM_H_
@@ -0,0 +1,122 @@
+#ifndef GLSTATE_H_
+#define GLSTATE_H_
+
+#include <cstdint>
+#include <GL/glew.h>
+
+/**
+ *  A thin cache of the openGL binding and capability state.
+ *  Every class goes through it instead of calling glUseProgram, glBindTexture, glEnable, ... directly,
+ *  so that calls which would not change anything never reach the driver.
+ *  invalidate() must be called once the context is created : the cache is then in an unknown state
+ *  and the first call of each kind is always issued.
+ */
+class GLState {
+
+    public:
+        /**
+         *  Number of state calls issued to the driver and elided since the last beginFrame()
+         */
+        struct Stats {
+            uint32_t issued = 0;
+            uint32_t elided = 0;
+        };
+
+        static void useProgram(GLuint program);
+
+        /**
+         *  Selects the active texture unit
+         *   - unit (GLenum) : GL_TEXTURE0 + n
+         */
+        static void activeTexture(GLenum unit);
+
+        /**
+         *  Binds a texture on the active unit. GL_TEXTURE_2D and GL_TEXTURE_2D_ARRAY are cached, other targets are passed through
+         */
+        static void bindTexture(GLenum target, GLuint texture);
+
+        static void bindVertexArray(GLuint vao);
+
+        /**
+         *  Binds a buffer. GL_ARRAY_BUFFER and GL_UNIFORM_BUFFER are cached, other targets
+         *  (like GL_ELEMENT_ARRAY_BUFFER which belongs to the VAO) are passed through
+         */
+        static void bindBuffer(GLenum target, GLuint buffer);
+
+        /**
+         *  glBindBufferRange / glBindBufferBase on GL_UNIFORM_BUFFER. The indexed bindings 0 to 7 are cached.
+         *  Like openGL, it also changes the GL_UNIFORM_BUFFER binding
+         */
+        static void bindUniformBufferRange(GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+        static void bindUniformBufferBase(GLuint index, GLuint buffer);
+
+        /**
+         *  glEnable / glDisable. GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE and GL_SCISSOR_TEST are cached, other caps are passed through
+         */
+        static void enable(GLenum cap);
+        static void disable(GLenum cap);
+
+        static void blendFunc(GLenum src, GLenum dst);
+        static void blendEquation(GLenum mode);
+        static void depthMask(bool write);
+        static void colorMask(bool write);
+
+        /**
+         *  Delete an openGL object and forget it in the cache, so that a recycled name is not taken as already bound
+         */
+        static void deleteProgram(GLuint program);
+        static void deleteTexture(GLuint texture);
+        static void deleteVertexArray(GLuint vao);
+        static void deleteBuffer(GLuint buffer);
+
+        /**
+         *  Forgets everything. To call after code that changed the state without going through GLState
+         */
+        static void invalidate();
+
+        /**
+         *  Resets the per frame counters
+         */
+        static void beginFrame();
+
+        /**
+         *  Returns the counters since the last beginFrame()
+         */
+        static Stats getStats() { return stats; }
+
+    private:
+        static constexpr GLuint   UNKNOWN       = ~0u;
+        static constexpr uint32_t NB_UNITS      = 16;
+        static constexpr uint32_t NB_TARGETS    = 2;  // GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY
+        static constexpr uint32_t NB_CAPS       = 4;  // GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST
+        static constexpr uint32_t NB_UBO_BINDINGS = 8;
+
+        struct IndexedBinding {
+            GLuint     buffer;
+            GLintptr   offset;
+            GLsizeiptr size;   // -1 for the whole buffer (glBindBufferBase)
+        };
+
+        static int textureTargetIndex(GLenum target);
+        static int capIndex(GLenum cap);
+        static void setCap(GLenum cap, GLuint value);
+
+        /**
+         *  Returns true (and counts an issued call) if the cached value must be updated,
+         *  false (and counts an elided call) if it already holds the value
+         */
+        static bool update(GLuint& cached, GLuint value);
+
+        static GLuint program;
+        static GLuint activeUnit;
+        static GLuint textures[NB_UNITS][NB_TARGETS];
+        static GLuint vao;
+        static GLuint arrayBuffer, uniformBuffer;
+        static IndexedBinding uniformBindings[NB_UBO_BINDINGS];
+        static GLuint caps[NB_CAPS];
+        static GLuint blendSrc, blendDst, blendMode;
+        static GLuint depthWrite, colorWrite;
+        static Stats stats;
+};
+
+#endif // GLSTATE_H_
@@ -4,6 +4,8 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+#include "Bounds.h"
+
 /* \brief Represent a geometry*/
 class Geometry
 {
@@ -43,14 +45,39 @@ class Geometry
          * \return the number of vertices this geometry contains*/
         uint32_t getNbVertices() const {return m_nbVertices;}
 
+        /* \brief Get the triangle indices of the geometry
+         * \return const array on the indices, NULL if the geometry is not indexed (every 3 consecutive vertices make a triangle) */
+        const uint32_t* getIndices() const {return m_indices;}
+
+        /* \brief Get how many indices this geometry contains
+         * \return the number of indices, 0 if the geometry is not indexed*/
+        uint32_t getNbIndices() const {return m_nbIndices;}
+
+        /* \brief Tells if the geometry has an index array
+         * \return true if the triangles are described by getIndices*/
+        bool isIndexed() const {return m_indices != NULL;}
+
+        /* \brief Compute the axis aligned box containing every vertex
+         * \return the box, empty if there is no vertex*/
+        AABB computeAABB() const;
+
+        /* \brief Compute a sphere containing every vertex, centered on the box center
+         * \return the sphere*/
+        BoundingSphere computeBoundingSphere() const;
+
     protected: 
         /* \brief Clear all the tables*/
         void clear();
 
-        uint32_t m_nbVertices = 0;
-        float*   m_vertices   = NULL;
-        float*   m_normals    = NULL;
-        float*   m_uvs        = NULL;
+        /* \brief Turn a triangle soup into an indexed geometry : identical vertices (same position, normal and UV) are stored once*/
+        void weld();
+
+        uint32_t  m_nbVertices = 0;
+        float*    m_vertices   = NULL;
+        float*    m_normals    = NULL;
+        float*    m_uvs        = NULL;
+        uint32_t  m_nbIndices  = 0;
+        uint32_t* m_indices    = NULL;
 };
 
 #endif
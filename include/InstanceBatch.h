@@ -0,0 +1,78 @@
+#ifndef INSTANCEBATCH_H_
+#define INSTANCEBATCH_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Mesh.h"
+#include "Material.h"
+#include "TextureArray.h"
+#include "Shader.h"
+
+/**
+ *  Per instance data, read by Shaders/instanced.vert through attributes 3 to 7
+ */
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec4 colorLayer; // rgb : color added to the texture, a : layer in the texture array (-1 for no texture)
+};
+
+/**
+ *  Draws many copies of one mesh in a single glDrawArraysInstanced call.
+ *  Every instance has its own model matrix, color and texture array layer, and shares the material coefficients.
+ *  The normals are transformed by the model matrix itself : the instances must only be uniformly scaled (like the balls)
+ */
+class InstanceBatch {
+
+    public:
+        /**
+         *  Constructor :
+         *   - mesh (const Mesh*) : the mesh to draw
+         *   - textures (TextureArray*) : the layers the instances pick their texture from
+         *   - mtl (const Material*) : the material shared by every instance (its color and texture are ignored)
+         */
+        InstanceBatch(const Mesh* mesh, TextureArray* textures, const Material* mtl);
+        // destructor
+        ~InstanceBatch();
+
+        InstanceBatch(const InstanceBatch&) = delete;
+        InstanceBatch& operator=(const InstanceBatch&) = delete;
+
+        /**
+         *  Removes every instance. The memory is kept for the next frame
+         */
+        void clear() { instances.clear(); }
+
+        /**
+         *  Adds an instance
+         *   - model (glm::mat4 const&) : the model matrix
+         *   - color (glm::vec3 const&) : the color added to the texture
+         *   - layer (int) : the texture array layer, -1 for no texture
+         */
+        void push(glm::mat4 const& model, glm::vec3 const& color, int layer);
+
+        /**
+         *  Uploads the instances and draws them all with one draw call.
+         *  The camera and lights come from the Frame block, which must already be bound (see FrameUniformBuffer::update)
+         */
+        void draw();
+
+        /**
+         *  Returns the number of instances
+         */
+        size_t size() const { return instances.size(); }
+
+    private:
+        const Mesh* mesh;
+        TextureArray* textures;
+        const Material* mtl;
+
+        Shader* shader;
+        Uniform<glm::vec4> uMtlCts;
+
+        GLuint vaoID = 0, instanceVBO = 0;
+        size_t capacity = 0; // in instances
+        std::vector<InstanceData> instances;
+};
+
+#endif // INSTANCEBATCH_H_
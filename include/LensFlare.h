@@ -46,7 +46,8 @@ class LensFlare {
         static Light* mainLight;
         static Shader* shader;
         static Query* query;
-        static GLuint VAOid, VBOid, uni_alpha;
+        static GLuint VAOid, VBOid;
+        static Uniform<float> uni_alpha;
         static float occlusion;
 
 };
@@ -35,6 +35,12 @@ class Light {
          */
         glm::vec3 getPosition() const { return position; }
 
+        /**
+         *  Moves the light, its camera space position is recomputed by the next setView()
+         *   - pos (glm::vec3) : the new position
+         */
+        void setPosition(glm::vec3 pos) { position = pos; }
+
         /**
          *  Returns the camera space position of the light
          */
@@ -25,6 +25,13 @@ class Material {
          *   - K[ads], alpha (float) : the illumination constants of the material */
         Material(glm::vec3 col, float Ka, float Kd, float Ks, float alpha);
 
+        /**
+         *  Copies : the copy has the color, the texture and the constants of the material, but its own id
+         *  (an assigned material keeps its id)
+         */
+        Material(Material const& other);
+        Material& operator=(Material const& other);
+
         /**
          * Used to send the uniforms and activate the texture
          */
@@ -45,6 +52,11 @@ class Material {
          */
         Texture* getTexture() const { return tex; }
 
+        /**
+         * Returns a small number identifying the material, used to sort draw calls
+         */
+        uint32_t getId() const { return id; }
+
         /**
          * Returns the shading coefficients of the material
          */
@@ -72,6 +84,8 @@ class Material {
         glm::vec3 color = glm::vec3(1.f, 1.f, 1.f);
         Texture* tex = nullptr;
         float Ka, Kd, Ks, alpha;
+        uint32_t id = nextId++;
+        static uint32_t nextId;
         static GLint uni_K, uni_alpha, uni_color;
 };
 
@@ -0,0 +1,18 @@
+#ifndef  MERGEDGEOMETRY_INC
+#define  MERGEDGEOMETRY_INC
+
+#include "Geometry.h"
+#include <glm/glm.hpp>
+
+/* \brief An indexed geometry made of other geometries, each baked with its own transformation.
+ * Used to draw objects that never move relative to each other in one call (see StaticBatch)*/
+class MergedGeometry : public Geometry
+{
+    public:
+        /* \brief Append a transformed copy of a geometry
+         * \param g the geometry to append
+         * \param transform the transformation applied to its vertices. The normals are transformed by its inverse transpose*/
+        void append(const Geometry& g, const glm::mat4& transform);
+};
+
+#endif
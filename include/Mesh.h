@@ -0,0 +1,78 @@
+#ifndef MESH_H_
+#define MESH_H_
+
+#include <GL/glew.h>
+
+#include "Geometry.h"
+#include "VertexFormat.h"
+
+/* \brief The GPU side of a Geometry : one VAO, its vertex buffer and its index buffer, built once and shared by every object drawing it.
+ * The vertices are interleaved and encoded following a VertexFormat.
+ * Attribute 0 is the position, 1 the UV and 2 the normal (see Shader::bindAttributes).
+ * Indices are stored on 16 bits when the vertex count allows it, on 32 bits otherwise */
+class Mesh
+{
+    public:
+        /* \brief Constructor. Upload the geometry and record the attribute setup in a VAO
+         * \param g the geometry to upload. It can be destroyed afterward
+         * \param format how to encode the vertices. Adjusted to the geometry (see VertexFormat::fit)*/
+        Mesh(const Geometry& g, VertexFormat format = VertexFormat());
+
+        /* \brief Destructor. Destroy the VAO and the buffers*/
+        ~Mesh();
+
+        Mesh(const Mesh&) = delete;
+        Mesh& operator=(const Mesh&) = delete;
+
+        /* \brief Bind the VAO. This is all that is needed before drawing*/
+        void bind() const;
+
+        /* \brief Bind the vertex buffer and set up the attributes one by one, as it was done before VAOs.
+         * Only kept to compare both paths in benchmark mode*/
+        void bindLegacy() const;
+
+        /* \brief Point the attributes 0 to 2 of the currently bound VAO to this mesh vertex buffer, and bind the index buffer.
+         * Used to build other VAOs on the same vertices (see InstanceBatch)*/
+        void setupAttributes() const;
+
+        /* \brief Unbind the VAO*/
+        void unbind() const;
+
+        /* \brief Draw the mesh. The mesh must be bound*/
+        void draw() const;
+
+        /* \brief Draw several instances of the mesh in one call. A VAO using this mesh vertices must be bound
+         * \param count the number of instances*/
+        void drawInstanced(GLsizei count) const;
+
+        /* \brief Get how many vertices this mesh contains
+         * \return the number of vertices*/
+        uint32_t getNbVertices() const {return m_nbVertices;}
+
+        /* \brief Get how many indices this mesh draws
+         * \return the number of indices, 0 if the mesh is drawn without index buffer*/
+        uint32_t getNbIndices() const {return m_nbIndices;}
+
+        /* \brief Get how many bytes the vertex and index buffers use on the GPU
+         * \return the size in bytes*/
+        size_t getGPUSize() const;
+
+        /* \brief Get the vertex array object ID
+         * \return the VAO ID*/
+        GLuint getVAO() const {return m_vaoID;}
+
+        /* \brief Get the format the vertices are stored in
+         * \return the format*/
+        const VertexFormat& getFormat() const {return m_format;}
+
+    private:
+        GLuint   m_vaoID      = 0;
+        GLuint   m_vboID      = 0;
+        GLuint   m_iboID      = 0;
+        uint32_t m_nbVertices = 0;
+        uint32_t m_nbIndices  = 0;
+        GLenum   m_indexType  = GL_UNSIGNED_INT; /*!< GL_UNSIGNED_SHORT or GL_UNSIGNED_INT*/
+        VertexFormat m_format;
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef MESHREGISTRY_H_
+#define MESHREGISTRY_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Mesh.h"
+
+class MeshHandle;
+
+/**
+ *  Uploads each geometry once : geometries with the same content and vertex format share one Mesh.
+ *  The geometries are found by a hash of their content, then compared with a copy of it kept with their mesh.
+ *  The meshes are reference counted through MeshHandle and destroyed with their last handle
+ */
+class MeshRegistry {
+
+    public:
+        /**
+         *  Returns a handle on the mesh of a geometry, uploading it if no equal geometry was uploaded before
+         *   - g (Geometry const&) : the geometry
+         *   - format (VertexFormat) : how to store the vertices
+         */
+        static MeshHandle acquire(Geometry const& g, VertexFormat format = VertexFormat());
+
+        /**
+         *  Returns the number of meshes currently uploaded
+         */
+        static size_t getNbMeshes() { return entries.size(); }
+
+        /**
+         *  Returns the GPU memory used by the meshes currently uploaded
+         */
+        static size_t getResidentSize() { return residentSize; }
+
+        /**
+         *  Returns the GPU memory uploaded since the start, and the memory every call of acquire()
+         *  would have uploaded without sharing. Neither decreases when meshes are released
+         */
+        static size_t getUploadedSize() { return uploadedSize; }
+        static size_t getRequestedSize() { return requestedSize; }
+
+        /**
+         *  Prints the number of meshes and the memory saved by sharing them
+         */
+        static void report();
+
+    private:
+        struct Entry {
+            uint64_t key;
+            Mesh* mesh;
+            uint32_t refs;
+            std::vector<uint8_t> content; // what was hashed, to tell apart two geometries with the same hash
+        };
+
+        static void release(Entry* e);
+
+        static std::unordered_multimap<uint64_t, Entry> entries;
+        static size_t residentSize, uploadedSize, requestedSize;
+
+        friend class MeshHandle;
+};
+
+/**
+ *  A counted reference on a mesh of the MeshRegistry
+ */
+class MeshHandle {
+
+    public:
+        // constructor (an empty handle)
+        MeshHandle() = default;
+        // copy, move and destructor update the reference count
+        MeshHandle(MeshHandle const& h);
+        MeshHandle(MeshHandle&& h) noexcept;
+        MeshHandle& operator=(MeshHandle h);
+        ~MeshHandle();
+
+        /**
+         *  Returns the mesh, nullptr for an empty handle
+         */
+        const Mesh* get() const { return entry != nullptr ? entry->mesh : nullptr; }
+        const Mesh* operator->() const { return get(); }
+
+        /**
+         *  Returns true if the handle references a mesh
+         */
+        explicit operator bool() const { return entry != nullptr; }
+
+    private:
+        explicit MeshHandle(MeshRegistry::Entry* e);
+
+        MeshRegistry::Entry* entry = nullptr;
+
+        friend class MeshRegistry;
+};
+
+#endif // MESHREGISTRY_H_
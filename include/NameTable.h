@@ -0,0 +1,90 @@
+#ifndef NAMETABLE_H_
+#define NAMETABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Pool.h"
+
+/**
+ *  Names associated to pool handles, interned : the characters of the names are copied one after the other in a
+ *  single buffer, and found through an open addressing hash table of their offsets in it. A name is given as a
+ *  prefix and a rest, so that no string is built to add it. Adding names only allocates when the buffer or the
+ *  table outgrows what reserve() gave them, never for each name. The characters of a removed name are only
+ *  given back with the table
+ */
+class NameTable {
+
+    public:
+        static constexpr uint32_t NONE = ~0u;
+
+        /**
+         *  Makes room for more names at once
+         *   - nbNames (uint32_t) : the number of names to be added
+         *   - nbChars (size_t) : their total length
+         */
+        void reserve(uint32_t nbNames, size_t nbChars);
+
+        /**
+         *  Adds a name, made of a prefix followed by the rest. Returns its offset, NONE if it is already there
+         *   - prefix (const char*), prefixLength (size_t) : the beginning of the name
+         *   - name (const char*), length (size_t) : the rest of the name
+         *   - handle (PoolHandle) : what the name refers to
+         */
+        uint32_t add(const char* prefix, size_t prefixLength, const char* name, size_t length, PoolHandle handle);
+
+        /**
+         *  Returns what a name refers to, PoolHandle() if there is no such name
+         *   - name (const char*), length (size_t) : the name
+         */
+        PoolHandle find(const char* name, size_t length) const;
+
+        /**
+         *  Returns the characters of a name (zero terminated), valid until the next name is added
+         *   - offset (uint32_t) : the offset of the name, given by add()
+         */
+        const char* get(uint32_t offset) const { return chars.data() + offset; }
+
+        /**
+         *  Removes a name
+         *   - offset (uint32_t) : the offset of the name, given by add()
+         */
+        void remove(uint32_t offset);
+
+        /**
+         *  Returns the number of names
+         */
+        uint32_t size() const { return nbNames; }
+
+    private:
+        static constexpr uint32_t REMOVED = ~0u - 1;
+
+        struct Slot {
+            uint32_t offset = NONE; // NONE for an empty slot, REMOVED for the slot of a removed name
+            uint32_t hash = 0;
+            PoolHandle handle;
+        };
+
+        /**
+         *  Returns the hash of a name given in two parts (FNV-1a)
+         */
+        static uint32_t hash(const char* prefix, size_t prefixLength, const char* name, size_t length);
+
+        /**
+         *  Returns true if the name at offset is the prefix followed by the rest
+         */
+        bool equals(uint32_t offset, const char* prefix, size_t prefixLength, const char* name, size_t length) const;
+
+        /**
+         *  Rebuilds the hash table with a number of slots (a power of 2), without the removed names
+         */
+        void rehash(uint32_t nbSlots);
+
+        std::vector<char> chars;
+        std::vector<Slot> slots; // a power of 2 of them, at most 3/4 used (names and removed names)
+        uint32_t nbNames = 0;
+        uint32_t nbUsed = 0;
+};
+
+#endif // NAMETABLE_H_
@@ -0,0 +1,66 @@
+#ifndef NARROWPHASE_H_
+#define NARROWPHASE_H_
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+/**
+ *  The narrowphase of the collisions between balls : one ball tested against an array of others, stored by component,
+ *  4 (SSE), 8 (AVX2) or 16 (AVX-512) at once. AVX2 and AVX-512 mask the lanes past the last ball, so that the few
+ *  candidates of a ball in BallPhysics are still tested at once; SSE takes the last ones (count % 4) one by one.
+ *  Every path computes the same roundings in the same order (no fused multiply-add) : they give the same results.
+ *  The instruction set is chosen at runtime, the best one the processor has : with GCC and Clang the wide paths are
+ *  compiled for their own target only, so the program still runs on processors without them. Other compilers get
+ *  SSE where the target guarantees it, else the scalar path
+ */
+class NarrowPhase {
+
+    public:
+        enum class Path : uint8_t { Scalar, SSE, AVX2, AVX512 };
+
+        static constexpr uint32_t NONE = ~0u;
+
+        /**
+         *  Finds the balls touching a ball. Returns their number
+         *   - p (glm::vec2) : the center of the ball
+         *   - x, z (const float*), count (uint32_t) : the centers of the others
+         *   - distance (float) : the distance of the centers below which two balls touch (the sum of their radii)
+         *   - mask (uint32_t*) : receives a bit per other ball, set if it touches (bit k % 32 of mask[k / 32]),
+         *     (count + 31) / 32 words
+         */
+        static uint32_t contacts(glm::vec2 p, const float* x, const float* z, uint32_t count, float distance, uint32_t* mask);
+
+        /**
+         *  Finds when a ball touches the others, every ball going in a straight line at constant velocity.
+         *  Returns the earliest time, infinity if no ball is touched before horizon. The event mode of BallPhysics does not
+         *  use it : friction slows its balls down, their contacts are the roots of a quartic (see BallPhysics::ballTime())
+         *   - p, v (glm::vec2) : the center and the velocity of the ball
+         *   - x, z, vx, vz (const float*), count (uint32_t) : the centers and the velocities of the others
+         *   - distance (float) : as for contacts()
+         *   - horizon (float) : the latest time looked at
+         *   - times (float*) : receives the time of impact with each other ball (0 if they touch and approach,
+         *     infinity if none before horizon)
+         *   - first (uint32_t&) : receives the ball touched at the earliest time, NONE if there is none
+         */
+        static float impacts(glm::vec2 p, glm::vec2 v, const float* x, const float* z, const float* vx, const float* vz,
+                             uint32_t count, float distance, float horizon, float* times, uint32_t& first);
+
+        /**
+         *  Returns the best instruction set of the processor (among those built), and the one in use
+         */
+        static Path getBestPath();
+        static Path getPath();
+
+        /**
+         *  Changes the instruction set in use, to compare them. A path the processor does not have falls back to the best one
+         *   - path (Path) : the instruction set
+         */
+        static void setPath(Path path);
+
+        /**
+         *  Returns the name of an instruction set : "avx512", "avx2", "sse" or "scalar"
+         */
+        static const char* getName(Path path);
+};
+
+#endif // NARROWPHASE_H_
@@ -0,0 +1,127 @@
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ *  A reference on an object of a Pool. It stays safe after the object is destroyed :
+ *  the slot generation no longer matches and the pool returns nullptr for it
+ */
+struct PoolHandle {
+    uint32_t index = ~0u;
+    uint32_t generation = 0;
+
+    /**
+     *  Returns true for the default handle, which never refers to an object
+     */
+    bool isNull() const { return index == ~0u; }
+
+    bool operator==(PoolHandle const& h) const { return index == h.index && generation == h.generation; }
+    bool operator!=(PoolHandle const& h) const { return !(*this == h); }
+};
+
+/**
+ *  A slab allocator for objects of type T : the objects are built in chunks of CHUNK_SIZE slots that are never moved
+ *  nor freed before the pool, so their addresses are stable. Destroyed slots are reused, creating an object then
+ *  only costs a malloc when every chunk is full
+ */
+template <typename T, uint32_t CHUNK_SIZE = 256>
+class Pool {
+
+    public:
+        // constructor
+        Pool() = default;
+        // destructor (destroys the remaining objects)
+        ~Pool()
+        {
+            for (uint32_t i = 0; i < nbSlots; i++)
+                if (slot(i).alive) object(i)->~T();
+            for (Slot* c : chunks) ::operator delete(c);
+        }
+
+        Pool(const Pool&) = delete;
+        Pool& operator=(const Pool&) = delete;
+
+        /**
+         *  Builds an object in a free slot
+         *   - args : the arguments of the constructor of T
+         */
+        template <typename... Args>
+        PoolHandle create(Args&&... args)
+        {
+            uint32_t i = freeList;
+            if (i != NO_SLOT) freeList = slot(i).nextFree;
+            else
+            {
+                if (nbSlots % CHUNK_SIZE == 0)
+                    chunks.push_back(static_cast<Slot*>(::operator new(CHUNK_SIZE * sizeof(Slot))));
+                i = nbSlots++;
+                new (&slot(i)) Slot();
+            }
+
+            new (object(i)) T(std::forward<Args>(args)...);
+            slot(i).alive = true;
+            nbAlive++;
+            return {i, slot(i).generation};
+        }
+
+        /**
+         *  Destroys an object, does nothing if the handle is already invalid
+         *   - h (PoolHandle) : the object
+         */
+        void destroy(PoolHandle h)
+        {
+            if (get(h) == nullptr) return;
+            object(h.index)->~T();
+            Slot& s = slot(h.index);
+            s.alive = false;
+            s.generation++; // the handles on the destroyed object are now invalid
+            s.nextFree = freeList;
+            freeList = h.index;
+            nbAlive--;
+        }
+
+        /**
+         *  Returns the object of a handle, nullptr if it was destroyed
+         *   - h (PoolHandle) : the handle
+         */
+        T* get(PoolHandle h) const
+        {
+            if (h.index >= nbSlots) return nullptr;
+            Slot& s = slot(h.index);
+            return s.alive && s.generation == h.generation ? object(h.index) : nullptr;
+        }
+
+        /**
+         *  Returns the number of live objects
+         */
+        uint32_t size() const { return nbAlive; }
+
+        /**
+         *  Returns the number of slots allocated (live and free)
+         */
+        uint32_t capacity() const { return (uint32_t)chunks.size() * CHUNK_SIZE; }
+
+    private:
+        static constexpr uint32_t NO_SLOT = ~0u;
+
+        struct Slot {
+            alignas(T) unsigned char storage[sizeof(T)];
+            uint32_t generation = 0;
+            uint32_t nextFree = NO_SLOT;
+            bool alive = false;
+        };
+
+        Slot& slot(uint32_t i) const { return chunks[i / CHUNK_SIZE][i % CHUNK_SIZE]; }
+        T* object(uint32_t i) const { return reinterpret_cast<T*>(slot(i).storage); }
+
+        std::vector<Slot*> chunks;
+        uint32_t nbSlots = 0;  // slots built so far, the others of the last chunk are raw memory
+        uint32_t nbAlive = 0;
+        uint32_t freeList = NO_SLOT;
+};
+
+#endif // POOL_H_
@@ -0,0 +1,58 @@
+#ifndef RAYCANDIDATES_H_
+#define RAYCANDIDATES_H_
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+
+/**
+ *  The objects a ray may hit, tested exactly all at once : each is a sphere in world space or a box in its own space.
+ *  The candidates are stored by component so that 4 of them are tested at once with SSE
+ */
+class RayCandidates {
+
+    public:
+        /**
+         *  Removes every candidate, keeping the memory
+         */
+        void clear();
+
+        /**
+         *  Adds a sphere
+         *   - id (uint32_t) : returned by closest() if it is the hit
+         *   - center (glm::vec3 const&), radius (float) : the sphere in world space
+         */
+        void addSphere(uint32_t id, glm::vec3 const& center, float radius);
+
+        /**
+         *  Adds a box in its own space
+         *   - id (uint32_t) : returned by closest() if it is the hit
+         *   - box (AABB const&) : the box
+         *   - origin, dir (glm::vec3 const&) : the ray in the space of the box (dir is not normalized : the distances stay world distances)
+         */
+        void addBox(uint32_t id, AABB const& box, glm::vec3 const& origin, glm::vec3 const& dir);
+
+        /**
+         *  Finds the closest hit
+         *   - ray (Ray const&) : the ray in world space, with a normalized direction
+         *   - id (uint32_t&) : receives the id of the hit candidate
+         *   - t (float&) : receives the distance of the hit along the ray
+         *  Returns false if no candidate is hit
+         */
+        bool closest(Ray const& ray, uint32_t& id, float& t) const;
+
+    private:
+        // tested 4 at once, the last ones (count % 4) one by one
+        std::vector<uint32_t> sphereIds;
+        std::vector<float> sx, sy, sz, sr;
+
+        std::vector<uint32_t> boxIds;
+        std::vector<float> ox, oy, oz;       // the ray origin
+        std::vector<float> ix, iy, iz;       // 1 / the ray direction
+        std::vector<float> minX, minY, minZ;
+        std::vector<float> maxX, maxY, maxZ;
+};
+
+#endif // RAYCANDIDATES_H_
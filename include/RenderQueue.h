@@ -0,0 +1,110 @@
+#ifndef RENDERQUEUE_H_
+#define RENDERQUEUE_H_
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "ShadingProgram.h"
+#include "Material.h"
+#include "Mesh.h"
+#include "Light.h"
+#include "UniformBuffer.h"
+
+/**
+ *  One draw call waiting in a RenderQueue
+ */
+struct DrawItem {
+    const ShadingProgram* program;
+    const Material* mtl;
+    const Mesh* mesh;
+    glm::mat4 model;
+    glm::mat3 invModel3x3;
+};
+
+/**
+ *  The data that is the same for every draw of a frame
+ */
+struct FrameData {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 cameraPosition;
+    const Light* lights;
+    uint32_t nbLights;
+};
+
+/**
+ *  A flat list of draw calls, sorted by a 64 bits key before being submitted so that
+ *  the program, texture, material and mesh only change when the key changes.
+ *
+ *  Key layout, most significant bits first :
+ *   - FrontToBack (opaque)  : program 8 | texture 12 | material 12 | mesh 8 | depth 24
+ *   - BackToFront (blended) : ~depth 24 | program 8 | texture 12 | material 12 | mesh 8
+ *  The ids are truncated, a collision only makes the sort less effective, never wrong.
+ */
+class RenderQueue {
+
+    public:
+        enum class DepthOrder { FrontToBack, BackToFront };
+
+        /**
+         *  Constructor :
+         *   - order (DepthOrder) : how items are sorted by depth
+         *   - farPlane (float) : the depth at which the quantized depth saturates
+         */
+        RenderQueue(DepthOrder order = DepthOrder::FrontToBack, float farPlane = 100.f);
+
+        /**
+         *  Empties the queue. The memory is kept for the next frame
+         *   - frame (FrameData const&) : the frame the next items belong to (used for their depth)
+         */
+        void begin(FrameData const& frame);
+
+        /**
+         *  Adds a draw call to the queue
+         *   - item (DrawItem const&) : the draw call
+         */
+        void push(DrawItem const& item);
+
+        /**
+         *  Sorts the queue by key (radix sort)
+         */
+        void sort();
+
+        /**
+         *  Writes the Object block of every item in key order in the ring, then issues the draw calls,
+         *  changing state only when needed, and unbinds everything.
+         *  The Frame block must already be bound (see FrameUniformBuffer::update)
+         *   - objects (UniformRing&) : a ring of ObjectBlock bound to OBJECT_BLOCK_BINDING
+         */
+        void submit(UniformRing& objects);
+
+        /**
+         *  Set up the vertex attributes for every draw instead of binding the mesh VAO (see Mesh::bindLegacy)
+         */
+        void setLegacyAttribs(bool legacy) { legacyAttribs = legacy; }
+
+        /**
+         *  Returns the number of items in the queue
+         */
+        size_t size() const { return items.size(); }
+
+    private:
+        struct SortEntry {
+            uint64_t key;
+            uint32_t index; // into items
+        };
+
+        uint64_t makeKey(DrawItem const& item) const;
+
+        DepthOrder order;
+        float farPlane;
+        bool legacyAttribs = false;
+        FrameData frame;
+
+        std::vector<DrawItem> items;
+        std::vector<SortEntry> entries, scratch;
+        std::vector<GLintptr> offsets; // of the Object block of each entry, in sorted order
+};
+
+#endif // RENDERQUEUE_H_
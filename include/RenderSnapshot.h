@@ -0,0 +1,95 @@
+#ifndef RENDERSNAPSHOT_H_
+#define RENDERSNAPSHOT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "RenderQueue.h"
+#include "InstanceBatch.h"
+
+/**
+ *  What the renderer needs from a scene for one frame : the visible draws with their world matrices and materials,
+ *  and the visible instances. Recorded by Scene::record, then submitted without touching the scene
+ */
+class RenderFrame {
+
+    public:
+        struct Instance {
+            InstanceBatch* batch;
+            glm::mat4 model;
+            glm::vec3 color;
+            int layer;
+        };
+
+        /**
+         *  Adds a draw or an instance to the frame
+         */
+        void push(DrawItem const& item) { items.push_back(item); }
+        void push(InstanceBatch* batch, glm::mat4 const& model, glm::vec3 const& color, int layer) { instances.push_back({batch, model, color, layer}); }
+
+        /**
+         *  Empties the frame, keeping the memory for the next one
+         */
+        void clear() { items.clear(); instances.clear(); nbDrawn = 0; nbCulled = 0; }
+
+        /**
+         *  Sends the frame to a render queue and its instances to their batches
+         *   - queue (RenderQueue&) : the queue
+         */
+        void submit(RenderQueue& queue) const;
+
+        /**
+         *  Returns the number of the simulation frame recorded, 0 for a frame never written
+         */
+        uint64_t getNumber() const { return number; }
+
+        // drawables (nodes or static batches) recorded, or skipped as outside the frustum
+        uint32_t nbDrawn = 0, nbCulled = 0;
+
+    private:
+        std::vector<DrawItem> items;
+        std::vector<Instance> instances;
+        uint64_t number = 0;
+
+        friend class RenderSnapshot;
+};
+
+/**
+ *  Three RenderFrames shared by a writer (the simulation) and a reader (the renderer), without locks :
+ *  the writer fills its frame then publishes it, the reader takes the most recent published frame.
+ *  One frame is always being written, one read, and the third is the last published one. Their roles are
+ *  swapped through one atomic index, so neither side ever waits and the reader never sees a frame being written.
+ *  The meshes, materials and batches a frame points to must live until it is read (do not destroy nodes mid-frame)
+ */
+class RenderSnapshot {
+
+    public:
+        /**
+         *  Writer side : returns the frame to fill, emptied
+         */
+        RenderFrame& beginWrite();
+
+        /**
+         *  Writer side : makes the frame filled since beginWrite() the most recent one
+         */
+        void publish();
+
+        /**
+         *  Reader side : returns the most recent published frame. It stays valid until the next call,
+         *  and is the same as the previous one if nothing was published since (an empty frame before the first publish)
+         */
+        RenderFrame const& acquire();
+
+    private:
+        static constexpr uint32_t FRESH = 4; // set in ready when the frame was published after the last acquire()
+
+        RenderFrame frames[3];
+        uint32_t writing = 0;             // only used by the writer
+        uint32_t reading = 1;             // only used by the reader
+        std::atomic<uint32_t> ready{2};   // the index of the last published frame, | FRESH
+        uint64_t nbPublished = 0;         // only used by the writer
+};
+
+#endif // RENDERSNAPSHOT_H_
@@ -0,0 +1,22 @@
+#ifndef RENDERSYSTEM_H_
+#define RENDERSYSTEM_H_
+
+#include "World.h"
+#include "Scene.h"
+
+/**
+ *  Copies the components of the entities to the nodes drawing them
+ */
+class RenderSystem {
+
+    public:
+        /**
+         *  Sends the moved transforms and the materials to the scene nodes, and the positions of the lights to the lights.
+         *  Only the moved entities dirty their nodes : the others are not recomputed by the scene
+         *   - world (World&) : the entities
+         *   - scene (Scene&) : the scene of their MeshComponents
+         */
+        static void sync(World& world, Scene& scene);
+};
+
+#endif // RENDERSYSTEM_H_
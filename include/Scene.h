@@ -1,9 +1,8 @@
 #ifndef SCENE_H_
 #define SCENE_H_
 
-#include <stack>
 #include <vector>
-#include <map>
+#include <string>
 #include <GL/glew.h>
 
 #include "Cone.h"
@@ -14,43 +13,85 @@
 #include "Material.h"
 #include "Light.h"
 #include "Texture.h"
+#include "MeshRegistry.h"
+#include "ShadingProgram.h"
+#include "RenderQueue.h"
+#include "InstanceBatch.h"
+#include "StaticBatch.h"
+#include "TransformHierarchy.h"
+#include "BVH.h"
+#include "Frustum.h"
+#include "SceneFile.h"
+#include "Pool.h"
+#include "NameTable.h"
+#include "RenderSnapshot.h"
+#include "RayCandidates.h"
 
+class Scene;
+
+// the identifier of a node of a scene, given once by Scene::addPart or Scene::findPart.
+// It becomes invalid (Scene::getPart returns nullptr) when the node is destroyed
+typedef PoolHandle PartHandle;
+
+/**
+ *  A node of a scene. The nodes are allocated by their scene (see Scene::createNode) and destroyed with it
+ *  or by Scene::destroy, never deleted by hand
+ */
 class SceneNode
 {
-    public:
+    private:
         /**
          *  Constructor :
-         *   - g (Geometry*) : the 3D model associated to the node (can be nullptr for a node with no geometry)
+         *   - g (Geometry*) : the 3D model associated to the node (can be nullptr for a node with no geometry).
+         *                     Its mesh is shared with every node using an equal geometry (see MeshRegistry).
+         *                     The geometry must outlive the node if the node is to be baked in a static batch
          *   - m (glm::mat4) : the transformation matrix of the node
+         *   - format (VertexFormat) : how the mesh stores its vertices, it must match the shader drawing it
          */
-        SceneNode(Geometry* g, glm::mat4 m);
-        // destructor
-        ~SceneNode();
+        SceneNode(Geometry* g, glm::mat4 m, VertexFormat format = VertexFormat());
+
+        /**
+         *  Constructor for a node whose mesh was already acquired (see Scene::load) :
+         *   - g (const Geometry*) : the 3D model associated to the node (can be nullptr)
+         *   - mesh (MeshHandle const&) : the mesh of g
+         *   - bounds (AABB const&), sphere (BoundingSphere const&) : the box and the sphere of g
+         *   - mp, ms (glm::mat4 const&) : the propagation and transformation matrices of the node
+         */
+        SceneNode(const Geometry* g, MeshHandle const& mesh, AABB const& bounds, BoundingSphere const& sphere,
+                  glm::mat4 const& mp, glm::mat4 const& ms);
+
+        template <typename T, uint32_t CHUNK_SIZE> friend class Pool;
+
+    public:
+        /**
+         *  Returns the handle of the node in its scene
+         */
+        PartHandle getHandle() const { return handle; }
 
         /**
          *  Used to set the matrices of the node
          *   - m (glm::mat4 const&) : the new propagation and transformation matrix of the node
          */
-        void setMatrices(glm::mat4 const& m) { matrixPropagate = matrixSelf = m; }
+        void setMatrices(glm::mat4 const& m) { setMatrixP(m); setMatrixS(m); }
 
         /**
          *  Used to set the matrices of the node
          *   - mp (glm::mat4 const&) : the new propagation matrix of the node
          *   - ms (glm::mat4 const&) : the new transformation matrix of the node
          */
-        void setMatrices(glm::mat4 const& mp, glm::mat4 const& ms) { matrixPropagate = mp;  matrixSelf = ms; }
+        void setMatrices(glm::mat4 const& mp, glm::mat4 const& ms) { setMatrixP(mp); setMatrixS(ms); }
 
         /**
          *  Used to set the matrices of the node
          *   - m (glm::mat4 const&) : the new transformation matrix of the node
          */
-        void setMatrixS(glm::mat4 const& m) { matrixSelf = m; }
+        void setMatrixS(glm::mat4 const& m);
 
         /**
          *  Used to set the matrices of the node
          *   - m (glm::mat4 const&) : the new propagation matrix of the node
          */
-        void setMatrixP(glm::mat4 const& m) { matrixPropagate = m; }
+        void setMatrixP(glm::mat4 const& m);
 
         /**
          *  Used to set the material of the node
@@ -58,32 +99,117 @@ class SceneNode
          */
         void setMaterial(Material* m) { mat = m; }
 
+        /**
+         *  Used to set the program drawing the node when it is sent to a RenderQueue
+         *   - p (ShadingProgram*) : the program
+         */
+        void setProgram(ShadingProgram* p) { program = p; }
+
+        /**
+         *  Draw the node with an instance batch instead of its own draw call
+         *   - b (InstanceBatch*) : the batch, nullptr to draw the node alone
+         *   - l (int) : the layer of the batch texture array, -1 for no texture
+         */
+        void setInstances(InstanceBatch* b, int l) { instances = b; layer = l; }
+
+        /**
+         *  Marks the node as never moving relative to its parent : it will be baked in the static batch
+         *  of its nearest dynamic ancestor (see Scene::bakeStatic). Nodes drawn by an instance batch are never baked
+         *   - s (bool) : true if the node is static
+         */
+        void setStatic(bool s) { isStatic = s; }
+
         /**
          *  Used to add a child node to this node
-         *   - bp (SceneNode*) : the node to add as a child
+         *   - bp (SceneNode*) : the node to add as a child, created by the same scene and with no parent yet
          */
-        SceneNode* addChild(SceneNode* bp) { childs.push_back(bp); return bp; }
+        SceneNode* addChild(SceneNode* bp);
 
+    private:
         /**
-         *  Used to render the node
+         *  Used to render the node alone
          *   - uMV (GLuint) : the uniform location for the model view matrix
+         *   - mv (glm::mat4 const&) : the model view matrix of the node
          */
-        void Render(GLint uMV);
+        void renderSelf(GLint uMV, glm::mat4 const& mv);
+
+        /**
+         *  Used to record the node alone in a frame (as a draw or an instance). Its static batch is culled and recorded apart
+         *   - frame (RenderFrame&) : the frame
+         *   - model (glm::mat4 const&) : the model matrix of the node
+         *   - normal (glm::mat3 const&) : the inverse of the 3x3 part of model
+         */
+        void recordSelf(RenderFrame& frame, glm::mat4 const& model, glm::mat3 const& normal);
+
+        /**
+         *  Returns true if the node draws itself (alone or with its instance batch)
+         */
+        bool isDrawn() const { return instances != nullptr || (mesh && !isStatic); }
+
+        /**
+         *  Returns true if the raycasts test the sphere of the geometry rather than its box : when it is tighter,
+         *  and still a sphere once transformed (uniform scale)
+         *   - model (glm::mat4 const&) : the model matrix of the node
+         *   - scale (float&) : receives the scale of the radius
+         */
+        bool isPickedBySphere(glm::mat4 const& model, float& scale) const;
+
+        /**
+         *  Returns the local matrices of the node, from the scene once the node is in one
+         */
+        glm::mat4 const& getMatrixP() const;
+        glm::mat4 const& getMatrixS() const;
+
+        /**
+         *  Bakes the static childs of the node in the static batch of anchor, recursively.
+         *  Returns true if the whole subtree was baked
+         */
+        bool bakeStatic(SceneNode& anchor, glm::mat4 const& toAnchor, std::vector<StaticBatch*>& batches);
 
-    private:
         Material* mat = nullptr;
-        GLuint vaoID = 0;
-        GLuint vboID = 0;
-        unsigned int nbVert;
-        std::vector<SceneNode*> childs;
+        const Geometry* geometry = nullptr;
+        AABB bounds;                        // the box of the geometry, in the node space
+        BoundingSphere sphere;              // the sphere of the geometry, in the node space (tested by the raycasts if tighter)
+        MeshHandle mesh;
+        ShadingProgram* program = nullptr;
+        InstanceBatch* instances = nullptr;
+        int layer = -1;
+        bool isStatic = false;
+        bool fullyBaked = false;            // the whole subtree is in the static batch of an ancestor
+        SceneNode* bakedIn = nullptr;       // the anchor whose static batch draws this node
+        glm::mat4 bakedModel;               // the model matrix of a baked node, in the space of bakedIn
+        StaticBatch* staticBatch = nullptr; // the static descendants, drawn with the matrix of this node
+        std::vector<SceneNode*> bakedNodes; // the nodes drawn by staticBatch, tested one by one by the raycasts
+        // the childs are linked through the nodes themselves (their slots in the pool never move) : adding one allocates nothing
+        SceneNode* parent = nullptr;
+        SceneNode* firstChild = nullptr;
+        SceneNode* lastChild = nullptr;
+        SceneNode* nextSibling = nullptr;
+        PartHandle handle;
+        uint32_t name = NameTable::NONE;    // the offset of the name of the node in the part names of the scene, NONE if unnamed
+
+        // the matrices are only kept here until the node is added to a scene, they then live in its TransformHierarchy
         glm::mat4 matrixPropagate;
         glm::mat4 matrixSelf;
-
-        static std::stack<glm::mat4> matrices;
+        Scene* scene = nullptr;
+        uint32_t transform = TransformHierarchy::NO_PARENT;
 
         friend class Scene;
 };
 
+/**
+ *  The closest node crossed by a ray (see Scene::raycast)
+ */
+struct RayHit
+{
+    PartHandle node;       // PartHandle() if nothing was hit
+    glm::vec3 point;       // the hit point, in world space
+    glm::vec3 normal;      // the normal of the surface at the hit point, in world space
+    float distance = 0.f;  // the distance from the origin of the ray to the hit point
+
+    explicit operator bool() const { return !node.isNull(); }
+};
+
 class Scene
 {
     public:
@@ -99,33 +225,171 @@ class Scene
         void Render(GLint uMV);
 
         /**
-         *  Add a part at the root of the tree.
-         *   - name (std::string) : the name of the node. This will be used as the identifier for the node
-         *   - node (SceneNode*) : the associated node.
+         *  Will send the visible part of the scene to a render queue. The matrices sent are world matrices (the view is not applied).
+         *  The nodes (and static batches) whose world box is outside the frustum are skipped, the boxes of the moved ones are refitted first
+         *   - queue (RenderQueue&) : the queue
+         *   - frustum (Frustum const&) : the frustum of the camera
+         */
+        void enqueue(RenderQueue& queue, Frustum const& frustum);
+
+        /**
+         *  Records the visible part of the scene in a frame, like enqueue() : world matrices, materials and instances
+         *  are copied so that the frame can be submitted later, while the scene is already being modified
+         *   - frame (RenderFrame&) : the frame, filled after what it already contains
+         *   - frustum (Frustum const&) : the frustum of the camera
+         */
+        void record(RenderFrame& frame, Frustum const& frustum);
+
+        /**
+         *  Records the visible part of the scene in the write frame of a snapshot, then publishes it.
+         *  Called by the simulation side, while the render side submits the previous frame (see RenderSnapshot)
+         *   - snapshot (RenderSnapshot&) : the snapshot
+         *   - frustum (Frustum const&) : the frustum of the camera
+         */
+        void snapshot(RenderSnapshot& snapshot, Frustum const& frustum) { record(snapshot.beginWrite(), frustum); snapshot.publish(); }
+
+        /**
+         *  Finds the closest node crossed by a ray. The BVH gives the candidates, which are then tested exactly
+         *  (against the sphere of their geometry when it is tighter than its box) all at once.
+         *  Nodes with no geometry are never hit, the nodes baked in a static batch are
+         *   - origin (glm::vec3 const&) : the origin of the ray, in world space
+         *   - dir (glm::vec3 const&) : the direction of the ray, in world space (normalized here)
+         */
+        RayHit raycast(glm::vec3 const& origin, glm::vec3 const& dir);
+        RayHit raycast(Ray const& ray) { return raycast(ray.origin, ray.dir); }
+
+        /**
+         *  Bakes every static node in the static batch of its nearest dynamic ancestor (the root is dynamic).
+         *  The fully baked subtrees are then frozen in the transform hierarchy : moving their anchor costs no matrix
+         *  maths for them. Must be called once the tree is built, the static nodes must not be modified afterward
+         *   - format (VertexFormat) : how the batches store their vertices
+         */
+        void bakeStatic(VertexFormat format);
+
+        /**
+         *  Prints how many meshes the scene uses and how much GPU memory sharing them saves
+         */
+        void reportMemory() const;
+
+        /**
+         *  Returns the number of nodes whose matrices were recomputed by the last Render(), enqueue() or record().
+         *  Only the nodes moved since the previous frame and their descendants are
+         */
+        uint32_t getNbUpdatedNodes() const { return transforms.getNbUpdated(); }
+
+        /**
+         *  Returns the number of nodes in the scene
+         */
+        uint32_t getNbNodes() const { return transforms.size(); }
+
+        /**
+         *  Returns the number of drawables (nodes or static batches) sent, or skipped as outside the frustum, by the last enqueue() or record()
+         */
+        uint32_t getNbDrawn() const { return nbDrawn; }
+        uint32_t getNbCulled() const { return nbCulled; }
+
+        /**
+         *  Creates a node in the node pool of the scene. It is drawn once added with addPart() or addChild(),
+         *  and destroyed with the scene if it never is. Same parameters as the constructor of SceneNode :
+         *   - g (Geometry*) : the 3D model associated to the node (can be nullptr)
+         *   - m (glm::mat4) : the transformation matrix of the node
+         *   - format (VertexFormat) : how the mesh stores its vertices, it must match the shader drawing it
+         */
+        SceneNode* createNode(Geometry* g, glm::mat4 m, VertexFormat format = VertexFormat());
+
+        /**
+         *  Destroys a node and all its descendants in one batch : their transforms are removed from the hierarchy
+         *  in a single compaction and their slots go back to the pool. Every handle on them becomes invalid.
+         *  Does nothing if the handle is already invalid
+         *   - part (PartHandle) : the root of the subtree to destroy
+         */
+        void destroy(PartHandle part);
+
+        /**
+         *  Add a part at the root of the tree. Exits if the name is already used.
+         *  Returns the handle of the part, to use instead of the name in the per frame calls
+         *   - name (std::string const&) : the name of the node. This will be used as the identifier for the node, "" for an unnamed node
+         *   - node (SceneNode*) : the associated node, created by createNode().
+         */
+        PartHandle addPart(std::string const& name, SceneNode* node) { return addPart(name, PartHandle(), node); }
+
+        /**
+         *  Add a part to the tree with the specified parent. Exits if the name is already used or if the parent was destroyed.
+         *  Returns the handle of the part
+         *   - name (std::string const&) : the name of the node. This will be used as the identifier for the node, "" for an unnamed node
+         *   - parent (PartHandle) : the parent node, PartHandle() for the root.
+         *   - node (SceneNode*) : the associated node, created by createNode().
          */
-        void addPart(std::string name, SceneNode* node) { parts.insert({name, root->addChild(node)}); }
+        PartHandle addPart(std::string const& name, PartHandle parent, SceneNode* node);
 
         /**
-         *  Add a part to the tree with the specified parent.
-         *   - name (std::string) : the name of the node. This will be used as the identifier for the node
-         *   - parent (std::string) : the name of the parent node.
+         *  Add a part to the tree with the specified parent. Exits if the name is already used or if there is no such parent.
+         *  Returns the handle of the part
+         *   - name (std::string const&) : the name of the node. This will be used as the identifier for the node
+         *   - parent (std::string const&) : the name of the parent node.
          *   - node (SceneNode*) : the associated node.
          */
-        void addPart(std::string name, std::string parent, SceneNode* node) { parts.insert({name, parts[parent]->addChild(node)}); }
+        PartHandle addPart(std::string const& name, std::string const& parent, SceneNode* node) { return addPart(name, findPart(parent), node); }
+
+        /**
+         *  Adds the nodes of a compiled scene file, as parts named after the nodes.
+         *  The nodes come from the node pool, with one mesh lookup per shape of the file. Nothing is allocated per node :
+         *  the names are copied in the buffer of the part names, room being made for all of them first, and the nodes
+         *  are linked to their parents through their slots
+         *  Exits if a shape or a material of the file is not in the library, or if a name is already used.
+         *  Returns the handle of the first node of the file
+         *   - file (SceneFile const&) : the file
+         *   - library (SceneLibrary const&) : the shapes and materials the file refers to
+         *   - parent (PartHandle) : the part the roots of the file are attached to, PartHandle() for the root of the scene
+         *   - prefix (std::string const&) : added before the names of the nodes, to load a file several times
+         */
+        PartHandle load(SceneFile const& file, SceneLibrary const& library, PartHandle parent = PartHandle(), std::string const& prefix = "");
 
         /**
-         *  Will call setMaterial() on the given node
-         *   - name (std::string) : the name of the node
+         *  Returns the handle of the part of the given name. Exits if there is no such part
+         *   - name (std::string const&) : the name of the node
+         */
+        PartHandle findPart(std::string const& name) const;
+
+        /**
+         *  Returns the name of a part, "" for an unnamed or destroyed part. Valid until a part is added
+         *   - part (PartHandle) : the part
+         */
+        const char* getPartName(PartHandle part) const;
+
+        /**
+         *  Returns the node of a part, nullptr if it was destroyed
+         *   - part (PartHandle) : the part
+         */
+        SceneNode* getPart(PartHandle part) const { return pool.get(part); }
+
+        /**
+         *  Returns the node of the given name. Exits if there is no such part
+         *   - name (std::string const&) : the name of the node
+         */
+        SceneNode* getPart(std::string const& name) const { return pool.get(findPart(name)); }
+
+        /**
+         *  Will call setMaterial() on the given node, if it was not destroyed
+         *   - part (PartHandle) : the node
          *   - m (Material*) : the new material of the node
          */
-        void partSetMaterial(std::string name, Material* m) { parts[name]->setMaterial(m); }
+        void partSetMaterial(PartHandle part, Material* m) { if (SceneNode* n = pool.get(part)) n->setMaterial(m); }
 
         /**
-         *  Will call setMatrices() on the given node
-         *   - name (std::string) : the name of the node
+         *  Will call setMatrices() on the given node, if it was not destroyed
+         *   - part (PartHandle) : the node
          *   - m (glm::mat4 const&) : the new matrix of the node
          */
-        void partSetMatrices(std::string name, glm::mat4 const& m) { parts[name]->setMatrices(m); }
+        void partSetMatrices(PartHandle part, glm::mat4 const& m) { if (SceneNode* n = pool.get(part)) n->setMatrices(m); }
+
+        /**
+         *  Will call setMatrices() on the given node, if it was not destroyed
+         *   - part (PartHandle) : the node
+         *   - mp (glm::mat4 const&) : the new propagation matrix of the node
+         *   - ms (glm::mat4 const&) : the new transformation matrix of the node
+         */
+        void partSetMatrices(PartHandle part, glm::mat4 const& mp, glm::mat4 const& ms) { if (SceneNode* n = pool.get(part)) n->setMatrices(mp, ms); }
 
         /**
          *  Will set which light is illuminating the scene
@@ -141,11 +405,71 @@ class Scene
         void setViewMat(glm::mat4 const& m) { view = m; }
 
     private:
+        // declared first : the nodes are destroyed last
+        Pool<SceneNode> pool;
         SceneNode* root;
-        Light* light;
+        Light* light = nullptr;
+        std::vector<StaticBatch*> staticBatches;
+
+        // every node, in the order of the transform hierarchy (parents before childs)
+        TransformHierarchy transforms;
+        std::vector<SceneNode*> nodes;
+
+        /**
+         *  Gives a place in the transform hierarchy to a node and to its childs
+         *   - node (SceneNode*) : the node
+         *   - parent (uint32_t) : the transform of its parent
+         */
+        void attach(SceneNode* node, uint32_t parent);
+
+        /**
+         *  Adds a part named by a prefix followed by a name, as addPart() (without building the name)
+         */
+        PartHandle addPart(const char* prefix, size_t prefixLength, const char* name, size_t length, PartHandle parent, SceneNode* node);
+
+        /**
+         *  Lists what can be drawn (nodes and static batches) and builds the BVH over their world boxes
+         */
+        void buildBVH();
+
+        /**
+         *  Updates the matrices of the moved nodes and refits their boxes in the BVH (built first if needed)
+         */
+        void updateBounds();
+
+        friend class SceneNode;
+
+        // something drawn with the matrices of a node : the node itself, or its static batch
+        struct Drawable {
+            uint32_t node;
+            bool batch;
+        };
+
+        std::vector<Drawable> drawables; // the items of the BVH
+        BVH bvh;
+        bool bvhBuilt = false;
+        std::vector<uint32_t> visible;
+        std::vector<uint32_t> rayHits;   // the items of the BVH crossed by the ray of raycast()
+        RayCandidates candidates;
+        RenderFrame scratch; // the frame of enqueue()
+        uint32_t nbDrawn = 0, nbCulled = 0;
+
+        /**
+         *  Returns the world box of a drawable, from the current matrices
+         */
+        AABB getWorldBounds(Drawable const& d) const;
+
+        /**
+         *  Returns the model matrix of a node and the inverse of its 3x3 part, for the raycasts. Those of a baked node
+         *  are computed from its anchor : the fully baked subtrees are frozen in the transform hierarchy
+         *   - n (SceneNode const*) : the node
+         *   - model (glm::mat4&), inv (glm::mat3&) : receive the matrices
+         */
+        void getPickMatrices(SceneNode const* n, glm::mat4& model, glm::mat3& inv) const;
 
         glm::mat4 view;
-        std::map<std::string, SceneNode*> parts;
+        // the names are only looked up when building the scene, the parts are then reached by handle
+        NameTable partNames;
 };
 
 
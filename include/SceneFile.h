@@ -0,0 +1,157 @@
+#ifndef SCENEFILE_H_
+#define SCENEFILE_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+#include "Geometry.h"
+#include "Material.h"
+#include "ShadingProgram.h"
+#include "VertexFormat.h"
+
+/**
+ *  The shapes and materials a scene file refers to by name, and how its nodes are drawn
+ */
+class SceneLibrary {
+
+    public:
+        /**
+         *  Constructor :
+         *   - program (ShadingProgram*) : the program drawing every node of the file
+         *   - format (VertexFormat) : how the meshes store their vertices, it must match the program
+         */
+        SceneLibrary(ShadingProgram* program, VertexFormat format) : program(program), format(format) {}
+
+        /**
+         *  Gives a name to a shape or a material. They must outlive the scenes using them
+         *   - name (std::string const&) : the name used in the files
+         *   - g (Geometry*) / m (Material*) : the shape or material
+         */
+        void addMesh(std::string const& name, Geometry* g) { meshes[name] = g; }
+        void addMaterial(std::string const& name, Material* m) { materials[name] = m; }
+
+        /**
+         *  Returns the shape or material of the given name, nullptr if there is none
+         *   - name (const char*) : the name
+         */
+        Geometry* findMesh(const char* name) const;
+        Material* findMaterial(const char* name) const;
+
+        ShadingProgram* getProgram() const { return program; }
+        VertexFormat getFormat() const { return format; }
+
+    private:
+        ShadingProgram* program;
+        VertexFormat format;
+        std::unordered_map<std::string, Geometry*> meshes;
+        std::unordered_map<std::string, Material*> materials;
+};
+
+/**
+ *  A compiled scene file : a flat blob mapped in memory, instantiated by Scene::load without parsing.
+ *
+ *  The text form, compiled by compile(), is one statement per line ('#' starts a comment) :
+ *   - var <name> <expr>                            : a named value, usable in the following expressions
+ *   - node <name> <parent|-> <mesh|-> <material|-> [static]
+ *                                                  : a node, its parent must be declared before it ('-' for the root of the file)
+ *   - propagate <ops>  /  local <ops>              : the propagation / transformation matrix of the last node
+ *  where <ops> is a sequence of 'translate x y z', 'rotate degrees x y z' and 'scale x y z' (or 'scale s'),
+ *  composed left to right like the glm calls, and <expr> is an arithmetic expression (+ - * / and parentheses)
+ *  over numbers and vars, written without spaces
+ */
+class SceneFile {
+
+    public:
+        static constexpr uint32_t NONE = ~0u;
+        static constexpr uint32_t FLAG_STATIC = 1;
+
+        // the layout of the blob : a Header, then the vars, the mesh and material names (offsets in the string table),
+        // the nodes (parents before childs) and the string table
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            uint32_t nbVars, nbNodes, nbMeshes, nbMaterials;
+            uint32_t varsOffset, meshesOffset, materialsOffset, nodesOffset, namesOffset;
+            uint32_t size;
+        };
+
+        struct Var {
+            uint32_t name; // offset in the string table
+            float value;
+        };
+
+        struct Node {
+            float propagate[16];
+            float self[16];
+            uint32_t name;     // offset in the string table
+            uint32_t parent;   // index of a previous node, NONE for the root of the file
+            uint32_t mesh;     // index in the mesh names, NONE for no shape
+            uint32_t material; // index in the material names, NONE for no material
+            uint32_t flags;
+            uint32_t pad[3];
+        };
+
+        /**
+         *  Compiles a text scene file into a blob
+         *   - textPath (const char*) : the text file
+         *   - blobPath (const char*) : the blob to write
+         *  Returns false (and prints why) if the text file is invalid or a file could not be opened
+         */
+        static bool compile(const char* textPath, const char* blobPath);
+
+        /**
+         *  Compiles the text file if the blob is missing or older, then opens the blob
+         *   - textPath (const char*) : the text file
+         *   - blobPath (const char*) : the blob
+         *  Returns nullptr if it could not be compiled or opened
+         */
+        static SceneFile* openCompiled(const char* textPath, const char* blobPath);
+
+        /**
+         *  Maps a blob in memory and checks its layout
+         *   - blobPath (const char*) : the blob
+         *  Returns nullptr (and prints why) if it is not a valid blob
+         */
+        static SceneFile* open(const char* blobPath);
+
+        // destructor (unmaps the blob)
+        ~SceneFile();
+
+        SceneFile(const SceneFile&) = delete;
+        SceneFile& operator=(const SceneFile&) = delete;
+
+        /**
+         *  Returns the content of the blob
+         */
+        uint32_t getNbNodes() const { return header->nbNodes; }
+        uint32_t getNbMeshes() const { return header->nbMeshes; }
+        uint32_t getNbMaterials() const { return header->nbMaterials; }
+        const Node& getNode(uint32_t i) const { return nodes[i]; }
+        const char* getMeshName(uint32_t i) const { return names + meshes[i]; }
+        const char* getMaterialName(uint32_t i) const { return names + materials[i]; }
+        const char* getName(uint32_t offset) const { return names + offset; }
+
+        /**
+         *  Returns the value of a var of the file, so that the program uses the same dimensions. Exits if there is no such var
+         *   - name (const char*) : the name of the var
+         */
+        float getVar(const char* name) const;
+
+    private:
+        SceneFile() = default;
+
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        bool mapped = false; // mmapped, or read in a buffer where mmap is not available
+
+        const Header* header = nullptr;
+        const Var* vars = nullptr;
+        const uint32_t* meshes = nullptr;
+        const uint32_t* materials = nullptr;
+        const Node* nodes = nullptr;
+        const char* names = nullptr;
+};
+
+#endif // SCENEFILE_H_
@@ -7,8 +7,80 @@
 #include <GL/gl.h>
 #include <iostream>
 #include <cstdlib>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #include "logger.h"
 
+/** \brief Tells which GL uniform types a C++ type can be uploaded to.*/
+template<typename T>
+struct UniformType
+{
+    static bool accepts(GLenum type);
+};
+
+template<> inline bool UniformType<float>::accepts(GLenum type)     {return type == GL_FLOAT;}
+template<> inline bool UniformType<glm::vec2>::accepts(GLenum type) {return type == GL_FLOAT_VEC2;}
+template<> inline bool UniformType<glm::vec3>::accepts(GLenum type) {return type == GL_FLOAT_VEC3;}
+template<> inline bool UniformType<glm::vec4>::accepts(GLenum type) {return type == GL_FLOAT_VEC4;}
+template<> inline bool UniformType<glm::mat3>::accepts(GLenum type) {return type == GL_FLOAT_MAT3;}
+template<> inline bool UniformType<glm::mat4>::accepts(GLenum type) {return type == GL_FLOAT_MAT4;}
+template<> inline bool UniformType<int>::accepts(GLenum type)
+{
+    switch(type)
+    {
+        case GL_INT:
+        case GL_BOOL:
+        case GL_SAMPLER_1D:
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_2D_SHADOW:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/** \brief A typed handle on a uniform of a Shader.
+ * The location is resolved once (see Shader::uniform), setting the value does no string lookup.*/
+template<typename T>
+class Uniform
+{
+    public:
+        /** \brief Construct an invalid handle. Setting it is a no-op for OpenGL.*/
+        Uniform() : m_location(-1) {}
+
+        /** \brief Construct a handle on a known location.
+         * \param location the uniform location in its program*/
+        explicit Uniform(GLint location) : m_location(location) {}
+
+        /** \brief Tells if this handle was resolved to an active uniform.
+         * \return true if the handle is usable*/
+        bool isValid() const {return m_location >= 0;}
+
+        /** \brief Get the location of this uniform.
+         * \return the location, -1 if the handle is invalid*/
+        GLint getLocation() const {return m_location;}
+
+        /** \brief Set the value of the uniform in the currently used program.
+         * \param value the new value*/
+        void set(const T& value) const;
+
+    private:
+        GLint m_location; /*!< The uniform location, -1 if invalid*/
+};
+
+template<> inline void Uniform<int>::set(const int& value) const         {glUniform1i(m_location, value);}
+template<> inline void Uniform<float>::set(const float& value) const     {glUniform1f(m_location, value);}
+template<> inline void Uniform<glm::vec2>::set(const glm::vec2& v) const {glUniform2fv(m_location, 1, glm::value_ptr(v));}
+template<> inline void Uniform<glm::vec3>::set(const glm::vec3& v) const {glUniform3fv(m_location, 1, glm::value_ptr(v));}
+template<> inline void Uniform<glm::vec4>::set(const glm::vec4& v) const {glUniform4fv(m_location, 1, glm::value_ptr(v));}
+template<> inline void Uniform<glm::mat3>::set(const glm::mat3& m) const {glUniformMatrix3fv(m_location, 1, GL_FALSE, glm::value_ptr(m));}
+template<> inline void Uniform<glm::mat4>::set(const glm::mat4& m) const {glUniformMatrix4fv(m_location, 1, GL_FALSE, glm::value_ptr(m));}
+
 /** \brief A graphic program.*/
 class Shader
 {
@@ -45,11 +117,58 @@ class Shader
          * \return the Shader constructed or NULL if error
          * */
         static Shader* loadFromStrings(const std::string& vertexString, const std::string& fragString);
+
+        /** \brief get a typed handle on an active uniform of this shader. Prints an error if the uniform
+         * is not active in the linked program or if its GL type does not match T.
+         * Meant to be called once at load time, the handle is then kept by the caller.
+         * \param name the uniform name, without "[0]" for arrays.
+         * \return the handle, invalid (see Uniform::isValid) on error*/
+        template<typename T>
+        Uniform<T> uniform(const std::string& name) const;
+
+        /** \brief get the location of an active uniform from the table read at link time.
+         * \param name the uniform name, without "[0]" for arrays.
+         * \return the location, -1 if the uniform is not active*/
+        GLint getUniformLocation(const std::string& name) const;
+
+        /** \brief get the location of an active attribute from the table read at link time.
+         * \param name the attribute name
+         * \return the location, -1 if the attribute is not active*/
+        GLint getAttribLocation(const std::string& name) const;
+
+        /** \brief get the size of an active uniform block, to check it against the C++ struct mirroring it.
+         * The blocks named in UniformBlocks.h are bound to their binding point at link time.
+         * \param name the block name
+         * \return the GL_UNIFORM_BLOCK_DATA_SIZE of the block, -1 if the block is not active*/
+        GLint getUniformBlockSize(const std::string& name) const;
     private:
+        /** \brief An active uniform or attribute of the linked program*/
+        struct ActiveVariable
+        {
+            std::string name;     /*!< The name, without "[0]" for arrays*/
+            GLint       location; /*!< The location in the program*/
+            GLenum      type;     /*!< The GL type (GL_FLOAT_MAT4, GL_SAMPLER_2D, ...)*/
+            GLint       size;     /*!< The array size, 1 for non-arrays*/
+        };
+
         GLuint m_programID; /*!< The shader   program ID*/
         GLuint m_vertexID;  /*!< The vertex   shader  ID*/
         GLuint m_fragID;    /*!< The fragment shader  ID*/
 
+        std::vector<ActiveVariable> m_uniforms;   /*!< The active uniforms, sorted by name*/
+        std::vector<ActiveVariable> m_attributes; /*!< The active attributes, sorted by name*/
+        std::vector<ActiveVariable> m_blocks;     /*!< The active uniform blocks, sorted by name. location is the block index, size the data size*/
+
+        /** \brief Read the active uniforms, attributes and uniform blocks of the linked program into the tables,
+         * and bind the known uniform blocks to their binding point*/
+        void readActiveVariables();
+
+        /** \brief Find a variable by name in one of the tables
+         * \param table the sorted table to look into
+         * \param name the variable name
+         * \return the variable or NULL if not found*/
+        static const ActiveVariable* find(const std::vector<ActiveVariable>& table, const std::string& name);
+
         /* \brief Bind the attributes to known locations (vPosition to 0, vColor to 1 for example)*/
         virtual void bindAttributes();
 
@@ -59,4 +178,21 @@ class Shader
         static int loadShader(const std::string& code, int type);
 };
 
+template<typename T>
+Uniform<T> Shader::uniform(const std::string& name) const
+{
+    const ActiveVariable* var = find(m_uniforms, name);
+    if(var == NULL)
+    {
+        ERROR("Uniform '%s' is not an active uniform of program %d (misspelled or optimized out)\n", name.c_str(), m_programID);
+        return Uniform<T>();
+    }
+    if(!UniformType<T>::accepts(var->type))
+    {
+        ERROR("Uniform '%s' of program %d has GL type 0x%x which does not match the type expected by the C++ code\n", name.c_str(), m_programID, var->type);
+        return Uniform<T>();
+    }
+    return Uniform<T>(var->location);
+}
+
 #endif
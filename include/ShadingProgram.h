@@ -0,0 +1,38 @@
+#ifndef SHADINGPROGRAM_H_
+#define SHADINGPROGRAM_H_
+
+#include "Shader.h"
+
+/**
+ *  A shader following the interface of Shaders/shading.* : the Frame and Object blocks of UniformBlocks.h and a texture on unit 0.
+ *  The blocks are checked against the C++ structs at load time
+ */
+class ShadingProgram {
+
+    public:
+        /**
+         *  Loads the shader and resolves its uniforms.
+         *  Returns nullptr (and prints why) if it does not compile or does not declare the expected uniform blocks
+         *   - vertPath (const char*) : the vertex shader file
+         *   - fragPath (const char*) : the fragment shader file
+         */
+        static ShadingProgram* loadFromFiles(const char* vertPath, const char* fragPath);
+
+        // destructor (destroys the shader)
+        ~ShadingProgram();
+
+        ShadingProgram(const ShadingProgram&) = delete;
+        ShadingProgram& operator=(const ShadingProgram&) = delete;
+
+        /**
+         *  Returns the program ID of the underlying shader
+         */
+        GLuint getProgramID() const { return shader->getProgramID(); }
+
+    private:
+        ShadingProgram(Shader* s) : shader(s) {}
+
+        Shader* shader;
+};
+
+#endif // SHADINGPROGRAM_H_
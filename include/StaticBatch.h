@@ -0,0 +1,76 @@
+#ifndef STATICBATCH_H_
+#define STATICBATCH_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "MergedGeometry.h"
+#include "RenderQueue.h"
+#include "RenderSnapshot.h"
+
+/**
+ *  Objects that never move relative to a common anchor, baked at load time into one mesh per (program, material).
+ *  The whole batch then costs one draw per material, drawn with the matrix of the anchor
+ */
+class StaticBatch {
+
+    public:
+        // constructor
+        StaticBatch() = default;
+        // destructor (destroys the meshes)
+        ~StaticBatch();
+
+        StaticBatch(const StaticBatch&) = delete;
+        StaticBatch& operator=(const StaticBatch&) = delete;
+
+        /**
+         *  Bakes an object in the batch. Must be called before upload()
+         *   - g (Geometry const&) : the geometry of the object
+         *   - transform (glm::mat4 const&) : the transformation from the object to the anchor space
+         *   - program (const ShadingProgram*) : the program drawing the object
+         *   - mtl (const Material*) : the material of the object
+         */
+        void add(Geometry const& g, glm::mat4 const& transform, const ShadingProgram* program, const Material* mtl);
+
+        /**
+         *  Creates the meshes and frees the baked vertices
+         *   - format (VertexFormat) : how the meshes store their vertices, it must match the programs
+         */
+        void upload(VertexFormat format);
+
+        /**
+         *  Records one draw per material in a frame
+         *   - anchor (glm::mat4 const&) : the current world matrix of the anchor
+         *   - frame (RenderFrame&) : the frame
+         */
+        void record(glm::mat4 const& anchor, RenderFrame& frame) const;
+
+        /**
+         *  Returns the number of objects baked in the batch
+         */
+        size_t getNbObjects() const { return nbObjects; }
+
+        /**
+         *  Returns the number of draws the batch costs
+         */
+        size_t getNbDraws() const { return parts.size(); }
+
+        /**
+         *  Returns the box containing every baked object, in the anchor space
+         */
+        AABB const& getBounds() const { return bounds; }
+
+    private:
+        struct Part {
+            const ShadingProgram* program;
+            const Material* mtl;
+            MergedGeometry geometry;
+            Mesh* mesh;
+        };
+
+        std::vector<Part> parts;
+        size_t nbObjects = 0;
+        AABB bounds;
+};
+
+#endif // STATICBATCH_H_
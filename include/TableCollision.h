@@ -0,0 +1,87 @@
+#ifndef TABLECOLLISION_H_
+#define TABLECOLLISION_H_
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+/**
+ *  What the balls hit on the table, in table space (x along the length, z along the width), built once from the
+ *  dimensions of the table and its rails :
+ *   - the cushions, the segments of the noses of the rails between the pockets
+ *   - the jaws, the segments leading from the ends of the cushions into the pockets
+ *   - the corners, the ends of the jaws, that a ball can hit
+ *   - the pockets, the circles a ball falls in once its center enters them
+ *  Each is stored by component : the tests loop over a few arrays, without walking the scene.
+ *  The segments have a front side only, the one the ball comes from
+ */
+class TableCollision {
+
+    public:
+        static constexpr uint32_t NONE = ~0u;
+
+        struct Segment {
+            glm::vec2 a, dir;  // the start and the unit direction
+            float length;
+            glm::vec2 normal;  // the front side
+        };
+
+        /**
+         *  Constructor :
+         *   - length, width (float) : the table between the noses of the cushions, centered on the origin
+         *   - radius (float) : the balls
+         *   - railWidth (float) : the width of the rails, the length of the jaws
+         *   - cornerMouth, sideMouth (float) : the width of the mouths of the corner and side pockets,
+         *     between the ends of their cushions
+         */
+        TableCollision(float length, float width, float radius, float railWidth, float cornerMouth, float sideMouth);
+
+        /**
+         *  Returns the distance from a point to the closest cushion or jaw, and in normal the direction
+         *  from the closest point of the rails to it
+         *   - p (glm::vec2) : the point
+         *   - normal (glm::vec2&) : receives the direction
+         */
+        float closest(glm::vec2 p, glm::vec2& normal) const;
+
+        /**
+         *  Returns true if a ball centered on a point is far enough from the rails to touch none of them
+         *  and be in no pocket : most balls, the tests stop there
+         *   - p (glm::vec2) : the point
+         */
+        bool isClear(glm::vec2 p) const { return fabsf(p.x) < clearX && fabsf(p.y) < clearZ; }
+
+        /**
+         *  Returns the pocket a point is in, NONE if it is in none
+         *   - p (glm::vec2) : the point
+         */
+        uint32_t pocket(glm::vec2 p) const;
+
+        /**
+         *  Returns the cushions and jaws, the ends of the jaws, and the pockets
+         */
+        uint32_t getNbSegments() const { return (uint32_t)ax.size(); }
+        Segment getSegment(uint32_t k) const;
+        uint32_t getNbCorners() const { return (uint32_t)cornerX.size(); }
+        glm::vec2 getCorner(uint32_t k) const { return glm::vec2(cornerX[k], cornerZ[k]); }
+        uint32_t getNbPockets() const { return (uint32_t)pocketX.size(); }
+        glm::vec2 getPocket(uint32_t k) const { return glm::vec2(pocketX[k], pocketZ[k]); }
+        float getPocketRadius(uint32_t k) const { return pocketR[k]; }
+
+    private:
+        /**
+         *  Adds a cushion, or a jaw and its ends
+         *   - a, b (glm::vec2) : the ends
+         *   - front (glm::vec2) : a direction on the front side
+         */
+        void addCushion(glm::vec2 a, glm::vec2 b, glm::vec2 front);
+        void addJaw(glm::vec2 a, glm::vec2 b, glm::vec2 front);
+
+        std::vector<float> ax, az, dx, dz, len, nx, nz; // the segments
+        std::vector<float> cornerX, cornerZ;
+        std::vector<float> pocketX, pocketZ, pocketR;
+        float clearX, clearZ; // the half sizes of the clear rectangle
+};
+
+#endif // TABLECOLLISION_H_
@@ -32,6 +32,11 @@ class Texture {
          */
         void getSize(int& w, int& h) { w = this->w; h = this->h; }
 
+        /**
+         *  Returns the openGL ID of the texture
+         */
+        GLuint getID() const { return texID; }
+
     private:
         GLuint texID;
         int w, h;
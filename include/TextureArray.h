@@ -0,0 +1,48 @@
+#ifndef TEXTUREARRAY_H_
+#define TEXTUREARRAY_H_
+
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+class TextureArray {
+
+    public:
+        /**
+         *  Constructor : loads every image into one layer of a GL_TEXTURE_2D_ARRAY
+         *   - filenames (std::vector<std::string> const&) : the image files, layer i is filenames[i].
+         *     Images that do not have the size of the first one are scaled to it
+         */
+        TextureArray(std::vector<std::string> const& filenames);
+        // destructor
+        ~TextureArray();
+
+        TextureArray(const TextureArray&) = delete;
+        TextureArray& operator=(const TextureArray&) = delete;
+
+        /**
+         *  Binds the texture array on unit 0 for drawing
+         */
+        void bind();
+
+        /**
+         *  Unbinds the texture array
+         */
+        void unbind();
+
+        /**
+         *  Returns the number of layers
+         */
+        int getNbLayers() const { return layers; }
+
+        /**
+         *  Returns the openGL ID of the texture
+         */
+        GLuint getID() const { return texID; }
+
+    private:
+        GLuint texID = 0;
+        int w = 0, h = 0, layers = 0;
+};
+
+#endif // TEXTUREARRAY_H_
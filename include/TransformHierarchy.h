@@ -0,0 +1,112 @@
+#ifndef TRANSFORMHIERARCHY_H_
+#define TRANSFORMHIERARCHY_H_
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "TransformKernel.h"
+
+/**
+ *  The matrices of a tree of nodes, stored in contiguous arrays in parent-before-child order.
+ *  Each node has two local matrices :
+ *   - propagate : applied to the node and to all its children
+ *   - self : applied to the node only
+ *  update() computes, in one linear pass :
+ *   - world = world(parent) * propagate : the matrix the children are relative to
+ *   - model = world(parent) * self : the matrix the node is drawn with
+ *   - normal = inverse(mat3(model)) : transposed in the shaders to transform the normals
+ *  Only the nodes whose local matrices changed since the last update, and their descendants, are recomputed :
+ *  they are listed first, then computed in one batch by TransformKernel. Frozen nodes are never recomputed
+ */
+class TransformHierarchy {
+
+    public:
+        static constexpr uint32_t NO_PARENT = TransformKernel::NO_PARENT;
+
+        /**
+         *  Adds a node after all the existing ones, which keeps the parent-before-child order.
+         *  Returns the index of the node
+         *   - parent (uint32_t) : the index of the parent, NO_PARENT for a root
+         *   - propagate, self (glm::mat4 const&) : the local matrices of the node
+         */
+        uint32_t add(uint32_t parent, glm::mat4 const& propagate, glm::mat4 const& self);
+
+        /**
+         *  Used to set the local matrices of a node
+         *   - i (uint32_t) : the index of the node
+         *   - m (glm::mat4 const&) : the new matrix
+         */
+        void setPropagate(uint32_t i, glm::mat4 const& m) { propagate[i] = m; dirty[i] = 1; }
+        void setSelf(uint32_t i, glm::mat4 const& m) { self[i] = m; dirty[i] = 1; }
+
+        /**
+         *  Stops recomputing the matrices of a node, which keeps those of its last update : for the nodes whose
+         *  matrices are no longer read (baked in a static batch). Its descendants must be frozen too
+         *   - i (uint32_t) : the index of the node
+         */
+        void freeze(uint32_t i) { frozen[i] = 1; dirty[i] = 0; updated[i] = 0; }
+
+        /**
+         *  Recomputes the world, model and normal matrices of the dirty nodes and of their descendants, but the frozen ones
+         */
+        void update();
+
+        /**
+         *  Returns the number of nodes recomputed by the last update()
+         */
+        uint32_t getNbUpdated() const { return nbUpdated; }
+
+        /**
+         *  Returns true if the matrices of a node were recomputed by the last update()
+         *   - i (uint32_t) : the index of the node
+         */
+        bool wasUpdated(uint32_t i) const { return updated[i] != 0; }
+
+        /**
+         *  Returns the matrices of a node
+         *   - i (uint32_t) : the index of the node
+         */
+        glm::mat4 const& getPropagate(uint32_t i) const { return propagate[i]; }
+        glm::mat4 const& getSelf(uint32_t i) const { return self[i]; }
+        glm::mat4 const& getWorld(uint32_t i) const { return world[i]; }
+        glm::mat4 const& getModel(uint32_t i) const { return model[i]; }
+        glm::mat3 const& getNormal(uint32_t i) const { return normal[i]; }
+
+        /**
+         *  Returns the index of the parent of a node, NO_PARENT for a root
+         *   - i (uint32_t) : the index of the node
+         */
+        uint32_t getParent(uint32_t i) const { return parents[i]; }
+
+        /**
+         *  Returns the number of nodes
+         */
+        uint32_t size() const { return (uint32_t)parents.size(); }
+
+        /**
+         *  Allocates the arrays for a number of nodes at once
+         *   - n (uint32_t) : the total number of nodes
+         */
+        void reserve(uint32_t n);
+
+        /**
+         *  Removes nodes, keeping the order of the others. The parent of a kept node must be kept too.
+         *  The kept nodes are renumbered : node i becomes the number of kept nodes before it
+         *   - removed (std::vector<uint8_t> const&) : 1 for each node to remove
+         */
+        void remove(std::vector<uint8_t> const& removed);
+
+    private:
+        std::vector<uint32_t> parents;
+        std::vector<glm::mat4> propagate, self;
+        std::vector<glm::mat4> world, model;
+        std::vector<glm::mat3> normal;
+        std::vector<uint8_t> dirty;   // the local matrices changed since the last update
+        std::vector<uint8_t> updated; // recomputed by the current update, so the childs must be too
+        std::vector<uint8_t> frozen;  // never recomputed
+        std::vector<uint32_t> batch;  // the nodes recomputed by the current update
+        uint32_t nbUpdated = 0;
+};
+
+#endif // TRANSFORMHIERARCHY_H_
@@ -0,0 +1,66 @@
+#ifndef TRANSFORMKERNEL_H_
+#define TRANSFORMKERNEL_H_
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+/**
+ *  The matrix products of TransformHierarchy::update(), run over arrays of nodes.
+ *  world and model of a node share their left factor (the world matrix of its parent) : with AVX both products
+ *  are done at once, a column of each per register. SSE does them one after the other, and the scalar path uses glm.
+ *  The normal matrices of translate-rotate-scale transforms (orthogonal columns) are computed without a general inversion.
+ *  The instruction set is chosen at runtime as in NarrowPhase : with GCC and Clang the AVX path is compiled for its own
+ *  target only, the best one the processor has is used
+ */
+class TransformKernel {
+
+    public:
+        enum class Path : uint8_t { Scalar, SSE, AVX };
+
+        static constexpr uint32_t NO_PARENT = ~0u;
+
+        /**
+         *  Computes, for a list of nodes in parent-before-child order :
+         *  world = world[parent] * propagate, model = world[parent] * self, normal = inverse(mat3(model))
+         *   - nodes (const uint32_t*), count (uint32_t) : the indices of the nodes to compute
+         *   - parents (const uint32_t*) : the parent of each node, NO_PARENT for a root
+         *   - propagate, self (const glm::mat4*) : the local matrices of each node
+         *   - world, model (glm::mat4*), normal (glm::mat3*) : the results, indexed like the local matrices
+         */
+        static void compose(const uint32_t* nodes, uint32_t count, const uint32_t* parents,
+                            const glm::mat4* propagate, const glm::mat4* self,
+                            glm::mat4* world, glm::mat4* model, glm::mat3* normal);
+
+        /**
+         *  Same as compose(), with the glm products and a general inversion for every node. Kept to measure the kernel against
+         */
+        static void composeReference(const uint32_t* nodes, uint32_t count, const uint32_t* parents,
+                                     const glm::mat4* propagate, const glm::mat4* self,
+                                     glm::mat4* world, glm::mat4* model, glm::mat3* normal);
+
+        /**
+         *  Returns inverse(mat3(m)) : the transposed columns divided by their squared length when they are orthogonal
+         *  (translate-rotate-scale), a general inversion otherwise (shear, from a non uniform scale under a rotation)
+         *   - m (glm::mat4 const&) : the model matrix
+         */
+        static glm::mat3 normalMatrix(glm::mat4 const& m);
+
+        /**
+         *  Returns the best instruction set of the processor (among those built), and the one in use
+         */
+        static Path getBestPath();
+        static Path getPath();
+
+        /**
+         *  Changes the instruction set in use, to compare them. A path the processor does not have falls back to the best one
+         *   - path (Path) : the instruction set
+         */
+        static void setPath(Path path);
+
+        /**
+         *  Returns the name of an instruction set : "avx", "sse" or "scalar"
+         */
+        static const char* getName(Path path);
+};
+
+#endif // TRANSFORMKERNEL_H_
@@ -0,0 +1,41 @@
+#ifndef UNIFORMBLOCKS_H_
+#define UNIFORMBLOCKS_H_
+
+#include <glm/glm.hpp>
+
+/* The uniform blocks shared by the shaders in Shaders/. Shader binds them by name to these fixed binding points when it links.
+ * The structs mirror the std140 layout of the GLSL declarations : vec3 and mat3 columns are padded to vec4 */
+
+#define MAX_LIGHTS 4
+
+#define FRAME_BLOCK_NAME    "Frame"
+#define FRAME_BLOCK_BINDING 0
+
+#define OBJECT_BLOCK_NAME    "Object"
+#define OBJECT_BLOCK_BINDING 1
+
+/* \brief Everything that is constant during a frame. Written once per frame*/
+struct FrameBlock
+{
+    glm::mat4  view;
+    glm::mat4  projection;
+    glm::mat4  viewProjection;
+    glm::vec4  cameraPosition;          /*!< xyz : world space position*/
+    glm::ivec4 nbLights;                /*!< x : number of used lights*/
+    glm::vec4  lightPos[MAX_LIGHTS];    /*!< xyz : world space position*/
+    glm::vec4  lightColor[MAX_LIGHTS];  /*!< rgb*/
+};
+
+/* \brief Per draw data, stored in a ring buffer and selected with glBindBufferRange*/
+struct ObjectBlock
+{
+    glm::mat4 model;
+    glm::vec4 invModel3x3[3];   /*!< the columns of inverse(mat3(model)), transposed in the shader*/
+    glm::vec4 mtlColor;         /*!< rgb*/
+    glm::vec4 mtlCts;           /*!< Ka, Kd, Ks, alpha*/
+};
+
+static_assert(sizeof(FrameBlock)  == 352, "FrameBlock does not match the std140 layout of the Frame block");
+static_assert(sizeof(ObjectBlock) == 144, "ObjectBlock does not match the std140 layout of the Object block");
+
+#endif
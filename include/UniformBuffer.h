@@ -0,0 +1,96 @@
+#ifndef UNIFORMBUFFER_H_
+#define UNIFORMBUFFER_H_
+
+#include <cstdint>
+#include <GL/glew.h>
+
+#include "UniformBlocks.h"
+#include "Light.h"
+
+/**
+ *  The std140 buffer holding the Frame block : written once per frame (in a new storage, without waiting
+ *  for the draws of the previous frame) and bound to FRAME_BLOCK_BINDING
+ */
+class FrameUniformBuffer {
+
+    public:
+        // constructor (creates the openGL buffer)
+        FrameUniformBuffer();
+        // destructor
+        ~FrameUniformBuffer();
+
+        FrameUniformBuffer(const FrameUniformBuffer&) = delete;
+        FrameUniformBuffer& operator=(const FrameUniformBuffer&) = delete;
+
+        /**
+         *  Uploads the frame data and binds the buffer
+         *   - view, projection (glm::mat4 const&) : the camera matrices
+         *   - cameraPosition (glm::vec3 const&) : the world space position of the camera
+         *   - lights (const Light*) : an array of lights, only the MAX_LIGHTS first are used
+         *   - nbLights (uint32_t) : the size of the array
+         */
+        void update(glm::mat4 const& view, glm::mat4 const& projection, glm::vec3 const& cameraPosition, const Light* lights, uint32_t nbLights);
+
+    private:
+        GLuint bufferID = 0;
+        FrameBlock block;
+};
+
+/**
+ *  A ring of uniform blocks of the same size, used for per draw data.
+ *  Each frame writes all its blocks at once in the next segment of the ring (one map for the whole frame),
+ *  then every draw only selects its block with glBindBufferRange.
+ *  A fence per segment makes sure the GPU is done with a segment before it is written again.
+ */
+class UniformRing {
+
+    public:
+        /**
+         *  Constructor :
+         *   - binding (GLuint) : the binding point the blocks are bound to
+         *   - blockSize (size_t) : the size of one block, rounded up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+         *   - blocksPerFrame (size_t) : the initial capacity of a segment, it grows when needed
+         */
+        UniformRing(GLuint binding, size_t blockSize, size_t blocksPerFrame = 256);
+        // destructor
+        ~UniformRing();
+
+        UniformRing(const UniformRing&) = delete;
+        UniformRing& operator=(const UniformRing&) = delete;
+
+        /**
+         *  Moves to the next segment and maps room for nbBlocks blocks
+         */
+        void begin(size_t nbBlocks);
+
+        /**
+         *  Copies a block in the mapped segment
+         *   - data (const void*) : blockSize bytes
+         *  Returns the offset of the block, to give to bind()
+         */
+        GLintptr push(const void* data);
+
+        /**
+         *  Unmaps the segment. Must be called before drawing
+         */
+        void end();
+
+        /**
+         *  Binds one block of the current segment
+         *   - offset (GLintptr) : the value returned by push()
+         */
+        void bind(GLintptr offset) const;
+
+    private:
+        static const uint32_t NB_SEGMENTS = 3;
+
+        GLuint bufferID = 0;
+        GLuint binding;
+        size_t blockSize, stride, segmentSize = 0;
+        uint32_t segment = 0;
+        GLsync fences[NB_SEGMENTS] = {};
+        uint8_t* mapped = nullptr;
+        size_t used = 0;
+};
+
+#endif // UNIFORMBUFFER_H_
@@ -0,0 +1,64 @@
+#ifndef  VERTEXFORMAT_INC
+#define  VERTEXFORMAT_INC
+
+#include <GL/glew.h>
+#include <stdint.h>
+
+#include "Geometry.h"
+
+/* \brief Describe how the vertices of a Mesh are stored in its interleaved vertex buffer.
+ * The packed encodings are read through normalized attributes, so the shaders still receive floats :
+ * only the octahedral normals need to be decoded in the vertex shader (see Shaders/shading.vert)*/
+struct VertexFormat
+{
+    enum class Position : uint8_t
+    {
+        Float,   /*!< 3 floats, 12 bytes*/
+        Half,    /*!< 3 half floats padded to 8 bytes*/
+        Snorm16  /*!< 3 snorm16 padded to 8 bytes. Only for geometries within [-1, 1], the others fall back to Half*/
+    };
+
+    enum class Normal : uint8_t
+    {
+        Float,      /*!< 3 floats, 12 bytes*/
+        Octahedral  /*!< the unit normal folded on an octahedron and stored in 2 snorm16, 4 bytes*/
+    };
+
+    enum class UV : uint8_t
+    {
+        Float,   /*!< 2 floats, 8 bytes*/
+        Unorm16  /*!< 2 unorm16, 4 bytes. Only for UVs within [0, 1], the others fall back to Float*/
+    };
+
+    Position position = Position::Float;
+    Normal   normal   = Normal::Float;
+    UV       uv       = UV::Float;
+
+    /* \brief The smallest format : 16 bytes per vertex instead of 32
+     * \return the format*/
+    static VertexFormat packed() {return {Position::Snorm16, Normal::Octahedral, UV::Unorm16};}
+
+    /* \brief Replace the encodings that cannot represent a geometry by the nearest ones that can
+     * \param g the geometry to store
+     * \return the adjusted format*/
+    VertexFormat fit(const Geometry& g) const;
+
+    /* \brief Get the size of one vertex
+     * \return the size in bytes*/
+    uint32_t getStride() const;
+
+    /* \brief Get where the normal and the UV start inside a vertex
+     * \return the offset in bytes. The position is always at 0*/
+    uint32_t getNormalOffset() const;
+    uint32_t getUVOffset() const;
+
+    /* \brief Encode the vertices of a geometry
+     * \param g the geometry
+     * \param dst where to write, getStride()*g.getNbVertices() bytes*/
+    void pack(const Geometry& g, uint8_t* dst) const;
+
+    /* \brief Point the attributes 0 (position), 1 (UV) and 2 (normal) of the bound VAO to the bound GL_ARRAY_BUFFER*/
+    void setupAttributes() const;
+};
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef WORLD_H_
+#define WORLD_H_
+
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <unordered_map>
+
+#include "Components.h"
+#include "Pool.h"
+
+/**
+ *  The entities of the program and their components, stored by archetype : all the entities with the same set of
+ *  components share an Archetype, where each component type is a dense array indexed by the row of the entity.
+ *  The systems go over these arrays (see each()) instead of following pointers from node to node.
+ *  Destroying an entity, or adding a component to it, moves the last row of its archetype in its place :
+ *  the rows are not stable, the Entity handles are
+ */
+class World {
+
+    public:
+        typedef uint32_t Mask;
+
+        /**
+         *  The entities with one set of components
+         */
+        struct Archetype {
+            Mask mask;
+            std::vector<Entity> entities;
+            std::tuple<std::vector<TransformComponent>, std::vector<MeshComponent>, std::vector<MaterialComponent>,
+                       std::vector<BodyComponent>, std::vector<LightComponent>> columns; // only those of mask are filled
+
+            template <typename T> std::vector<T>& column() { return std::get<std::vector<T>>(columns); }
+            uint32_t size() const { return (uint32_t)entities.size(); }
+        };
+
+        /**
+         *  Returns the mask of a set of component types
+         */
+        template <typename... C>
+        static Mask maskOf()
+        {
+            Mask m = 0;
+            int expand[] = {0, (m |= 1u << ComponentBit<C>::value, 0)...};
+            (void)expand;
+            return m;
+        }
+
+        /**
+         *  Creates an entity with the given components (each type at most once)
+         *   - components (C const&...) : the values of its components
+         */
+        template <typename... C>
+        Entity create(C const&... components)
+        {
+            uint32_t a = findArchetype(maskOf<C...>());
+            Archetype& arch = archetypes[a];
+            Entity e = records.create();
+            *records.get(e) = {a, arch.size()};
+            arch.entities.push_back(e);
+            int expand[] = {0, (arch.column<C>().push_back(components), 0)...};
+            (void)expand;
+            return e;
+        }
+
+        /**
+         *  Destroys an entity, does nothing if it is already destroyed
+         *   - e (Entity) : the entity
+         */
+        void destroy(Entity e);
+
+        /**
+         *  Adds a component to an entity, or replaces it if the entity already has one of this type.
+         *  The entity moves to the archetype with this component. Does nothing if the entity was destroyed
+         *   - e (Entity) : the entity
+         *   - component (T const&) : the component
+         */
+        template <typename T>
+        void add(Entity e, T const& component)
+        {
+            if (T* c = get<T>(e)) { *c = component; return; }
+            Record* r = records.get(e);
+            if (r == nullptr) return;
+            move(*r, archetypes[r->archetype].mask | maskOf<T>());
+            archetypes[r->archetype].column<T>().push_back(component);
+        }
+
+        /**
+         *  Returns a component of an entity, nullptr if the entity was destroyed or has no such component.
+         *  The pointer is valid until an entity of the same archetype is created, destroyed or changes its components
+         *   - e (Entity) : the entity
+         */
+        template <typename T>
+        T* get(Entity e)
+        {
+            Record* r = records.get(e);
+            if (r == nullptr || (archetypes[r->archetype].mask & maskOf<T>()) == 0) return nullptr;
+            return &archetypes[r->archetype].column<T>()[r->row];
+        }
+
+        /**
+         *  Calls f(entity, components...) for every entity having (at least) the given components,
+         *  archetype by archetype. f must not create, destroy or change the components of entities
+         *   - f (F) : called with (Entity, C&...)
+         */
+        template <typename... C, typename F>
+        void each(F f)
+        {
+            Mask m = maskOf<C...>();
+            for (Archetype& a : archetypes)
+            {
+                if ((a.mask & m) != m) continue;
+                for (uint32_t i = 0; i < a.size(); i++)
+                    f(a.entities[i], a.template column<C>()[i]...);
+            }
+        }
+
+        /**
+         *  Calls f(count, arrays...) once per archetype having (at least) the given components, with its dense arrays :
+         *  for the systems processing their components in bulk
+         *   - f (F) : called with (uint32_t, C*...)
+         */
+        template <typename... C, typename F>
+        void eachArray(F f)
+        {
+            Mask m = maskOf<C...>();
+            for (Archetype& a : archetypes)
+                if ((a.mask & m) == m && a.size() > 0) f(a.size(), a.template column<C>().data()...);
+        }
+
+        /**
+         *  Returns the number of live entities
+         */
+        uint32_t size() const { return records.size(); }
+
+        /**
+         *  Returns the number of archetypes created so far
+         */
+        uint32_t getNbArchetypes() const { return (uint32_t)archetypes.size(); }
+
+    private:
+        // where the components of an entity are
+        struct Record {
+            uint32_t archetype;
+            uint32_t row;
+        };
+
+        /**
+         *  Returns the index of the archetype of a mask, created if needed
+         */
+        uint32_t findArchetype(Mask mask);
+
+        /**
+         *  Moves an entity to the archetype of a larger mask, without the components only in the new one
+         */
+        void move(Record& r, Mask mask);
+
+        /**
+         *  Removes a row from an archetype, the last row taking its place
+         */
+        void removeRow(uint32_t archetype, uint32_t row);
+
+        Pool<Record> records;
+        std::vector<Archetype> archetypes;
+        std::unordered_map<Mask, uint32_t> archetypeOf;
+};
+
+#endif // WORLD_H_
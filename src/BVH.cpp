@@ -0,0 +1,131 @@
+#include "BVH.h"
+#include <algorithm>
+
+void BVH::build(std::vector<AABB> const& bounds)
+{
+    nodes.clear();
+    leafOf.assign(bounds.size(), (uint32_t)NO_NODE);
+    std::vector<uint32_t> items(bounds.size());
+    for (uint32_t i = 0; i < items.size(); i++) items[i] = i;
+
+    if (!items.empty()) build(bounds, items.data(), (uint32_t)items.size(), NO_NODE);
+    dirty.assign(nodes.size(), 0);
+    anyDirty = false;
+}
+
+uint32_t BVH::build(std::vector<AABB> const& bounds, uint32_t* items, uint32_t count, uint32_t parent)
+{
+    uint32_t n = (uint32_t)nodes.size();
+    nodes.push_back({AABB(), parent, NO_NODE, NO_NODE});
+
+    if (count == 1)
+    {
+        nodes[n].bounds = bounds[items[0]];
+        nodes[n].right = items[0];
+        leafOf[items[0]] = n;
+        return n;
+    }
+
+    // split at the median of the centers, along the axis where they are the most spread
+    AABB centers;
+    for (uint32_t i = 0; i < count; i++) centers.extend(bounds[items[i]].getCenter());
+    glm::vec3 size = centers.max - centers.min;
+    int axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+
+    uint32_t half = count / 2;
+    std::nth_element(items, items + half, items + count, [&](uint32_t a, uint32_t b) {
+        return bounds[a].getCenter()[axis] < bounds[b].getCenter()[axis];
+    });
+
+    uint32_t left = build(bounds, items, half, n);
+    uint32_t right = build(bounds, items + half, count - half, n);
+    nodes[n].left = left;
+    nodes[n].right = right;
+    nodes[n].bounds = nodes[left].bounds;
+    nodes[n].bounds.extend(nodes[right].bounds);
+    return n;
+}
+
+void BVH::setBounds(uint32_t item, AABB const& box)
+{
+    uint32_t n = leafOf[item];
+    nodes[n].bounds = box;
+
+    // the ancestors, up to one that is already dirty (so are its own ancestors)
+    for (uint32_t p = nodes[n].parent; p != NO_NODE && !dirty[p]; p = nodes[p].parent)
+        dirty[p] = 1;
+    anyDirty = true;
+}
+
+void BVH::refit()
+{
+    if (!anyDirty) return;
+    for (uint32_t i = (uint32_t)nodes.size(); i-- > 0;)
+    {
+        if (!dirty[i]) continue;
+        dirty[i] = 0;
+        nodes[i].bounds = nodes[nodes[i].left].bounds;
+        nodes[i].bounds.extend(nodes[nodes[i].right].bounds);
+    }
+    anyDirty = false;
+}
+
+void BVH::cull(Frustum const& frustum, std::vector<uint32_t>& visible) const
+{
+    visible.clear();
+    if (nodes.empty()) return;
+
+    uint32_t stack[64];
+    uint32_t top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        uint32_t n = stack[--top];
+        Frustum::Result r = frustum.test(nodes[n].bounds);
+        if (r == Frustum::Result::Outside) continue;
+
+        if (nodes[n].left == NO_NODE) visible.push_back(nodes[n].right);
+        else if (r == Frustum::Result::Inside) addAll(n, visible);
+        else
+        {
+            // the tree is balanced : its depth is log2 of the number of items
+            stack[top++] = nodes[n].right;
+            stack[top++] = nodes[n].left;
+        }
+    }
+}
+
+void BVH::addAll(uint32_t node, std::vector<uint32_t>& visible) const
+{
+    if (nodes[node].left == NO_NODE)
+    {
+        visible.push_back(nodes[node].right);
+        return;
+    }
+    addAll(nodes[node].left, visible);
+    addAll(nodes[node].right, visible);
+}
+
+void BVH::raycast(glm::vec3 const& origin, glm::vec3 const& dir, std::vector<uint32_t>& hits) const
+{
+    hits.clear();
+    if (nodes.empty()) return;
+
+    glm::vec3 invDir = 1.f / dir;
+    uint32_t stack[64];
+    uint32_t top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        uint32_t n = stack[--top];
+        float t;
+        if (!nodes[n].bounds.intersects(origin, invDir, t)) continue;
+
+        if (nodes[n].left == NO_NODE) hits.push_back(nodes[n].right);
+        else
+        {
+            stack[top++] = nodes[n].right;
+            stack[top++] = nodes[n].left;
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#include "BallGrid.h"
+#include <cmath>
+#include <algorithm>
+
+BallGrid::BallGrid(float length, float width, float radius)
+{
+    float cellSize = 2.f * radius;
+    invCellSize = 1.f / cellSize;
+    origin = -0.5f * glm::vec2(length, width);
+    nx = std::max(1u, (uint32_t)ceilf(length * invCellSize));
+    nz = std::max(1u, (uint32_t)ceilf(width * invCellSize));
+    head.assign(nx * nz, (uint32_t)NONE);
+}
+
+uint32_t BallGrid::cellOf(glm::vec2 p) const
+{
+    // clamped : a ball pushed slightly off the table stays in the border cells
+    glm::vec2 c = (p - origin) * invCellSize;
+    uint32_t x = (uint32_t)std::min(std::max(c.x, 0.f), (float)(nx - 1));
+    uint32_t z = (uint32_t)std::min(std::max(c.y, 0.f), (float)(nz - 1));
+    return z * nx + x;
+}
+
+void BallGrid::link(uint32_t i, uint32_t c)
+{
+    cell[i] = c;
+    prev[i] = NONE;
+    next[i] = head[c];
+    if (head[c] != NONE) prev[head[c]] = i;
+    head[c] = i;
+}
+
+void BallGrid::unlink(uint32_t i)
+{
+    if (prev[i] != NONE) next[prev[i]] = next[i];
+    else head[cell[i]] = next[i];
+    if (next[i] != NONE) prev[next[i]] = prev[i];
+}
+
+void BallGrid::add(glm::vec2 p)
+{
+    uint32_t i = size();
+    cell.push_back((uint32_t)NONE);
+    next.push_back((uint32_t)NONE);
+    prev.push_back((uint32_t)NONE);
+    link(i, cellOf(p));
+}
+
+bool BallGrid::move(uint32_t i, glm::vec2 p)
+{
+    uint32_t c = cellOf(p);
+    if (c == cell[i]) return false;
+    unlink(i);
+    link(i, c);
+    return true;
+}
+
+void BallGrid::remove(uint32_t i)
+{
+    if (cell[i] == NONE) return;
+    unlink(i);
+    cell[i] = NONE;
+}
+
+bool BallGrid::findPairs(std::vector<uint32_t> const& balls, const uint8_t* queried, std::vector<Pair>& pairs,
+                         uint32_t maxPairs) const
+{
+    for (uint32_t i : balls)
+    {
+        uint32_t x = cell[i] % nx, z = cell[i] / nx;
+        uint32_t x0 = x > 0 ? x - 1 : 0, x1 = std::min(x + 1, nx - 1);
+        uint32_t z0 = z > 0 ? z - 1 : 0, z1 = std::min(z + 1, nz - 1);
+        for (uint32_t cz = z0; cz <= z1; cz++)
+            for (uint32_t cx = x0; cx <= x1; cx++)
+                for (uint32_t j = head[cz * nx + cx]; j != NONE; j = next[j])
+                {
+                    if (j == i || (queried[j] && j < i)) continue;
+                    if (pairs.size() == maxPairs) return false;
+                    pairs.push_back({i, j});
+                }
+    }
+    return true;
+}
+
+void BallGrid::findNear(uint32_t i, uint32_t cells, std::vector<uint32_t>& balls) const
+{
+    if (cell[i] == NONE) return;
+    uint32_t x = cell[i] % nx, z = cell[i] / nx;
+    uint32_t x0 = x > cells ? x - cells : 0, x1 = std::min(x + cells, nx - 1);
+    uint32_t z0 = z > cells ? z - cells : 0, z1 = std::min(z + cells, nz - 1);
+    for (uint32_t cz = z0; cz <= z1; cz++)
+        for (uint32_t cx = x0; cx <= x1; cx++)
+            for (uint32_t j = head[cz * nx + cx]; j != NONE; j = next[j])
+                if (j != i) balls.push_back(j);
+}
@@ -0,0 +1,488 @@
+#include "BallPhysics.h"
+#include "NarrowPhase.h"
+#include "logger.h"
+#include <cmath>
+#include <algorithm>
+
+// the candidates of a ball reserved for : without overlaps, 16 centers fit in its 3x3 cells (itself included).
+// Balls pushed into each other can exceed it, the pairs are then clamped to what was reserved (see collideBalls())
+static constexpr uint32_t MAX_CANDIDATES = 15;
+
+namespace {
+
+// the proportions of a pool table for the rails left to 0
+BallPhysics::Params withRails(BallPhysics::Params p)
+{
+    float d = 2.f * p.radius;
+    if (p.noseHeight <= 0.f) p.noseHeight = 0.635f * d;
+    if (p.cornerMouth <= 0.f) p.cornerMouth = 2.05f * d;
+    if (p.sideMouth <= 0.f) p.sideMouth = 2.2f * d;
+    if (p.railWidth <= 0.f) p.railWidth = 1.5f * d;
+    return p;
+}
+
+}
+
+BallPhysics::BallPhysics(Params const& p, Mode mode)
+    : params(withRails(p)), mode(mode),
+      table(params.length, params.width, params.radius, params.railWidth, params.cornerMouth, params.sideMouth),
+      grid(params.length, params.width, params.radius)
+{
+}
+
+uint32_t BallPhysics::addBall(glm::vec2 position, glm::quat const& orientation)
+{
+    uint32_t i = size();
+    px.push_back(position.x); pz.push_back(position.y);
+    vx.push_back(0.f); vz.push_back(0.f);
+    wx.push_back(0.f); wy.push_back(0.f); wz.push_back(0.f);
+    qw.push_back(orientation.w); qx.push_back(orientation.x); qy.push_back(orientation.y); qz.push_back(orientation.z);
+    ax.push_back(0.f); ay.push_back(0.f); az.push_back(0.f);
+    state.push_back(State::Stationary);
+    entities.push_back(Entity());
+    moved.push_back(0);
+    movedThisStep.push_back(0);
+    isAwake.push_back(0);
+    versions.push_back(0);
+    windowEnd.push_back(INFINITY);
+    grid.add(position);
+
+    // reserved ahead, doubling : the steps do not allocate
+    uint32_t n = i + 1;
+    if (rolling.capacity() < n)
+    {
+        rolling.reserve(2 * n);
+        awake.reserve(2 * n);
+        near.reserve(2 * n);
+        pairs.reserve(2 * n * MAX_CANDIDATES);
+        candidateX.resize(2 * n * MAX_CANDIDATES);
+        candidateZ.resize(2 * n * MAX_CANDIDATES);
+        contactMask.resize((2 * n * MAX_CANDIDATES + 31) / 32);
+    }
+    eventsValid = false;
+    return i;
+}
+
+uint32_t BallPhysics::addBall(World& world, Entity e)
+{
+    TransformComponent* t = world.get<TransformComponent>(e);
+    uint32_t i = t != nullptr ? addBall(glm::vec2(t->position.x, t->position.z), t->rotation) : addBall(glm::vec2(0.f));
+    entities[i] = e;
+    return i;
+}
+
+void BallPhysics::hit(uint32_t i, glm::vec2 velocity, glm::vec3 angularVelocity)
+{
+    if (state[i] == State::Pocketed) return;
+    if (state[i] == State::Stationary) nbMoving++;
+    vx[i] = velocity.x; vz[i] = velocity.y;
+    wx[i] = angularVelocity.x; wy[i] = angularVelocity.y; wz[i] = angularVelocity.z;
+    state[i] = State::Sliding;
+    wake(i);
+    eventsValid = false;
+}
+
+void BallPhysics::wake(uint32_t i)
+{
+    if (isAwake[i]) return;
+    isAwake[i] = 1;
+    awake.push_back(i);
+}
+
+uint32_t BallPhysics::advance(float seconds)
+{
+    uint32_t n = 0;
+    if (mode == Mode::EventDriven)
+    {
+        // a queue is always non empty while a ball moves : its next transition is in it
+        double target = now + seconds;
+        if (!eventsValid) scheduleAll();
+        while (dropStale() && events.front().time <= target)
+        {
+            if (n == MAX_EVENTS)
+            {
+                // the fixed steps still collide the balls, they only stop finding the exact times
+                WARNING("more than %u events in %g s, the balls are stuck : fixed steps for the rest of the frame\n", (uint32_t)MAX_EVENTS, seconds);
+                stepFor((float)(target - now));
+                now = target;
+                eventsValid = false;
+                return n;
+            }
+            nextEvent();
+            n++;
+        }
+        moveAllTo(target);
+        return n;
+    }
+
+    accumulator += seconds;
+    while (accumulator >= params.timestep)
+    {
+        accumulator -= params.timestep;
+        if (isMoving()) step();
+        n++;
+    }
+    return n;
+}
+
+uint32_t BallPhysics::step()
+{
+    return stepFor(params.timestep);
+}
+
+uint32_t BallPhysics::stepFor(float seconds)
+{
+    // substeps short enough for the fastest ball to move maxTravel radius at most : the balls can not pass
+    // through each other, and the slow balls (most of a break) take the whole step at once
+    const float travel = params.maxTravel * params.radius;
+    float left = seconds;
+    uint32_t n = 0;
+    for (; left > 0.f && isMoving(); n++)
+    {
+        float v2 = 0.f;
+        for (uint32_t i : awake) v2 = std::max(v2, vx[i] * vx[i] + vz[i] * vz[i]);
+        float h = v2 * left * left > travel * travel ? travel / sqrtf(v2) : left;
+        integrate(h);
+        collideTable(h);
+        collideBalls(h);
+        left -= h;
+    }
+    return n;
+}
+
+glm::vec2 BallPhysics::getAcceleration(uint32_t i, float& tau) const
+{
+    const float g = 9.81f * params.unitsPerMeter;
+    if (state[i] == State::Sliding)
+    {
+        // the velocity of the contact point keeps its direction, and decreases by 7/2 of the sliding friction
+        // (the linear and the angular parts)
+        float ux = vx[i] + params.radius * wz[i], uz = vz[i] - params.radius * wx[i];
+        float u = sqrtf(ux * ux + uz * uz);
+        tau = u / (3.5f * params.slidingFriction * g);
+        return u > 0.f ? -params.slidingFriction * g / u * glm::vec2(ux, uz) : glm::vec2(0.f);
+    }
+    if (state[i] == State::Rolling)
+    {
+        float v = sqrtf(vx[i] * vx[i] + vz[i] * vz[i]);
+        tau = v / (params.rollingFriction * g);
+        return v > 0.f ? -params.rollingFriction * g / v * glm::vec2(vx[i], vz[i]) : glm::vec2(0.f);
+    }
+    tau = INFINITY;
+    return glm::vec2(0.f);
+}
+
+void BallPhysics::startRolling(uint32_t i)
+{
+    // no slip at the contact point
+    wx[i] = vz[i] / params.radius;
+    wz[i] = -vx[i] / params.radius;
+    state[i] = State::Rolling;
+}
+
+void BallPhysics::stop(uint32_t i)
+{
+    vx[i] = vz[i] = 0.f;
+    wx[i] = wz[i] = 0.f;
+    state[i] = wy[i] != 0.f ? State::Spinning : State::Stationary;
+}
+
+void BallPhysics::rest(uint32_t i)
+{
+    if (state[i] != State::Sliding && state[i] != State::Rolling) return;
+    float ux = vx[i] + params.radius * wz[i], uz = vz[i] - params.radius * wx[i];
+    float v = getRestingSpeed();
+    if (vx[i] * vx[i] + vz[i] * vz[i] >= v * v || ux * ux + uz * uz >= v * v) return;
+    stop(i);
+    if (state[i] == State::Stationary) nbMoving--;
+}
+
+void BallPhysics::move(uint32_t i, float dt)
+{
+    if (state[i] == State::Stationary || state[i] == State::Pocketed) return;
+    const float g = 9.81f * params.unitsPerMeter;
+    const float r = params.radius;
+
+    // at most two pieces : up to the end of the sliding, then up to the stop
+    float left = dt;
+    while (left > 0.f && (state[i] == State::Sliding || state[i] == State::Rolling))
+    {
+        float tau;
+        glm::vec2 a = getAcceleration(i, tau);
+        float h = std::min(left, tau);
+        float wx0 = wx[i], wz0 = wz[i];
+
+        px[i] += (vx[i] + 0.5f * a.x * h) * h;
+        pz[i] += (vz[i] + 0.5f * a.y * h) * h;
+        vx[i] += a.x * h;
+        vz[i] += a.y * h;
+        if (state[i] == State::Sliding)
+        {
+            // the torque of the friction at the contact point
+            wx[i] -= 2.5f * a.y / r * h;
+            wz[i] += 2.5f * a.x / r * h;
+        }
+        else startRolling(i);
+
+        // the angular velocity changes linearly : its mean over the piece
+        ax[i] += 0.5f * (wx0 + wx[i]) * h;
+        az[i] += 0.5f * (wz0 + wz[i]) * h;
+        left -= h;
+
+        if (h < tau) break;
+        if (state[i] == State::Sliding) startRolling(i);
+        else stop(i);
+    }
+    grid.move(i, glm::vec2(px[i], pz[i]));
+
+    const float spin = 2.5f * params.spinningFriction * g / r;
+    float spinLeft = fabsf(wy[i]) / spin;
+    float h = std::min(dt, spinLeft);
+    float wy0 = wy[i];
+    wy[i] = h < spinLeft ? wy[i] - copysignf(spin * h, wy[i]) : 0.f;
+    ay[i] += 0.5f * (wy0 + wy[i]) * h;
+    if (state[i] == State::Spinning && wy[i] == 0.f) state[i] = State::Stationary;
+
+    moved[i] = 1;
+}
+
+void BallPhysics::integrate(float dt)
+{
+    // the stationary balls are not visited : they leave the awake balls here, and join them when they are hit
+    uint32_t kept = 0;
+    rolling.clear();
+    for (uint32_t i : awake)
+    {
+        move(i, dt);
+        if (state[i] == State::Stationary || state[i] == State::Pocketed)
+        {
+            isAwake[i] = 0;
+            continue;
+        }
+        awake[kept++] = i;
+        if (state[i] == State::Sliding || state[i] == State::Rolling) rolling.push_back(i);
+    }
+    awake.resize(kept);
+    nbMoving = kept;
+}
+
+void BallPhysics::bounceRail(uint32_t i, glm::vec2 normal)
+{
+    // the frame of the rail : X into it, Y along it, and up
+    glm::vec2 X = -normal, Y(X.y, -X.x);
+    float vX = vx[i] * X.x + vz[i] * X.y, vY = vx[i] * Y.x + vz[i] * Y.y;
+    if (vX <= 0.f) return; // already going back
+    float wX = wx[i] * X.x + wz[i] * X.y, wY = wx[i] * Y.x + wz[i] * Y.y, wZ = wy[i];
+
+    // the nose touches the ball above its center, at the angle theta. The impulse at the nose is split between
+    // the compression (restitution) and the slip of the contact point : sliding all along, or stopping before
+    // the end of the impact (Han, 2005), with the ball of mass 1 kept on the cloth
+    const float r = params.radius;
+    float sinT = std::min(std::max(params.noseHeight / r - 1.f, 0.f), 1.f), cosT = sqrtf(1.f - sinT * sinT);
+    float sx = vX * sinT + r * wY;
+    float sy = -vY - r * wZ * cosT + r * wX * sinT;
+    float p = (1.f + params.cushionRestitution) * vX * cosT;
+    float slip = sqrtf(sx * sx + sy * sy);
+
+    float pX, pY, pZ;
+    if (slip / 3.5f <= p * params.cushionFriction)
+    {
+        pX = -sx / 3.5f * sinT - p * cosT;
+        pY = sy / 3.5f;
+        pZ = sx / 3.5f * cosT - p * sinT;
+    }
+    else
+    {
+        float mu = params.cushionFriction * p / slip;
+        pX = -mu * sx * sinT - p * cosT;
+        pY = mu * sy;
+        pZ = mu * sx * cosT - p * sinT;
+    }
+    vX += pX;
+    vY += pY;
+    wX -= 2.5f / r * pY * sinT;
+    wY += 2.5f / r * (pX * sinT - pZ * cosT);
+    wZ += 2.5f / r * pY * cosT;
+
+    vx[i] = vX * X.x + vY * Y.x; vz[i] = vX * X.y + vY * Y.y;
+    wx[i] = wX * X.x + wY * Y.x; wz[i] = wX * X.y + wY * Y.y; wy[i] = wZ;
+    state[i] = State::Sliding;
+    moved[i] = 1;
+}
+
+void BallPhysics::pocketBall(uint32_t i, uint32_t pocket)
+{
+    if (state[i] != State::Stationary) nbMoving--;
+    glm::vec2 c = table.getPocket(pocket);
+    px[i] = c.x; pz[i] = c.y;
+    vx[i] = vz[i] = 0.f;
+    wx[i] = wy[i] = wz[i] = 0.f;
+    state[i] = State::Pocketed;
+    grid.remove(i);
+    moved[i] = 1;
+}
+
+void BallPhysics::bounceBalls(uint32_t i, uint32_t j)
+{
+    float dx = px[j] - px[i], dz = pz[j] - pz[i];
+    float l = sqrtf(dx * dx + dz * dz);
+    if (l == 0.f) return;
+    float approach = ((vx[i] - vx[j]) * dx + (vz[i] - vz[j]) * dz) / l;
+    if (approach <= 0.f) return;
+    float nx = dx / l, nz = dz / l;
+
+    // equal masses : only the velocity along the line of centers changes, the spin stays.
+    // Slower than the resting speed (a ball pushing another), they only stop approaching : a rebound would
+    // bring them back together at once, again and again
+    float restitution = approach < getRestingSpeed() ? 0.f : params.ballRestitution;
+    float dv = 0.5f * (1.f + restitution) * approach;
+    vx[i] -= dv * nx; vz[i] -= dv * nz;
+    vx[j] += dv * nx; vz[j] += dv * nz;
+    if (state[i] == State::Stationary) nbMoving++;
+    if (state[j] == State::Stationary) nbMoving++;
+    state[i] = state[j] = State::Sliding;
+    wake(i);
+    wake(j);
+    moved[i] = moved[j] = 1;
+    rest(i);
+    rest(j);
+}
+
+void BallPhysics::collideTable(float dt)
+{
+    const float r = params.radius;
+    uint32_t kept = 0;
+    for (uint32_t i : rolling)
+    {
+        glm::vec2 p(px[i], pz[i]);
+        if (table.isClear(p))
+        {
+            rolling[kept++] = i;
+            continue;
+        }
+        uint32_t pocket = table.pocket(p);
+        if (pocket != TableCollision::NONE)
+        {
+            pocketBall(i, pocket);
+            continue;
+        }
+        rolling[kept++] = i; // the pocketed balls leave the step
+
+        glm::vec2 normal;
+        float d = table.closest(p, normal);
+        if (d >= r || d == 0.f) continue;
+
+        // back to where it touched, along its velocity : it bounces from there, and moves on with its new velocity
+        // for the time it spent in the rail. The rebound does not depend on how deep the step went.
+        // The normal is taken again where it touched : deep in, the closest point can be on another part of the rail
+        // (the end of a jaw instead of the cushion), and the bounce would take the wrong one
+        glm::vec2 v(vx[i], vz[i]);
+        float back = 0.f;
+        for (int it = 0; it < 2; it++)
+        {
+            float in = -glm::dot(v, normal);
+            if (in <= 0.f) break;
+            float delta = std::min(std::max((r - d) / in, -back), dt - back);
+            back += delta;
+            p -= delta * v;
+            d = table.closest(p, normal);
+        }
+        bounceRail(i, normal);
+        p += back * glm::vec2(vx[i], vz[i]);
+
+        // still in it (grazing, or near a corner) : pushed back against it
+        d = table.closest(p, normal);
+        if (d < r && d > 0.f) p += (r - d) * normal;
+        px[i] = p.x; pz[i] = p.y;
+        grid.move(i, p);
+    }
+    rolling.resize(kept);
+}
+
+void BallPhysics::collideBalls(float dt)
+{
+    const float d2 = 4.f * params.radius * params.radius;
+
+    // two balls that do not move can not start touching : only the candidates of the balls moving at the start
+    // of the step, once (the pairs of two moving balls from the first one)
+    for (uint32_t i : rolling) movedThisStep[i] = 1;
+    pairs.clear();
+    if (!grid.findPairs(rolling, movedThisStep.data(), pairs, (uint32_t)pairs.capacity()))
+        WARNING("more than %u candidate pairs, the balls overlap : the last ones are not tested this step\n", (uint32_t)pairs.capacity());
+    for (uint32_t i : rolling) movedThisStep[i] = 0;
+
+    // every candidate of the step is tested at once, by the offset of its center from the ball it was found by
+    for (uint32_t k = 0; k < pairs.size(); k++)
+    {
+        candidateX[k] = px[pairs[k].j] - px[pairs[k].i];
+        candidateZ[k] = pz[pairs[k].j] - pz[pairs[k].i];
+    }
+    if (NarrowPhase::contacts(glm::vec2(0.f), candidateX.data(), candidateZ.data(), (uint32_t)pairs.size(),
+                              2.f * params.radius, contactMask.data()) == 0) return;
+
+    // solved one by one : a contact made by an earlier bounce is found by the next step
+    for (uint32_t k = 0; k < pairs.size(); k++)
+    {
+        if (!(contactMask[k >> 5] & (1u << (k & 31)))) continue;
+        uint32_t i = pairs[k].i, j = pairs[k].j;
+
+        // a previous contact may have pushed them apart
+        float dx = px[j] - px[i], dz = pz[j] - pz[i];
+        float l2 = dx * dx + dz * dz;
+        if (l2 >= d2 || l2 == 0.f) continue;
+
+        // back to where they touched, as for the rails : they bounce along the line of centers they had then
+        float l = sqrtf(l2);
+        float approach = ((vx[i] - vx[j]) * dx + (vz[i] - vz[j]) * dz) / l;
+        float back = approach > 0.f ? std::min((2.f * params.radius - l) / approach, dt) : 0.f;
+        px[i] -= back * vx[i]; pz[i] -= back * vz[i];
+        px[j] -= back * vx[j]; pz[j] -= back * vz[j];
+        bounceBalls(i, j);
+        px[i] += back * vx[i]; pz[i] += back * vz[i];
+        px[j] += back * vx[j]; pz[j] += back * vz[j];
+
+        // still touching (grazing) : pushed apart, half each
+        dx = px[j] - px[i], dz = pz[j] - pz[i];
+        l2 = dx * dx + dz * dz;
+        if (l2 < d2 && l2 > 0.f)
+        {
+            l = sqrtf(l2);
+            float push = 0.5f * (2.f * params.radius - l) / l;
+            px[i] -= push * dx; pz[i] -= push * dz;
+            px[j] += push * dx; pz[j] += push * dz;
+        }
+        grid.move(i, glm::vec2(px[i], pz[i]));
+        grid.move(j, glm::vec2(px[j], pz[j]));
+        moved[i] = moved[j] = 1;
+    }
+}
+
+void BallPhysics::write(World& world)
+{
+    for (uint32_t i = 0; i < size(); i++)
+    {
+        if (!moved[i]) continue;
+        moved[i] = 0;
+
+        // the rotations accumulated since the last write, as one rotation (exact if the axis did not change)
+        glm::vec3 a = glm::vec3(ax[i], ay[i], az[i]);
+        float angle = glm::length(a);
+        if (angle > 0.f)
+        {
+            glm::quat q = glm::normalize(glm::angleAxis(angle, a / angle) * getOrientation(i));
+            qw[i] = q.w; qx[i] = q.x; qy[i] = q.y; qz[i] = q.z;
+            ax[i] = ay[i] = az[i] = 0.f;
+        }
+
+        TransformComponent* t = world.get<TransformComponent>(entities[i]);
+        BodyComponent* b = world.get<BodyComponent>(entities[i]);
+        if (t == nullptr || b == nullptr) continue;
+
+        t->position.x = px[i];
+        t->position.z = pz[i];
+        t->rotation = getOrientation(i);
+        t->moved = true;
+        b->velocity = glm::vec3(vx[i], 0.f, vz[i]);
+        b->angularVelocity = getAngularVelocity(i);
+    }
+}
@@ -0,0 +1,358 @@
+#include "BallPhysics.h"
+#include "logger.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+// the queue is a heap with the earliest event on top
+struct Later {
+    template <typename E>
+    bool operator()(E const& a, E const& b) const { return a.time > b.time; }
+};
+
+constexpr uint32_t NO_BALL = ~0u;
+
+// how far from its cell the contacts of a ball are looked for : the balls of the cells around are within 2 * NEAR_CELLS
+// radius, two balls moving a radius each before their next Window can only meet if they are within 4 radius
+constexpr uint32_t NEAR_CELLS = 2;
+
+// the polynomial p[0] + p[1] t + ... + p[n] t^n
+double evaluate(const double* p, int n, double t)
+{
+    double r = p[n];
+    for (int k = n - 1; k >= 0; k--) r = r * t + p[k];
+    return r;
+}
+
+// the times in [a, b] where p changes sign, increasing : between two roots of the derivative p is monotonic,
+// so each interval holds at most one, found by bisection. n is at most 4
+int signChanges(const double* p, int n, double a, double b, double* roots)
+{
+    while (n > 0 && p[n] == 0.0) n--;
+    if (n == 0) return 0;
+    if (n == 1)
+    {
+        double t = -p[0] / p[1];
+        if (t < a || t > b) return 0;
+        roots[0] = t;
+        return 1;
+    }
+
+    double d[4];
+    for (int k = 1; k <= n; k++) d[k - 1] = k * p[k];
+    double bounds[6];
+    bounds[0] = a;
+    int m = signChanges(d, n - 1, a, b, bounds + 1);
+    bounds[m + 1] = b;
+
+    int count = 0;
+    for (int s = 0; s <= m; s++)
+    {
+        double lo = bounds[s], hi = bounds[s + 1];
+        bool positive = evaluate(p, n, lo) > 0.0;
+        if ((evaluate(p, n, hi) > 0.0) == positive) continue;
+        for (int it = 0; it < 64 && hi - lo > 1e-12 * (1.0 + hi); it++)
+        {
+            double mid = 0.5 * (lo + hi);
+            if ((evaluate(p, n, mid) > 0.0) == positive) lo = mid;
+            else hi = mid;
+        }
+        roots[count++] = hi; // on the far side : the contact is never reported before it happens
+    }
+    return count;
+}
+
+// the first time in (0, horizon] where p, positive at 0, is no longer positive. Infinity if there is none
+double firstContact(const double* p, int n, double horizon)
+{
+    double roots[4];
+    return signChanges(p, n, 0.0, horizon, roots) > 0 ? roots[0] : INFINITY;
+}
+
+}
+
+double BallPhysics::nextEvent()
+{
+    if (!eventsValid) scheduleAll();
+    if (!dropStale()) return -1.0;
+
+    std::pop_heap(events.begin(), events.end(), Later());
+    Event e = events.back();
+    events.pop_back();
+    moveAllTo(e.time);
+
+    // nothing changed : the events of the ball stay, only the balls now around it are looked at
+    if (e.type == EventType::Window)
+    {
+        if (events.size() + getMaxEventsPerBall() > events.capacity()) scheduleAll();
+        else
+        {
+            scheduleWindow(e.i);
+            scheduleNear(e.i, NO_BALL);
+        }
+        return now;
+    }
+
+    bool pair = e.type == EventType::Ball;
+    if (e.type == EventType::Transition)
+    {
+        // reached up to rounding errors : move() may have stopped just short of it
+        uint32_t i = e.i;
+        bool wasMoving = state[i] != State::Stationary;
+        float tau;
+        getAcceleration(i, tau);
+        if (tau < 1e-6f)
+        {
+            if (state[i] == State::Sliding) startRolling(i);
+            else if (state[i] == State::Rolling) stop(i);
+        }
+        const float spin = 2.5f * params.spinningFriction * 9.81f * params.unitsPerMeter / params.radius;
+        if (wy[i] != 0.f && fabsf(wy[i]) < 1e-6f * spin)
+        {
+            wy[i] = 0.f;
+            if (state[i] == State::Spinning) state[i] = State::Stationary;
+        }
+        if (wasMoving && state[i] == State::Stationary) nbMoving--;
+        rest(i); // a ball rolling too slowly would stop an instant later
+    }
+    else if (e.type == EventType::Cushion) bounceRail(e.i, table.getSegment(e.j).normal);
+    else if (e.type == EventType::Corner)
+    {
+        glm::vec2 d = glm::vec2(px[e.i], pz[e.i]) - table.getCorner(e.j);
+        float l = glm::length(d);
+        if (l > 0.f) bounceRail(e.i, d / l);
+    }
+    else if (e.type == EventType::Pocket) pocketBall(e.i, e.j);
+    else bounceBalls(e.i, e.j);
+
+    versions[e.i]++;
+    if (pair) versions[e.j]++;
+
+    // rebuilt without the stale ones when the queue could not take the events of two balls.
+    // The pair itself is tested again (with i) : they may meet again later, ballTime() ignores them while they separate
+    if (events.size() + 2 * getMaxEventsPerBall() > events.capacity()) scheduleAll();
+    else
+    {
+        schedule(e.i, NO_BALL);
+        if (pair) schedule(e.j, e.i);
+    }
+    return now;
+}
+
+bool BallPhysics::dropStale()
+{
+    while (!events.empty())
+    {
+        Event const& e = events.front();
+        bool stale = versions[e.i] != e.versionI || (e.type == EventType::Ball && versions[e.j] != e.versionJ);
+        if (!stale) return true;
+        std::pop_heap(events.begin(), events.end(), Later());
+        events.pop_back();
+    }
+    return false;
+}
+
+void BallPhysics::moveAllTo(double t)
+{
+    float dt = (float)(t - now);
+    now = t;
+    if (dt <= 0.f) return;
+    for (uint32_t i = 0; i < size(); i++)
+    {
+        if (state[i] == State::Stationary || state[i] == State::Pocketed) continue;
+        move(i, dt);
+        if (state[i] == State::Stationary) nbMoving--;
+    }
+}
+
+void BallPhysics::scheduleAll()
+{
+    // the windows of every ball first : they bound the pairs
+    events.clear();
+    for (uint32_t i = 0; i < size(); i++) scheduleBall(i);
+    for (uint32_t i = 0; i < size(); i++)
+    {
+        near.clear();
+        grid.findNear(i, NEAR_CELLS, near);
+        for (uint32_t j : near)
+            if (j > i) schedulePair(i, j);
+    }
+    eventsValid = true;
+
+    // as much room again, and for the events of two balls : the queue only grows here
+    events.reserve(2 * events.size() + 2 * getMaxEventsPerBall());
+}
+
+void BallPhysics::schedule(uint32_t i, uint32_t skip)
+{
+    scheduleBall(i);
+    scheduleNear(i, skip);
+}
+
+void BallPhysics::scheduleNear(uint32_t i, uint32_t skip)
+{
+    near.clear();
+    grid.findNear(i, NEAR_CELLS, near);
+    for (uint32_t j : near)
+        if (j != skip) schedulePair(i, j);
+}
+
+void BallPhysics::scheduleBall(uint32_t i)
+{
+    float tau;
+    getAcceleration(i, tau);
+    const float spin = 2.5f * params.spinningFriction * 9.81f * params.unitsPerMeter / params.radius;
+    float spinEnd = wy[i] != 0.f ? fabsf(wy[i]) / spin : INFINITY;
+    push(std::min(tau, spinEnd), EventType::Transition, i, 0);
+    scheduleWindow(i);
+
+    if (std::isinf(tau)) return; // it does not move on the table
+    for (uint32_t k = 0; k < table.getNbSegments(); k++)
+        push(segmentTime(i, k, tau), EventType::Cushion, i, k);
+    for (uint32_t k = 0; k < table.getNbCorners(); k++)
+        push(circleTime(i, table.getCorner(k), params.radius, true, tau), EventType::Corner, i, k);
+    for (uint32_t k = 0; k < table.getNbPockets(); k++)
+        push(circleTime(i, table.getPocket(k), table.getPocketRadius(k), false, tau), EventType::Pocket, i, k);
+}
+
+void BallPhysics::scheduleWindow(uint32_t i)
+{
+    // its path is at most (v + a t) t long : the time it takes to move a radius at least
+    float tau;
+    glm::vec2 a = getAcceleration(i, tau);
+    double v = glm::length(glm::vec2(vx[i], vz[i])), al = glm::length(a), l = (NEAR_CELLS - 1) * params.radius;
+    double speed = v + sqrt(v * v + 4.0 * al * l);
+    windowEnd[i] = std::isinf(tau) || speed <= 0.0 ? INFINITY : now + 2.0 * l / speed;
+    if (windowEnd[i] < now + tau) push(windowEnd[i] - now, EventType::Window, i, 0);
+}
+
+uint32_t BallPhysics::getMaxEventsPerBall() const
+{
+    return size() + 1 + table.getNbSegments() + table.getNbCorners() + table.getNbPockets();
+}
+
+void BallPhysics::schedulePair(uint32_t i, uint32_t j)
+{
+    if (state[i] == State::Pocketed || state[j] == State::Pocketed) return;
+    float ti, tj;
+    getAcceleration(i, ti);
+    getAcceleration(j, tj);
+    double horizon = std::min((double)std::min(ti, tj), std::min(windowEnd[i], windowEnd[j]) - now);
+    if (std::isinf(horizon)) return; // two balls that do not move can not start touching
+    push(ballTime(i, j, horizon), EventType::Ball, i, j);
+}
+
+double BallPhysics::segmentTime(uint32_t i, uint32_t k, double horizon) const
+{
+    TableCollision::Segment seg = table.getSegment(k);
+    float tau;
+    glm::vec2 a = getAcceleration(i, tau);
+    double ox = (double)px[i] - seg.a.x, oz = (double)pz[i] - seg.a.y;
+    double r = params.radius;
+
+    // the distance of the ball to the line of the segment, on its front side
+    double c[3] = {
+        ox * seg.normal.x + oz * seg.normal.y - r,
+        (double)vx[i] * seg.normal.x + (double)vz[i] * seg.normal.y,
+        0.5 * ((double)a.x * seg.normal.x + (double)a.y * seg.normal.y)
+    };
+    if (c[0] < -r) return INFINITY; // behind it
+    const double touching = 1e-6 * r;
+    if (c[0] <= touching)
+    {
+        // going in clearly enough for bounceRail() to take it, on the segment
+        double along = ox * seg.dir.x + oz * seg.dir.y;
+        float in = vx[i] * seg.normal.x + vz[i] * seg.normal.y;
+        if (in < -1e-6f * glm::length(glm::vec2(vx[i], vz[i])) && along >= 0.0 && along <= seg.length) return 0.0;
+        c[0] = touching;
+    }
+
+    // touching the line beyond an end : the ball passes by, or hits the end (a corner)
+    double t = firstContact(c, 2, horizon);
+    if (std::isinf(t)) return t;
+    double along = (ox + ((double)vx[i] + 0.5 * a.x * t) * t) * seg.dir.x + (oz + ((double)vz[i] + 0.5 * a.y * t) * t) * seg.dir.y;
+    return along >= 0.0 && along <= seg.length ? t : INFINITY;
+}
+
+double BallPhysics::circleTime(uint32_t i, glm::vec2 center, float distance, bool solid, double horizon) const
+{
+    float tau;
+    glm::vec2 a = getAcceleration(i, tau);
+
+    // as ballTime(), the other ball being still
+    double cx = (double)px[i] - center.x, cz = (double)pz[i] - center.y;
+    double bx = vx[i], bz = vz[i];
+    double axx = 0.5 * a.x, azz = 0.5 * a.y;
+    double d = distance;
+
+    double reach = (sqrt(bx * bx + bz * bz) + sqrt(axx * axx + azz * azz) * horizon) * horizon;
+    if (sqrt(cx * cx + cz * cz) - d > reach) return INFINITY;
+
+    double c[5] = {
+        cx * cx + cz * cz - d * d,
+        2.0 * (bx * cx + bz * cz),
+        bx * bx + bz * bz + 2.0 * (axx * cx + azz * cz),
+        2.0 * (axx * bx + azz * bz),
+        axx * axx + azz * azz
+    };
+    const double touching = 1e-5 * d * d;
+    if (c[0] <= touching)
+    {
+        if (!solid) return 0.0; // already in
+        float dx = px[i] - center.x, dz = pz[i] - center.y;
+        float in = vx[i] * dx + vz[i] * dz;
+        if (in < -1e-6f * glm::length(glm::vec2(vx[i], vz[i])) * glm::length(glm::vec2(dx, dz))) return 0.0;
+        c[0] = touching;
+    }
+    return firstContact(c, 4, horizon);
+}
+
+double BallPhysics::ballTime(uint32_t i, uint32_t j, double horizon) const
+{
+    float tau;
+    glm::vec2 ai = getAcceleration(i, tau), aj = getAcceleration(j, tau);
+
+    // the offset from i to j is C + B t + A t^2, they touch when its length is 2r
+    double cx = (double)px[j] - px[i], cz = (double)pz[j] - pz[i];
+    double bx = (double)vx[j] - vx[i], bz = (double)vz[j] - vz[i];
+    double axx = 0.5 * ((double)aj.x - ai.x), azz = 0.5 * ((double)aj.y - ai.y);
+    double d = 2.0 * params.radius;
+
+    // too far to meet before the horizon, whatever the directions : most pairs stop here
+    double reach = (sqrt(bx * bx + bz * bz) + sqrt(axx * axx + azz * azz) * horizon) * horizon;
+    if (sqrt(cx * cx + cz * cz) - d > reach) return INFINITY;
+
+    double c[5] = {
+        cx * cx + cz * cz - d * d,
+        2.0 * (bx * cx + bz * cz),
+        bx * bx + bz * bz + 2.0 * (axx * cx + azz * cz),
+        2.0 * (axx * bx + azz * bz),
+        axx * axx + azz * azz
+    };
+    // touching : a contact now if they approach faster than the resting speed. Slower, it is once they close the
+    // tolerance, bounceBalls() then stops them approaching : a contact now would not move them and come back at once
+    const double touching = 1e-5 * d * d;
+    if (c[0] <= touching)
+    {
+        float dx = px[j] - px[i], dz = pz[j] - pz[i];
+        float approach = (vx[i] - vx[j]) * dx + (vz[i] - vz[j]) * dz;
+        if (approach > getRestingSpeed() * sqrtf(dx * dx + dz * dz)) return 0.0;
+        c[0] = touching;
+    }
+    return firstContact(c, 4, horizon);
+}
+
+void BallPhysics::push(double delay, EventType type, uint32_t i, uint32_t j)
+{
+    if (std::isinf(delay)) return;
+    Event e;
+    e.time = now + delay;
+    e.i = i;
+    e.j = j;
+    e.versionI = versions[i];
+    e.versionJ = type == EventType::Ball ? versions[j] : 0;
+    e.type = type;
+    events.push_back(e);
+    std::push_heap(events.begin(), events.end(), Later());
+}
@@ -0,0 +1,492 @@
+#include "Benchmark.h"
+#include "BallGrid.h"
+#include "NarrowPhase.h"
+#include "TransformKernel.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+
+Benchmark::Benchmark(uint32_t nbFrames, uint32_t nbWarmupFrames) : nbFrames(nbFrames), nbWarmup(nbWarmupFrames) {}
+
+void Benchmark::beginFrame()
+{
+    frameStart = Clock::now();
+}
+
+void Benchmark::endFrame()
+{
+    if (frame >= nbWarmup)
+        frameTotal += std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+    frame++;
+}
+
+void Benchmark::beginSubmit()
+{
+    submitStart = Clock::now();
+}
+
+void Benchmark::endSubmit()
+{
+    if (frame < nbWarmup) return;
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - submitStart).count();
+    submitTotal += ms;
+    if (ms > submitMax) submitMax = ms;
+}
+
+void Benchmark::beginPick()
+{
+    pickStart = Clock::now();
+}
+
+void Benchmark::endPick()
+{
+    if (frame < nbWarmup) return;
+    pickTotal += std::chrono::duration<double, std::milli>(Clock::now() - pickStart).count();
+}
+
+void Benchmark::countStateCalls(uint32_t issued, uint32_t elided)
+{
+    if (frame < nbWarmup) return;
+    stateIssued += issued;
+    stateElided += elided;
+}
+
+void Benchmark::countUpdatedNodes(uint32_t updated, uint32_t total)
+{
+    if (frame < nbWarmup) return;
+    nodesUpdated += updated;
+    nodesTotal += total;
+}
+
+void Benchmark::countCulledNodes(uint32_t drawn, uint32_t culled)
+{
+    if (frame < nbWarmup) return;
+    nodesDrawn += drawn;
+    nodesCulled += culled;
+}
+
+void Benchmark::report(const char* label) const
+{
+    uint32_t n = frame > nbWarmup ? frame - nbWarmup : 0;
+    if (n == 0) return;
+    INFO("benchmark [%s] %u frames : submit %.4f ms/frame (max %.4f), frame %.4f ms/frame\n",
+         label, n, submitTotal / n, submitMax, frameTotal / n);
+    INFO("benchmark [%s] state calls : %.1f issued, %.1f elided per frame\n",
+         label, stateIssued / (double)n, stateElided / (double)n);
+    INFO("benchmark [%s] scene nodes : %.1f of %.1f recomputed per frame\n",
+         label, nodesUpdated / (double)n, nodesTotal / (double)n);
+    INFO("benchmark [%s] frustum culling : %.1f drawn, %.1f culled per frame\n",
+         label, nodesDrawn / (double)n, nodesCulled / (double)n);
+    INFO("benchmark [%s] picking : %.4f ms/ray\n", label, pickTotal / n);
+}
+
+void Benchmark::transforms(uint32_t nbNodes, uint32_t nbRuns)
+{
+    if (nbNodes == 0 || nbRuns == 0) return;
+
+    // a tree of depth log4(nbNodes), parents before childs. The non uniform scales are in the self matrices, as in the scene,
+    // except for 1 leaf in 8 whose propagated scale shears its model matrix
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    std::vector<uint32_t> parents(nbNodes), all(nbNodes);
+    std::vector<glm::mat4> propagate(nbNodes), self(nbNodes);
+    for (uint32_t i = 0; i < nbNodes; i++)
+    {
+        parents[i] = i == 0 ? TransformKernel::NO_PARENT : (i - 1) / 4;
+        all[i] = i;
+        glm::vec3 axis = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)) + glm::vec3(0.f, 0.f, 2.f));
+        glm::mat4 m = glm::translate(glm::mat4(1.f), glm::vec3(unit(rng), unit(rng), unit(rng)));
+        m = glm::rotate(m, 3.f * unit(rng), axis);
+        bool leaf = 4 * i + 1 >= nbNodes;
+        propagate[i] = leaf && i % 8 == 0 ? glm::scale(m, glm::vec3(1.f, 1.5f, 0.8f)) : m;
+        self[i] = glm::rotate(propagate[i], unit(rng), axis) * glm::scale(glm::mat4(1.f), glm::vec3(1.f, 1.f + 0.5f * unit(rng), 1.f));
+    }
+
+    std::vector<glm::mat4> world(nbNodes), model(nbNodes), worldRef(nbNodes), modelRef(nbNodes);
+    std::vector<glm::mat3> normal(nbNodes), normalRef(nbNodes);
+    auto measure = [&](decltype(&TransformKernel::compose) compose, glm::mat4* w, glm::mat4* m, glm::mat3* n) {
+        compose(all.data(), nbNodes, parents.data(), propagate.data(), self.data(), w, m, n); // warmup
+        Clock::time_point start = Clock::now();
+        for (uint32_t r = 0; r < nbRuns; r++)
+            compose(all.data(), nbNodes, parents.data(), propagate.data(), self.data(), w, m, n);
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / nbRuns;
+    };
+    double glmMs = measure(&TransformKernel::composeReference, worldRef.data(), modelRef.data(), normalRef.data());
+    INFO("transform kernel (glm) %u nodes : %.4f ms/pass\n", nbNodes, glmMs);
+
+    // each instruction set of the processor, against glm
+    TransformKernel::Path best = TransformKernel::getBestPath();
+    const TransformKernel::Path paths[3] = { TransformKernel::Path::Scalar, TransformKernel::Path::SSE, TransformKernel::Path::AVX };
+    for (TransformKernel::Path path : paths)
+    {
+        if (path > best) break;
+        TransformKernel::setPath(path);
+        double kernelMs = measure(&TransformKernel::compose, world.data(), model.data(), normal.data());
+
+        float maxModel = 0.f, maxNormal = 0.f;
+        for (uint32_t i = 0; i < nbNodes; i++)
+        {
+            for (int c = 0; c < 4; c++)
+                for (int r = 0; r < 4; r++)
+                    maxModel = glm::max(maxModel, glm::abs(model[i][c][r] - modelRef[i][c][r]) / (1.f + glm::abs(modelRef[i][c][r])));
+            for (int c = 0; c < 3; c++)
+                for (int r = 0; r < 3; r++)
+                    maxNormal = glm::max(maxNormal, glm::abs(normal[i][c][r] - normalRef[i][c][r]) / (1.f + glm::abs(normalRef[i][c][r])));
+        }
+
+        INFO("transform kernel (%s) %u nodes : %.4f ms/pass (x%.2f glm), largest relative difference with glm %.2e (model), %.2e (normal)\n",
+             TransformKernel::getName(path), nbNodes, kernelMs, glmMs / kernelMs, maxModel, maxNormal);
+    }
+    TransformKernel::setPath(best);
+}
+
+namespace {
+
+// the rack, its apex on the right quarter of the table, and the white ball on the left quarter, shot at 10 m/s
+// slightly off center so that the rack does not break symmetrically
+void setupBreak(BallPhysics& balls, BallPhysics::Params const& params)
+{
+    float d = 2.f * params.radius, h = 0.5f * sqrtf(3.f) * d;
+    for (int row = 0; row < 5; row++)
+        for (int k = 0; k <= row; k++)
+            balls.addBall(glm::vec2(0.25f * params.length + row * h, (k - 0.5f * row) * d));
+    uint32_t white = balls.addBall(glm::vec2(-0.25f * params.length, 0.f));
+    balls.hit(white, glm::vec2(10.f, 0.05f) * params.unitsPerMeter);
+}
+
+// a break from a random position of the white ball, at a random speed (6 to 10 m/s) and spin
+void setupRandomBreak(BallPhysics& balls, BallPhysics::Params const& params, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    float d = 2.f * params.radius, h = 0.5f * sqrtf(3.f) * d;
+    for (int row = 0; row < 5; row++)
+        for (int k = 0; k <= row; k++)
+            balls.addBall(glm::vec2(0.25f * params.length + row * h, (k - 0.5f * row) * d));
+    uint32_t white = balls.addBall(glm::vec2(-0.25f * params.length + 0.2f * unit(rng), 0.5f * unit(rng)));
+    glm::vec2 aim = glm::normalize(glm::vec2(0.25f * params.length, 0.f) - balls.getPosition(white));
+    aim = glm::normalize(aim + glm::vec2(0.f, 0.05f * unit(rng)));
+    float speed = 8.f + 2.f * unit(rng);
+    balls.hit(white, speed * params.unitsPerMeter * aim, glm::vec3(10.f * unit(rng), 20.f * unit(rng), 10.f * unit(rng)));
+}
+
+// simulates until every ball stops (or maxSeconds), returns the simulated time and in count the steps or events
+// (and in substeps the substeps of the steps)
+double simulate(BallPhysics& balls, float maxSeconds, uint32_t& count, uint32_t& substeps)
+{
+    count = substeps = 0;
+    if (balls.getMode() == BallPhysics::Mode::EventDriven)
+    {
+        double t = 0.0, last = 0.0;
+        while ((t = balls.nextEvent()) >= 0.0 && t < maxSeconds)
+        {
+            last = t;
+            count++;
+        }
+        return last;
+    }
+    while (balls.isMoving() && count * balls.getParams().timestep < maxSeconds)
+    {
+        substeps += balls.step();
+        count++;
+    }
+    return count * balls.getParams().timestep;
+}
+
+}
+
+bool Benchmark::physics(BallPhysics::Params const& params, uint32_t nbRuns, uint32_t nbRandomBreaks)
+{
+    bool ok = true;
+
+    const float maxSeconds = 60.f;
+    const BallPhysics::Mode modes[2] = { BallPhysics::Mode::FixedStep, BallPhysics::Mode::EventDriven };
+    for (BallPhysics::Mode mode : modes)
+    {
+        if (nbRuns == 0) break;
+        uint32_t count = 0, substeps = 0, pocketed = 0;
+        double seconds = 0.0, totalMs = 0.0;
+        for (uint32_t run = 0; run < nbRuns; run++)
+        {
+            BallPhysics balls(params, mode);
+            setupBreak(balls, params);
+
+            Clock::time_point start = Clock::now();
+            seconds = simulate(balls, maxSeconds, count, substeps);
+            totalMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+            pocketed = 0;
+            for (uint32_t i = 0; i < balls.size(); i++)
+                pocketed += balls.getState(i) == BallPhysics::State::Pocketed;
+        }
+
+        if (mode == BallPhysics::Mode::FixedStep)
+            INFO("ball physics (fixed step) : break of %.2f s simulated in %u steps of %.1f ms (%u substeps), %u balls pocketed : %.4f ms (%.3f us/substep)\n",
+                 seconds, count, params.timestep * 1e3f, substeps, pocketed, totalMs / nbRuns, 1e3 * totalMs / nbRuns / substeps);
+        else
+            INFO("ball physics (event driven) : break of %.2f s simulated in %u events, %u balls pocketed : %.4f ms (%.3f us/event)\n",
+                 seconds, count, pocketed, totalMs / nbRuns, 1e3 * totalMs / nbRuns / count);
+    }
+
+    // random breaks event driven, by frames as in the application. Balls resting on each other (a ball pushing
+    // a touching one) used to bounce in a loop of contacts an instant apart, up to MAX_EVENTS in a frame
+    std::mt19937 rng(1);
+    uint32_t maxEvents = 0, stuck = 0;
+    float maxOverlap = 0.f;
+    for (uint32_t run = 0; run < nbRandomBreaks; run++)
+    {
+        BallPhysics balls(params, BallPhysics::Mode::EventDriven);
+        setupRandomBreak(balls, params, rng);
+        uint32_t runEvents = 0;
+        for (uint32_t frame = 0; frame < 60 * maxSeconds && balls.isMoving(); frame++)
+            runEvents = std::max(runEvents, balls.advance(1.f / 60.f));
+        maxEvents = std::max(maxEvents, runEvents);
+        stuck += runEvents >= BallPhysics::MAX_EVENTS / 100;
+
+        for (uint32_t i = 0; i < balls.size(); i++)
+            for (uint32_t j = i + 1; j < balls.size(); j++)
+                if (balls.getState(i) != BallPhysics::State::Pocketed && balls.getState(j) != BallPhysics::State::Pocketed)
+                    maxOverlap = std::max(maxOverlap, 2.f * params.radius - glm::length(balls.getPosition(j) - balls.getPosition(i)));
+    }
+    if (nbRandomBreaks > 0)
+        INFO("ball physics (event driven) : %u random breaks, at most %u events in a frame, overlaps up to %.2e ball radius\n",
+             nbRandomBreaks, maxEvents, maxOverlap / params.radius);
+    if (stuck > 0 || maxOverlap > 1e-2f * params.radius)
+    {
+        ERROR("%u of %u random breaks took more than %u events in a frame, overlaps up to %.2e ball radius\n",
+              stuck, nbRandomBreaks, (uint32_t)BallPhysics::MAX_EVENTS / 100, maxOverlap / params.radius);
+        ok = false;
+    }
+
+    // the same shot in both modes : the white ball alone, with side spin and draw, off two cushions.
+    // The rack breaks chaotically, a difference there says nothing. The fixed steps bounce where the ball touched,
+    // but the spin and the friction up to there are those of the whole step : about 0.15 ball radius apart at 1/120 s,
+    // 0.01 at 1 ms. Shorter steps do not get closer, the rounding of their many small moves takes over
+    const float tolerance = 0.5f * params.radius;
+    glm::vec2 end[2];
+    for (int m = 0; m < 2; m++)
+    {
+        BallPhysics ball(params, modes[m]);
+        uint32_t white = ball.addBall(glm::vec2(-0.25f * params.length, 0.1f * params.width));
+        ball.hit(white, glm::vec2(3.f, 2.f) * params.unitsPerMeter, glm::vec3(10.f, 20.f, 5.f));
+        uint32_t count, substeps;
+        simulate(ball, maxSeconds, count, substeps);
+        end[m] = ball.getPosition(white);
+    }
+    float apart = glm::length(end[1] - end[0]);
+    INFO("ball physics : the modes end the same shot %.4f units apart (%.4f ball radius)\n", apart, apart / params.radius);
+    if (apart > tolerance)
+    {
+        ERROR("the modes end the same shot more than %.2f ball radius apart\n", tolerance / params.radius);
+        ok = false;
+    }
+    return ok;
+}
+
+void Benchmark::broadphase(BallPhysics::Params const& params, uint32_t maxBalls, uint32_t nbFrames)
+{
+    if (maxBalls == 0 || nbFrames == 0) return;
+
+    const float r = params.radius, dt = 1.f / 60.f;
+    for (uint32_t n = 16; ; n = std::min(10 * n, maxBalls))
+    {
+        // the balls cover 8% of the table whatever their number, at up to 2 m/s
+        BallPhysics::Params table = params;
+        table.width = sqrtf(20.f * n) * r;
+        table.length = 2.f * table.width;
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+        std::vector<float> x(n), z(n), vx(n), vz(n);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            x[i] = unit(rng) * (0.5f * table.length - r);
+            z[i] = unit(rng) * (0.5f * table.width - r);
+            vx[i] = unit(rng) * 2.f * params.unitsPerMeter;
+            vz[i] = unit(rng) * 2.f * params.unitsPerMeter;
+        }
+
+        // the grid alone, every ball moving and queried : the balls bounce on the edges without colliding
+        BallGrid grid(table.length, table.width, r);
+        for (uint32_t i = 0; i < n; i++) grid.add(glm::vec2(x[i], z[i]));
+        std::vector<uint32_t> all(n);
+        std::vector<uint8_t> queried(n, 1);
+        for (uint32_t i = 0; i < n; i++) all[i] = i;
+        std::vector<BallGrid::Pair> pairs;
+        double updateMs = 0.0, pairsMs = 0.0;
+        uint64_t relinked = 0;
+        for (uint32_t f = 0; f < nbFrames; f++)
+        {
+            Clock::time_point start = Clock::now();
+            for (uint32_t i = 0; i < n; i++)
+            {
+                x[i] += vx[i] * dt;
+                z[i] += vz[i] * dt;
+                if (fabsf(x[i]) > 0.5f * table.length - r) { vx[i] = -vx[i]; x[i] = copysignf(0.5f * table.length - r, x[i]); }
+                if (fabsf(z[i]) > 0.5f * table.width - r) { vz[i] = -vz[i]; z[i] = copysignf(0.5f * table.width - r, z[i]); }
+                relinked += grid.move(i, glm::vec2(x[i], z[i]));
+            }
+            Clock::time_point middle = Clock::now();
+            pairs.clear();
+            grid.findPairs(all, queried.data(), pairs);
+            Clock::time_point end = Clock::now();
+            updateMs += std::chrono::duration<double, std::milli>(middle - start).count();
+            pairsMs += std::chrono::duration<double, std::milli>(end - middle).count();
+        }
+        uint32_t touching = 0;
+        for (BallGrid::Pair const& p : pairs)
+            touching += glm::length(glm::vec2(x[p.j] - x[p.i], z[p.j] - z[p.i])) < 2.f * r;
+
+        // every pair, checking the grid misses none (too slow past 20000 balls)
+        char allPairs[64] = "skipped";
+        if (n <= 20000)
+        {
+            Clock::time_point start = Clock::now();
+            uint32_t touchingAll = 0;
+            for (uint32_t i = 0; i < n; i++)
+                for (uint32_t j = i + 1; j < n; j++)
+                    touchingAll += glm::length(glm::vec2(x[j] - x[i], z[j] - z[i])) < 2.f * r;
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            snprintf(allPairs, sizeof(allPairs), "%.3f ms, %s", ms, touchingAll == touching ? "same pairs" : "PAIRS MISSED");
+        }
+
+        // the whole fixed step, the balls colliding
+        BallPhysics balls(table);
+        for (uint32_t i = 0; i < n; i++) balls.addBall(glm::vec2(x[i], z[i]));
+        for (uint32_t i = 0; i < n; i++) balls.hit(i, glm::vec2(vx[i], vz[i]));
+        Clock::time_point start = Clock::now();
+        for (uint32_t f = 0; f < nbFrames; f++) balls.step();
+        double stepMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / nbFrames;
+
+        INFO("broadphase %u balls (%u cells) : update %.3f ms (%.1f%% relinked), pairs %.3f ms (%u candidates, %u touching), "
+             "all pairs %s, physics step %.3f ms\n",
+             n, grid.getNbCells(), updateMs / nbFrames, 100.0 * relinked / ((double)n * nbFrames), pairsMs / nbFrames,
+             (uint32_t)pairs.size(), touching, allPairs, stepMs);
+        if (n == maxBalls) break;
+    }
+}
+
+bool Benchmark::narrowphase(BallPhysics::Params const& params, uint32_t nbRuns)
+{
+    if (nbRuns == 0) return true;
+
+    // 1024 balls around the tested one, the closest touching it, moving at up to 2 m/s
+    const uint32_t nbBalls = 1024, nbShots = 3600;
+    const float d = 2.f * params.radius;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    std::vector<float> x(nbBalls), z(nbBalls), vx(nbBalls), vz(nbBalls);
+    for (uint32_t k = 0; k < nbBalls; k++)
+    {
+        x[k] = 10.f * d * unit(rng);
+        z[k] = 10.f * d * unit(rng);
+        vx[k] = 2.f * params.unitsPerMeter * unit(rng);
+        vz[k] = 2.f * params.unitsPerMeter * unit(rng);
+    }
+    glm::vec2 p(0.f), v(params.unitsPerMeter, 0.f);
+
+    // the batch of shots : the white ball aimed all around at the rack
+    std::vector<float> rackX, rackZ, rackV(15, 0.f);
+    float h = 0.5f * sqrtf(3.f) * d;
+    for (int row = 0; row < 5; row++)
+        for (int k = 0; k <= row; k++)
+        {
+            rackX.push_back(0.25f * params.length + row * h);
+            rackZ.push_back((k - 0.5f * row) * d);
+        }
+    glm::vec2 white(-0.25f * params.length, 0.f);
+
+    // the boundary : 1 to 40 balls (every tail of the wide paths) at the distance of contact, give or take a few ulps
+    const uint32_t nbEdges = 40;
+    std::vector<float> edgeX(nbEdges), edgeZ(nbEdges), edgeVX(nbEdges), edgeVZ(nbEdges);
+    for (uint32_t k = 0; k < nbEdges; k++)
+    {
+        float angle = 3.14159265f * unit(rng), l = d * (1.f + 4e-7f * unit(rng));
+        edgeX[k] = l * cosf(angle);
+        edgeZ[k] = l * sinf(angle);
+        edgeVX[k] = -edgeX[k] * unit(rng);
+        edgeVZ[k] = -edgeZ[k] * unit(rng);
+    }
+
+    struct Results {
+        std::vector<uint32_t> mask;
+        std::vector<float> times;
+        std::vector<uint32_t> shotBalls;
+        std::vector<float> shotTimes;
+        std::vector<uint32_t> edgeMasks;
+        std::vector<float> edgeTimes;
+    };
+    auto run = [&](Results& r, double& contactsNs, double& impactsNs, double& shotsMs) {
+        r.mask.assign((nbBalls + 31) / 32, 0);
+        r.times.assign(nbBalls, 0.f);
+        r.shotBalls.assign(nbShots, 0);
+        r.shotTimes.assign(nbShots, 0.f);
+        uint32_t first, touching = 0;
+
+        Clock::time_point start = Clock::now();
+        for (uint32_t k = 0; k < nbRuns; k++)
+            touching += NarrowPhase::contacts(p, x.data(), z.data(), nbBalls, d, r.mask.data());
+        contactsNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / nbRuns;
+
+        start = Clock::now();
+        for (uint32_t k = 0; k < nbRuns; k++)
+            NarrowPhase::impacts(p, v, x.data(), z.data(), vx.data(), vz.data(), nbBalls, d, 1.f, r.times.data(), first);
+        impactsNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / nbRuns;
+
+        float times[15];
+        start = Clock::now();
+        for (uint32_t s = 0; s < nbShots; s++)
+        {
+            float angle = 6.2831853f * s / nbShots;
+            glm::vec2 aim = params.unitsPerMeter * glm::vec2(cosf(angle), sinf(angle));
+            r.shotTimes[s] = NarrowPhase::impacts(white, aim, rackX.data(), rackZ.data(), rackV.data(), rackV.data(),
+                                                  15, d, 10.f, times, r.shotBalls[s]);
+        }
+        shotsMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        r.edgeMasks.assign(nbEdges * 2, 0);
+        r.edgeTimes.assign(nbEdges * nbEdges, 0.f);
+        for (uint32_t count = 1; count <= nbEdges; count++)
+        {
+            NarrowPhase::contacts(glm::vec2(0.f), edgeX.data(), edgeZ.data(), count, d, &r.edgeMasks[2 * (count - 1)]);
+            NarrowPhase::impacts(glm::vec2(0.f), glm::vec2(0.f), edgeX.data(), edgeZ.data(), edgeVX.data(), edgeVZ.data(),
+                                 count, d, 1.f, &r.edgeTimes[nbEdges * (count - 1)], first);
+        }
+        return touching / nbRuns;
+    };
+
+    NarrowPhase::Path best = NarrowPhase::getBestPath();
+    NarrowPhase::setPath(NarrowPhase::Path::Scalar);
+    Results reference;
+    double contactsNs, impactsNs, shotsMs;
+    uint32_t touching = run(reference, contactsNs, impactsNs, shotsMs);
+    INFO("narrowphase (scalar) : 1 ball against %u, %u touching : contacts %.1f ns, impacts %.1f ns, %u shots at the rack %.3f ms\n",
+         nbBalls, touching, contactsNs, impactsNs, nbShots, shotsMs);
+
+    // no fused multiply-add in NarrowPhase : the paths round the same way, their results are the same bit for bit
+    bool ok = true;
+    const NarrowPhase::Path paths[3] = { NarrowPhase::Path::SSE, NarrowPhase::Path::AVX2, NarrowPhase::Path::AVX512 };
+    for (NarrowPhase::Path path : paths)
+    {
+        if (path > best) break;
+        NarrowPhase::setPath(path);
+        Results r;
+        run(r, contactsNs, impactsNs, shotsMs);
+
+        bool same = r.mask == reference.mask && r.shotBalls == reference.shotBalls && r.edgeMasks == reference.edgeMasks
+                 && memcmp(r.times.data(), reference.times.data(), nbBalls * sizeof(float)) == 0
+                 && memcmp(r.shotTimes.data(), reference.shotTimes.data(), nbShots * sizeof(float)) == 0
+                 && memcmp(r.edgeTimes.data(), reference.edgeTimes.data(), nbEdges * nbEdges * sizeof(float)) == 0;
+
+        INFO("narrowphase (%s) : contacts %.1f ns, impacts %.1f ns, %u shots at the rack %.3f ms : %s as scalar\n",
+             NarrowPhase::getName(path), contactsNs, impactsNs, nbShots, shotsMs, same ? "same results" : "OTHER RESULTS");
+        if (!same)
+        {
+            ERROR("narrowphase (%s) : the contacts or the times differ from the scalar path\n", NarrowPhase::getName(path));
+            ok = false;
+        }
+    }
+    NarrowPhase::setPath(best);
+    return ok;
+}
@@ -31,3 +31,13 @@ void Camera::move(float pitch, float yaw, float forward, float right, float up)
 
     viewMat = glm::lookAt(pos, pos + lookat, up2);
 }
+
+Ray Camera::getRay(glm::mat4 const& projection, float x, float y)
+{
+    // the points of the near and far planes under the screen point
+    glm::mat4 inv = glm::inverse(projection * viewMat);
+    glm::vec4 near = inv * glm::vec4(x, y, -1.f, 1.f);
+    glm::vec4 far = inv * glm::vec4(x, y, 1.f, 1.f);
+    glm::vec3 origin = glm::vec3(near) / near.w;
+    return {origin, glm::normalize(glm::vec3(far) / far.w - origin)};
+}
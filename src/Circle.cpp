@@ -6,30 +6,40 @@ Circle::Circle(uint32_t nbEdge) : Geometry()
     if(nbEdge < 3)
         ERROR("The parameter 'nbEdge' should be three or greater\n");
 
-    m_vertices = (float*)malloc(9*(uint64_t)nbEdge*sizeof(float));
-    m_uvs      = (float*)malloc(6*(uint64_t)nbEdge*sizeof(float));
-    m_normals  = (float*)malloc(9*(uint64_t)nbEdge*sizeof(float));
-    m_nbVertices = 3*nbEdge;
+    /* The center, then one vertex per edge on the border */
+    m_nbVertices = nbEdge+1;
+    m_vertices = (float*)malloc(3*(uint64_t)m_nbVertices*sizeof(float));
+    m_uvs      = (float*)malloc(2*(uint64_t)m_nbVertices*sizeof(float));
+    m_normals  = (float*)malloc(3*(uint64_t)m_nbVertices*sizeof(float));
 
     const float PI = (float)M_PI;
 
-    for(uint32_t i=0; i < nbEdge; i++)
+    for(uint32_t i=0; i < m_nbVertices; i++)
     {
-        float pos[] = {(float)cos(i*2*PI/nbEdge), (float)sin(i*2*PI/nbEdge), 0.0f,
-                       0.0f, 0.0f, 0.0f,
-                       (float)cos((i+1)*2*PI/nbEdge), (float)sin((i+1)*2*PI/nbEdge), 0.0f};
-
-        for(uint32_t j=0; j < 9; j++)
-            m_vertices[9*i+j] = 0.5f*pos[j];
-        for(uint32_t j=0; j < 3; j++)
-            for(uint32_t k = 0; k < 2; k++)
-                m_uvs[6*i+2*j+k] = m_vertices[9*i+3*j+k]+0.5f;
+        float pos[] = {0.0f, 0.0f, 0.0f};
+        if(i > 0)
+        {
+            pos[0] = (float)cos((i-1)*2*PI/nbEdge);
+            pos[1] = (float)sin((i-1)*2*PI/nbEdge);
+        }
 
+        float normal[] = {0.0f, 0.0f, 1.0f};
         for(uint32_t j=0; j < 3; j++)
         {
-            float normal[] = {0.0f, 0.0f, 1.0f};
-            for(uint32_t k=0; k < 3; k++)
-                m_normals[9*i+3*j+k] = normal[k];
+            m_vertices[3*i+j] = 0.5f*pos[j];
+            m_normals [3*i+j] = normal[j];
         }
+        for(uint32_t j = 0; j < 2; j++)
+            m_uvs[2*i+j] = m_vertices[3*i+j]+0.5f;
+    }
+
+    /* One triangle per edge : border, center, next border */
+    m_nbIndices = 3*nbEdge;
+    m_indices   = (uint32_t*)malloc((uint64_t)m_nbIndices*sizeof(uint32_t));
+    for(uint32_t i=0; i < nbEdge; i++)
+    {
+        m_indices[3*i+0] = 1+i;
+        m_indices[3*i+1] = 0;
+        m_indices[3*i+2] = 1+(i+1)%nbEdge;
     }
 }
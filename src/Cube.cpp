@@ -160,4 +160,7 @@ Cube::Cube() : Geometry()
     for(uint32_t i = 0; i < 2*36; i++)
         m_uvs[i] = uvs[i];
     m_nbVertices = 36;
+
+    /* 4 vertices per face instead of 6 */
+    weld();
 }
@@ -4,44 +4,46 @@
 Cylinder::Cylinder(uint32_t nbLattitude) : Geometry()
 {
     float radius = 0.5;
-    m_nbVertices = nbLattitude * 6;
-    m_vertices   = (float*)malloc(sizeof(float)*3*6*nbLattitude);
-    m_normals    = (float*)malloc(sizeof(float)*3*6*nbLattitude);
 
-    m_uvs        = (float*)malloc(sizeof(float)*2*6*nbLattitude);
+    /* One column of 2 vertices (bottom, top) per lattitude. The first column is repeated at the end for the UV seam */
+    m_nbVertices = 2*(nbLattitude+1);
+    m_vertices   = (float*)malloc(sizeof(float)*3*m_nbVertices);
+    m_normals    = (float*)malloc(sizeof(float)*3*m_nbVertices);
+    m_uvs        = (float*)malloc(sizeof(float)*2*m_nbVertices);
 
-	for(uint32_t i=0; i < nbLattitude; i++)
+	for(uint32_t i=0; i <= nbLattitude; i++)
 	{
-		double pos[] = {radius*cos(i*2*M_PI/nbLattitude),     radius*sin(i*2*M_PI/nbLattitude), -1.0/2,
-					    radius*cos((i+1)*2*M_PI/nbLattitude), radius*sin((i+1)*2*M_PI/nbLattitude), -1.0/2,
-					    radius*cos((i+1)*2*M_PI/nbLattitude), radius*sin((i+1)*2*M_PI/nbLattitude), 1.0/2,
-
-					    radius*cos(i*2*M_PI/nbLattitude),     radius*sin(i*2*M_PI/nbLattitude), -1.0/2,
-					    radius*cos((i+1)*2*M_PI/nbLattitude), radius*sin((i+1)*2*M_PI/nbLattitude), 1.0/2,
-					    radius*cos(i*2*M_PI/nbLattitude),     radius*sin(i*2*M_PI/nbLattitude), 1.0/2
+		double pos[] = {radius*cos(i*2*M_PI/nbLattitude), radius*sin(i*2*M_PI/nbLattitude), -1.0/2,
+					    radius*cos(i*2*M_PI/nbLattitude), radius*sin(i*2*M_PI/nbLattitude),  1.0/2
 					   };
 
-		double uvPos[] = {
-                         i/(double)nbLattitude,   0.0,
-					     (i+1)/(double)nbLattitude, 0.0,
-					     (i+1)/(double)nbLattitude, 1.0,
-
-					     i/(double)nbLattitude,     0.0,
-					     (i+1)/(double)nbLattitude, 1.0,
-					     i/(double)nbLattitude,    1.0
+		double uvPos[] = {i/(double)nbLattitude, 0.0,
+					      i/(double)nbLattitude, 1.0
 					     };
 
-		for(uint32_t j=0; j < 18; j++)
-			m_vertices[18*i+j] = (float)pos[j];
+		for(uint32_t j=0; j < 6; j++)
+			m_vertices[6*i+j] = (float)pos[j];
 
-        for(uint32_t j = 0; j < 12; j++)
-            m_uvs[12*i+j] = (float)uvPos[j];
+        for(uint32_t j = 0; j < 4; j++)
+            m_uvs[4*i+j] = (float)uvPos[j];
 
-        for(uint32_t j = 0; j < 6; j++)
+        for(uint32_t j = 0; j < 2; j++)
         {
             for(uint32_t k = 0; k < 2; k++)
-                m_normals[18*i+3*j+k]  = (float)pos[3*j+k];
-            m_normals[18*i+3*j+2] = 0.0f;
+                m_normals[6*i+3*j+k]  = (float)pos[3*j+k];
+            m_normals[6*i+3*j+2] = 0.0f;
         }
 	}
+
+    /* Two triangles per lattitude */
+    m_nbIndices = 6*nbLattitude;
+    m_indices   = (uint32_t*)malloc(sizeof(uint32_t)*m_nbIndices);
+	for(uint32_t i=0; i < nbLattitude; i++)
+	{
+        uint32_t bottom = 2*i, top = 2*i+1, nextBottom = 2*(i+1), nextTop = 2*(i+1)+1;
+        uint32_t o[] = {bottom, nextBottom, nextTop,
+                        bottom, nextTop,    top};
+        for(uint32_t j = 0; j < 6; j++)
+            m_indices[6*i+j] = o[j];
+	}
 }
@@ -0,0 +1,70 @@
+#include "Frustum.h"
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define FRUSTUM_SSE
+#endif
+
+Frustum::Frustum(glm::mat4 const& viewProjection)
+{
+    // Gribb & Hartmann : the planes are sums of the rows of the matrix (glm is column major)
+    glm::vec4 r0 = glm::vec4(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+    glm::vec4 r1 = glm::vec4(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+    glm::vec4 r2 = glm::vec4(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+    glm::vec4 r3 = glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+    glm::vec4 planes[6] = { r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2 };
+
+    for (int i = 0; i < 8; i++)
+    {
+        glm::vec4 p = glm::vec4(0.f, 0.f, 0.f, 1.f);
+        if (i < 6) p = planes[i] / glm::length(glm::vec3(planes[i]));
+        x[i] = p.x; y[i] = p.y; z[i] = p.z; w[i] = p.w;
+    }
+}
+
+Frustum::Result Frustum::test(AABB const& box) const
+{
+    // for each plane : d is the distance from the center of the box to the plane,
+    // r is the extent of the box along the normal of the plane
+    glm::vec3 c = box.getCenter();
+    glm::vec3 e = box.getExtents();
+
+#ifdef FRUSTUM_SSE
+    const __m128 signMask = _mm_set1_ps(-0.f);
+    __m128 cx = _mm_set1_ps(c.x), cy = _mm_set1_ps(c.y), cz = _mm_set1_ps(c.z);
+    __m128 ex = _mm_set1_ps(e.x), ey = _mm_set1_ps(e.y), ez = _mm_set1_ps(e.z);
+    int outside = 0, intersects = 0;
+    for (int i = 0; i < 8; i += 4)
+    {
+        __m128 px = _mm_load_ps(x + i), py = _mm_load_ps(y + i), pz = _mm_load_ps(z + i);
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, cx), _mm_mul_ps(py, cy)),
+                              _mm_add_ps(_mm_mul_ps(pz, cz), _mm_load_ps(w + i)));
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, px), ex),
+                                         _mm_mul_ps(_mm_andnot_ps(signMask, py), ey)),
+                              _mm_mul_ps(_mm_andnot_ps(signMask, pz), ez));
+        outside    |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+        intersects |= _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(d, r), _mm_setzero_ps()));
+    }
+#else
+    bool outside = false, intersects = false;
+    for (int i = 0; i < 6; i++)
+    {
+        float d = x[i] * c.x + y[i] * c.y + z[i] * c.z + w[i];
+        float r = fabsf(x[i]) * e.x + fabsf(y[i]) * e.y + fabsf(z[i]) * e.z;
+        outside = outside || d + r < 0.f;
+        intersects = intersects || d - r < 0.f;
+    }
+#endif
+
+    if (outside) return Result::Outside;
+    return intersects ? Result::Intersects : Result::Inside;
+}
+
+bool Frustum::test(BoundingSphere const& sphere) const
+{
+    for (int i = 0; i < 6; i++)
+        if (x[i] * sphere.center.x + y[i] * sphere.center.y + z[i] * sphere.center.z + w[i] < -sphere.radius)
+            return false;
+    return true;
+}
@@ -0,0 +1,212 @@
+#include "GLState.h"
+
+GLuint GLState::program;
+GLuint GLState::activeUnit;
+GLuint GLState::textures[NB_UNITS][NB_TARGETS];
+GLuint GLState::vao;
+GLuint GLState::arrayBuffer, GLState::uniformBuffer;
+GLState::IndexedBinding GLState::uniformBindings[NB_UBO_BINDINGS];
+GLuint GLState::caps[NB_CAPS];
+GLuint GLState::blendSrc, GLState::blendDst, GLState::blendMode;
+GLuint GLState::depthWrite, GLState::colorWrite;
+GLState::Stats GLState::stats;
+
+bool GLState::update(GLuint& cached, GLuint value)
+{
+    if (cached == value)
+    {
+        stats.elided++;
+        return false;
+    }
+    cached = value;
+    stats.issued++;
+    return true;
+}
+
+int GLState::textureTargetIndex(GLenum target)
+{
+    switch (target)
+    {
+        case GL_TEXTURE_2D:       return 0;
+        case GL_TEXTURE_2D_ARRAY: return 1;
+        default:                  return -1;
+    }
+}
+
+int GLState::capIndex(GLenum cap)
+{
+    switch (cap)
+    {
+        case GL_BLEND:        return 0;
+        case GL_DEPTH_TEST:   return 1;
+        case GL_CULL_FACE:    return 2;
+        case GL_SCISSOR_TEST: return 3;
+        default:              return -1;
+    }
+}
+
+void GLState::useProgram(GLuint p)
+{
+    if (update(program, p)) glUseProgram(p);
+}
+
+void GLState::activeTexture(GLenum unit)
+{
+    if (update(activeUnit, unit)) glActiveTexture(unit);
+}
+
+void GLState::bindTexture(GLenum target, GLuint texture)
+{
+    int t = textureTargetIndex(target);
+    GLuint unit = activeUnit - GL_TEXTURE0;
+    if (t < 0 || activeUnit == UNKNOWN || unit >= NB_UNITS)
+    {
+        // not cached : what is bound on this unit is unknown from now on
+        if (t >= 0 && activeUnit != UNKNOWN && unit < NB_UNITS) textures[unit][t] = UNKNOWN;
+        stats.issued++;
+        glBindTexture(target, texture);
+        return;
+    }
+    if (update(textures[unit][t], texture)) glBindTexture(target, texture);
+}
+
+void GLState::bindVertexArray(GLuint v)
+{
+    if (update(vao, v)) glBindVertexArray(v);
+}
+
+void GLState::bindBuffer(GLenum target, GLuint buffer)
+{
+    switch (target)
+    {
+        case GL_ARRAY_BUFFER:
+            if (update(arrayBuffer, buffer)) glBindBuffer(target, buffer);
+            break;
+        case GL_UNIFORM_BUFFER:
+            if (update(uniformBuffer, buffer)) glBindBuffer(target, buffer);
+            break;
+        default:
+            stats.issued++;
+            glBindBuffer(target, buffer);
+            break;
+    }
+}
+
+void GLState::bindUniformBufferRange(GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    if (index < NB_UBO_BINDINGS)
+    {
+        IndexedBinding& b = uniformBindings[index];
+        if (b.buffer == buffer && b.offset == offset && b.size == size)
+        {
+            stats.elided++;
+            return;
+        }
+        b = {buffer, offset, size};
+    }
+    stats.issued++;
+    uniformBuffer = buffer;
+    if (size < 0) glBindBufferBase(GL_UNIFORM_BUFFER, index, buffer);
+    else          glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, size);
+}
+
+void GLState::bindUniformBufferBase(GLuint index, GLuint buffer)
+{
+    bindUniformBufferRange(index, buffer, 0, -1);
+}
+
+void GLState::setCap(GLenum cap, GLuint value)
+{
+    int c = capIndex(cap);
+    if (c >= 0 && !update(caps[c], value)) return;
+    if (c < 0) stats.issued++;
+    if (value) glEnable(cap);
+    else       glDisable(cap);
+}
+
+void GLState::enable(GLenum cap)
+{
+    setCap(cap, 1);
+}
+
+void GLState::disable(GLenum cap)
+{
+    setCap(cap, 0);
+}
+
+void GLState::blendFunc(GLenum src, GLenum dst)
+{
+    if (blendSrc == src && blendDst == dst)
+    {
+        stats.elided++;
+        return;
+    }
+    blendSrc = src;
+    blendDst = dst;
+    stats.issued++;
+    glBlendFunc(src, dst);
+}
+
+void GLState::blendEquation(GLenum mode)
+{
+    if (update(blendMode, mode)) glBlendEquation(mode);
+}
+
+void GLState::depthMask(bool write)
+{
+    if (update(depthWrite, write)) glDepthMask(write);
+}
+
+void GLState::colorMask(bool write)
+{
+    if (update(colorWrite, write)) glColorMask(write, write, write, write);
+}
+
+void GLState::deleteProgram(GLuint p)
+{
+    // a deleted program stays in use until another one is, but its name can then be recycled
+    if (program == p) program = UNKNOWN;
+    glDeleteProgram(p);
+}
+
+void GLState::deleteTexture(GLuint texture)
+{
+    // openGL unbinds a deleted texture from every unit
+    for (uint32_t u = 0; u < NB_UNITS; u++)
+        for (uint32_t t = 0; t < NB_TARGETS; t++)
+            if (textures[u][t] == texture) textures[u][t] = 0;
+    glDeleteTextures(1, &texture);
+}
+
+void GLState::deleteVertexArray(GLuint v)
+{
+    if (vao == v) vao = 0;
+    glDeleteVertexArrays(1, &v);
+}
+
+void GLState::deleteBuffer(GLuint buffer)
+{
+    if (arrayBuffer == buffer) arrayBuffer = 0;
+    if (uniformBuffer == buffer) uniformBuffer = 0;
+    for (uint32_t i = 0; i < NB_UBO_BINDINGS; i++)
+        if (uniformBindings[i].buffer == buffer) uniformBindings[i] = {0, 0, -1};
+    glDeleteBuffers(1, &buffer);
+}
+
+void GLState::invalidate()
+{
+    program = activeUnit = vao = arrayBuffer = uniformBuffer = UNKNOWN;
+    for (uint32_t u = 0; u < NB_UNITS; u++)
+        for (uint32_t t = 0; t < NB_TARGETS; t++)
+            textures[u][t] = UNKNOWN;
+    for (uint32_t c = 0; c < NB_CAPS; c++)
+        caps[c] = UNKNOWN;
+    for (uint32_t i = 0; i < NB_UBO_BINDINGS; i++)
+        uniformBindings[i] = {UNKNOWN, 0, 0};
+    blendSrc = blendDst = blendMode = depthWrite = colorWrite = UNKNOWN;
+}
+
+void GLState::beginFrame()
+{
+    stats = Stats();
+}
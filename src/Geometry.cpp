@@ -1,5 +1,7 @@
 #include "Geometry.h"
 #include <cstring>
+#include <map>
+#include <array>
 
 Geometry::Geometry(){}
 
@@ -14,9 +16,12 @@ Geometry::Geometry(Geometry&& mvt) noexcept
     m_vertices   = mvt.m_vertices;
     m_normals    = mvt.m_normals;
     m_uvs        = mvt.m_uvs;
+    m_nbIndices  = mvt.m_nbIndices;
+    m_indices    = mvt.m_indices;
 
     mvt.m_vertices   = mvt.m_normals = mvt.m_uvs = nullptr;
-    mvt.m_nbVertices = 0;
+    mvt.m_indices    = nullptr;
+    mvt.m_nbVertices = mvt.m_nbIndices = 0;
 }
 
 Geometry& Geometry::operator=(const Geometry& copy)
@@ -38,6 +43,14 @@ Geometry& Geometry::operator=(const Geometry& copy)
         m_uvs = (float*)malloc((uint64_t)getNbVertices()*2*sizeof(float));
         if(m_uvs != nullptr)
             memcpy(m_uvs, copy.m_uvs, (uint64_t)getNbVertices()*2*sizeof(float));
+
+        if(copy.isIndexed())
+        {
+            m_nbIndices = copy.m_nbIndices;
+            m_indices = (uint32_t*)malloc((uint64_t)m_nbIndices*sizeof(uint32_t));
+            if(m_indices != nullptr)
+                memcpy(m_indices, copy.m_indices, (uint64_t)m_nbIndices*sizeof(uint32_t));
+        }
     }
 
     return *this;
@@ -56,6 +69,66 @@ void Geometry::clear()
         free(m_normals);
     if(m_uvs)
         free(m_uvs);
+    if(m_indices)
+        free(m_indices);
     m_vertices = m_normals = m_uvs = nullptr;
-    m_nbVertices = 0;
+    m_indices = nullptr;
+    m_nbVertices = m_nbIndices = 0;
+}
+
+AABB Geometry::computeAABB() const
+{
+    AABB box;
+    for(uint32_t i = 0; i < m_nbVertices; i++)
+        box.extend(glm::vec3(m_vertices[3*i], m_vertices[3*i+1], m_vertices[3*i+2]));
+    return box;
+}
+
+BoundingSphere Geometry::computeBoundingSphere() const
+{
+    BoundingSphere sphere;
+    if(m_nbVertices == 0)
+        return sphere;
+
+    sphere.center = computeAABB().getCenter();
+    float radius2 = 0.0f;
+    for(uint32_t i = 0; i < m_nbVertices; i++)
+    {
+        glm::vec3 d = glm::vec3(m_vertices[3*i], m_vertices[3*i+1], m_vertices[3*i+2]) - sphere.center;
+        radius2 = fmaxf(radius2, glm::dot(d, d));
+    }
+    sphere.radius = sqrtf(radius2);
+    return sphere;
+}
+
+void Geometry::weld()
+{
+    if(isIndexed() || m_nbVertices == 0)
+        return;
+
+    uint32_t nbSoup = m_nbVertices;
+    m_nbIndices = nbSoup;
+    m_indices   = (uint32_t*)malloc((uint64_t)nbSoup*sizeof(uint32_t));
+
+    /* Compacts the tables in place : a unique vertex is always moved to an index lower or equal to its own */
+    std::map<std::array<float, 8>, uint32_t> unique;
+    uint32_t nbUnique = 0;
+    for(uint32_t i = 0; i < nbSoup; i++)
+    {
+        std::array<float, 8> key = {m_vertices[3*i], m_vertices[3*i+1], m_vertices[3*i+2],
+                                    m_normals [3*i], m_normals [3*i+1], m_normals [3*i+2],
+                                    m_uvs     [2*i], m_uvs     [2*i+1]};
+        auto it = unique.find(key);
+        if(it != unique.end())
+        {
+            m_indices[i] = it->second;
+            continue;
+        }
+        memmove(m_vertices + 3*nbUnique, m_vertices + 3*i, 3*sizeof(float));
+        memmove(m_normals  + 3*nbUnique, m_normals  + 3*i, 3*sizeof(float));
+        memmove(m_uvs      + 2*nbUnique, m_uvs      + 2*i, 2*sizeof(float));
+        unique[key]  = nbUnique;
+        m_indices[i] = nbUnique++;
+    }
+    m_nbVertices = nbUnique;
 }
\ No newline at end of file
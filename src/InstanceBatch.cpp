@@ -0,0 +1,87 @@
+#include "InstanceBatch.h"
+#include "GLState.h"
+#include "UniformBlocks.h"
+
+#include <cstddef>
+
+InstanceBatch::InstanceBatch(const Mesh* mesh, TextureArray* textures, const Material* mtl) :
+    mesh(mesh), textures(textures), mtl(mtl)
+{
+    // create the shader and get the uniforms
+    FILE* vertexFile = fopen("Shaders/instanced.vert", "r");
+    FILE* fragmentFile = fopen("Shaders/instanced.frag", "r");
+    shader = Shader::loadFromFiles(vertexFile, fragmentFile);
+    fclose(vertexFile);
+    fclose(fragmentFile);
+    if (shader == nullptr)
+    {
+        ERROR("failed to load shaders");
+        exit(1);
+    }
+    uMtlCts = shader->uniform<glm::vec4>("uMtlCts");
+    Uniform<int> uTextures = shader->uniform<int>("uTextures");
+    if (!uMtlCts.isValid() || !uTextures.isValid() || shader->getUniformBlockSize(FRAME_BLOCK_NAME) != (GLint)sizeof(FrameBlock))
+    {
+        ERROR("the instanced shader does not declare the expected uniforms");
+        exit(1);
+    }
+    GLState::useProgram(shader->getProgramID());
+    uTextures.set(0);
+    GLState::useProgram(0);
+
+    // the VAO reads the vertices from the mesh buffer and the instances from our own buffer
+    glGenVertexArrays(1, &vaoID);
+    GLState::bindVertexArray(vaoID);
+
+    mesh->setupAttributes();
+
+    glGenBuffers(1, &instanceVBO);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        for (int i = 0; i < 4; i++)
+        {
+            glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offsetof(InstanceData, model) + i * sizeof(glm::vec4)));
+            glVertexAttribDivisor(3 + i, 1);
+            glEnableVertexAttribArray(3 + i);
+        }
+        glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, colorLayer));
+        glVertexAttribDivisor(7, 1);
+        glEnableVertexAttribArray(7);
+
+    GLState::bindVertexArray(0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+InstanceBatch::~InstanceBatch()
+{
+    GLState::deleteBuffer(instanceVBO);
+    GLState::deleteVertexArray(vaoID);
+    delete shader;
+}
+
+void InstanceBatch::push(glm::mat4 const& model, glm::vec3 const& color, int layer)
+{
+    instances.push_back({model, glm::vec4(color, (float)layer)});
+}
+
+void InstanceBatch::draw()
+{
+    if (instances.empty()) return;
+
+    // upload the instances : grow the buffer if needed, orphan it otherwise so we never wait on the previous frame
+    GLState::bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (instances.size() > capacity)
+        capacity = instances.size() * 2;
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(InstanceData), instances.data());
+
+    GLState::useProgram(shader->getProgramID());
+    uMtlCts.set(mtl->getCoefs());
+
+    textures->bind();
+    GLState::bindVertexArray(vaoID);
+    mesh->drawInstanced((GLsizei)instances.size());
+
+    GLState::bindVertexArray(0);
+    textures->unbind();
+    GLState::useProgram(0);
+}
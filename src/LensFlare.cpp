@@ -1,4 +1,5 @@
 #include "LensFlare.h"
+#include "GLState.h"
 
 bool LensFlare::initialized = false;
 std::vector<Texture*> LensFlare::textures;
@@ -6,17 +7,18 @@ std::vector<float> LensFlare::scales;
 Light* LensFlare::mainLight;
 Shader* LensFlare::shader;
 Query* LensFlare::query;
-GLuint LensFlare::VAOid, LensFlare::VBOid, LensFlare::uni_alpha;
+GLuint LensFlare::VAOid, LensFlare::VBOid;
+Uniform<float> LensFlare::uni_alpha;
 float LensFlare::occlusion = 1.f;
 
 void LensFlare::Init()
 {
     // create the vao and vbo
     glGenVertexArrays(1, &VAOid);
-    glBindVertexArray(VAOid);
+    GLState::bindVertexArray(VAOid);
 
     glGenBuffers(1, &VBOid);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOid);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, VBOid);
 
         glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 3 * 2, nullptr, GL_DYNAMIC_DRAW);
 
@@ -29,8 +31,8 @@ void LensFlare::Init()
         glEnableVertexAttribArray(0);
         glEnableVertexAttribArray(1);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
 
     // create the shader and get the uniforms
     FILE* vertexFile = fopen("Shaders/lens.vert", "r");
@@ -43,13 +45,18 @@ void LensFlare::Init()
         ERROR("failed to load shaders");
         exit(1);
     }
-    uni_alpha = glGetUniformLocation(shader->getProgramID(), "uAlpha");
-    GLint uni_tex = glGetUniformLocation(shader->getProgramID(), "uTex");
+    uni_alpha = shader->uniform<float>("uAlpha");
+    Uniform<int> uni_tex = shader->uniform<int>("uTex");
+    if (!uni_alpha.isValid() || !uni_tex.isValid())
+    {
+        ERROR("the lens flare shader does not declare the expected uniforms");
+        exit(1);
+    }
 
     // set the texture uniform now since we will not need to change it later
-    glUseProgram(shader->getProgramID());
-    glUniform1i(uni_tex, 0);
-    glUseProgram(0);
+    GLState::useProgram(shader->getProgramID());
+    uni_tex.set(0);
+    GLState::useProgram(0);
 
     // create a query for occlusion
     query = new Query(GL_SAMPLES_PASSED);
@@ -59,8 +66,8 @@ void LensFlare::Init()
 
 void LensFlare::Cleanup()
 {
-    glDeleteBuffers(1, &VBOid);
-    glDeleteVertexArrays(1, &VAOid);
+    GLState::deleteBuffer(VBOid);
+    GLState::deleteVertexArray(VAOid);
     delete shader;
     delete query;
     initialized = false;
@@ -96,8 +103,8 @@ void LensFlare::render(glm::mat4 const& proj)
     float aspectRatio = 800.f/600.f;
 
     // bind everything
-    glUseProgram(shader->getProgramID());
-    glBindVertexArray(VAOid);
+    GLState::useProgram(shader->getProgramID());
+    GLState::bindVertexArray(VAOid);
 
     // this part is based on ThinMatrix's youtube tutorial (see the Query class)
     if (query->isResultReady())
@@ -110,8 +117,8 @@ void LensFlare::render(glm::mat4 const& proj)
     if (!query->isInUse())
     {
         // disable drawing to anything
-        glColorMask(false,false,false,false);
-        glDepthMask(false);
+        GLState::colorMask(false);
+        GLState::depthMask(false);
 
         query->start();
 
@@ -125,28 +132,27 @@ void LensFlare::render(glm::mat4 const& proj)
 
         float Pos[] = {posTL.x, posTL.y, lightPos.z, posBR.x, posBR.y, lightPos.z, posTR.x, posTR.y, lightPos.z, posTL.x, posTL.y, lightPos.z, posBL.x, posBL.y, lightPos.z, posBR.x, posBR.y, lightPos.z};
 
-        glBindBuffer(GL_ARRAY_BUFFER, VBOid);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, VBOid);
         glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float)*3*6, Pos);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
 
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
         query->end();
 
         // reenable drawing to everything
-        glColorMask(true,true,true,true);
-        glDepthMask(true);
+        GLState::colorMask(true);
+        GLState::depthMask(true);
     }
 
     // Draw on top of everything with an additive blendmode
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_DST_ALPHA);
-    glBlendEquation(GL_ADD);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::enable(GL_BLEND);
+    GLState::blendFunc(GL_SRC_ALPHA, GL_DST_ALPHA);
+    GLState::blendEquation(GL_ADD);
 
     // Set the transparency
     float alpha = occlusion * brightness/2.f;
-    glUniform1f(uni_alpha, alpha);
+    uni_alpha.set(alpha);
 
     // Draw all textures : calculate the vertex positions and update the offset
     for (size_t i = 0; i < textures.size(); i++)
@@ -162,20 +168,19 @@ void LensFlare::render(glm::mat4 const& proj)
 
         float Pos[] = {posTL.x, posTL.y, 1.f, posBR.x, posBR.y, 1.f, posTR.x, posTR.y, 1.f, posTL.x, posTL.y, 1.f, posBL.x, posBL.y, 1.f, posBR.x, posBR.y, 1.f};
 
-        glBindBuffer(GL_ARRAY_BUFFER, VBOid);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, VBOid);
         glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float)*3*6, Pos);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
 
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
-        textures[i]->unbind();
-
         offset += offsetDir * offsetAmmount;
     }
+    if (!textures.empty()) textures.back()->unbind();
 
     // Reset the values and unbind everything
-    glDisable(GL_BLEND);
-    glEnable(GL_DEPTH_TEST);
-    glBindVertexArray(0);
-    glUseProgram(0);
+    GLState::disable(GL_BLEND);
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
+    GLState::useProgram(0);
 }
@@ -3,6 +3,7 @@
 GLint Material::uni_K;
 GLint Material::uni_alpha;
 GLint Material::uni_color;
+uint32_t Material::nextId = 0;
 
 Material::Material(glm::vec3 color, float Ka, float Kd, float Ks, float alpha)
 {
@@ -22,6 +23,22 @@ Material::Material(Texture* tex, float Ka, float Kd, float Ks, float alpha)
     this->alpha = alpha;
 }
 
+Material::Material(Material const& other)
+{
+    *this = other;
+}
+
+Material& Material::operator=(Material const& other)
+{
+    color = other.color;
+    tex = other.tex;
+    Ka = other.Ka;
+    Kd = other.Kd;
+    Ks = other.Ks;
+    alpha = other.alpha;
+    return *this;
+}
+
 void Material::setUniformLocations(GLint uni_K, GLint uni_alpha, GLint uni_color)
 {
     Material::uni_K = uni_K;
@@ -0,0 +1,55 @@
+#include "MergedGeometry.h"
+#include "logger.h"
+#include <cstring>
+
+/* \brief Resize an array of the merged geometry. There is no way to go on without it : exits on failure*/
+template <typename T>
+static T* grow(T* data, uint64_t size)
+{
+    T* grown = (T*)realloc(data, size);
+    if(grown == nullptr)
+    {
+        ERROR("could not grow a merged geometry to %llu bytes\n", (unsigned long long)size);
+        free(data);
+        exit(1);
+    }
+    return grown;
+}
+
+void MergedGeometry::append(const Geometry& g, const glm::mat4& transform)
+{
+    uint32_t first = m_nbVertices;
+    uint32_t count = g.getNbVertices();
+    if(count == 0)
+        return;
+
+    m_vertices = grow(m_vertices, (uint64_t)(first + count)*3*sizeof(float));
+    m_normals  = grow(m_normals,  (uint64_t)(first + count)*3*sizeof(float));
+    m_uvs      = grow(m_uvs,      (uint64_t)(first + count)*2*sizeof(float));
+    m_nbVertices = first + count;
+
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(transform)));
+    const float* vertices = g.getVertices();
+    const float* normals  = g.getNormals();
+    for(uint32_t i = 0; i < count; i++)
+    {
+        glm::vec4 p = transform * glm::vec4(vertices[3*i], vertices[3*i+1], vertices[3*i+2], 1.0f);
+        glm::vec3 n = glm::normalize(normalMatrix * glm::vec3(normals[3*i], normals[3*i+1], normals[3*i+2]));
+
+        float* dstV = m_vertices + 3*(first + i);
+        float* dstN = m_normals  + 3*(first + i);
+        dstV[0] = p.x; dstV[1] = p.y; dstV[2] = p.z;
+        dstN[0] = n.x; dstN[1] = n.y; dstN[2] = n.z;
+    }
+
+    /* The UVs do not depend on the transformation */
+    memcpy(m_uvs + 2*first, g.getUVs(), (uint64_t)count*2*sizeof(float));
+
+    /* The merged geometry is always indexed : a triangle soup gets the trivial indices */
+    uint32_t firstIndex = m_nbIndices;
+    uint32_t nbIndices  = g.isIndexed() ? g.getNbIndices() : count;
+    m_indices   = grow(m_indices, (uint64_t)(firstIndex + nbIndices)*sizeof(uint32_t));
+    m_nbIndices = firstIndex + nbIndices;
+    for(uint32_t i = 0; i < nbIndices; i++)
+        m_indices[firstIndex + i] = first + (g.isIndexed() ? g.getIndices()[i] : i);
+}
@@ -0,0 +1,95 @@
+#include "Mesh.h"
+#include "GLState.h"
+#include <vector>
+
+Mesh::Mesh(const Geometry& g, VertexFormat format) : m_nbVertices(g.getNbVertices()), m_nbIndices(g.getNbIndices()), m_format(format.fit(g))
+{
+    glGenVertexArrays(1, &m_vaoID);
+    GLState::bindVertexArray(m_vaoID);
+
+    /* Interleaved layout : one stream, every attribute of a vertex next to each other */
+    glGenBuffers(1, &m_vboID);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, m_vboID);
+
+        std::vector<uint8_t> vertices((size_t)m_format.getStride() * m_nbVertices);
+        m_format.pack(g, vertices.data());
+        glBufferData(GL_ARRAY_BUFFER, vertices.size(), vertices.data(), GL_STATIC_DRAW);
+
+    /* Indices : 16 bits are enough for most meshes and halve the index buffer */
+    if(g.isIndexed())
+    {
+        glGenBuffers(1, &m_iboID);
+        GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_iboID);
+        if(m_nbVertices <= 0xFFFF)
+        {
+            std::vector<uint16_t> indices(g.getIndices(), g.getIndices() + m_nbIndices);
+            m_indexType = GL_UNSIGNED_SHORT;
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_nbIndices * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+        }
+        else
+        {
+            m_indexType = GL_UNSIGNED_INT;
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_nbIndices * sizeof(uint32_t), g.getIndices(), GL_STATIC_DRAW);
+        }
+    }
+
+    setupAttributes();
+
+    GLState::bindVertexArray(0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+Mesh::~Mesh()
+{
+    GLState::deleteVertexArray(m_vaoID);
+    GLState::deleteBuffer(m_vboID);
+    if(m_iboID != 0)
+        GLState::deleteBuffer(m_iboID);
+}
+
+void Mesh::bind() const
+{
+    GLState::bindVertexArray(m_vaoID);
+}
+
+void Mesh::bindLegacy() const
+{
+    GLState::bindVertexArray(0);
+    setupAttributes();
+}
+
+void Mesh::setupAttributes() const
+{
+    GLState::bindBuffer(GL_ARRAY_BUFFER, m_vboID);
+    m_format.setupAttributes();
+
+    /* Part of the VAO state, like the attributes */
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_iboID);
+}
+
+void Mesh::unbind() const
+{
+    GLState::bindVertexArray(0);
+}
+
+void Mesh::draw() const
+{
+    if(m_iboID != 0)
+        glDrawElements(GL_TRIANGLES, m_nbIndices, m_indexType, 0);
+    else
+        glDrawArrays(GL_TRIANGLES, 0, m_nbVertices);
+}
+
+void Mesh::drawInstanced(GLsizei count) const
+{
+    if(m_iboID != 0)
+        glDrawElementsInstanced(GL_TRIANGLES, m_nbIndices, m_indexType, 0, count);
+    else
+        glDrawArraysInstanced(GL_TRIANGLES, 0, m_nbVertices, count);
+}
+
+size_t Mesh::getGPUSize() const
+{
+    size_t indexSize = m_indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+    return (size_t)m_nbVertices * m_format.getStride() + (m_iboID != 0 ? m_nbIndices * indexSize : 0);
+}
@@ -0,0 +1,128 @@
+#include "MeshRegistry.h"
+#include "logger.h"
+#include <cstring>
+
+std::unordered_multimap<uint64_t, MeshRegistry::Entry> MeshRegistry::entries;
+size_t MeshRegistry::residentSize = 0;
+size_t MeshRegistry::uploadedSize = 0;
+size_t MeshRegistry::requestedSize = 0;
+
+namespace {
+
+// the content of a geometry, as the pieces of memory that tell it apart
+struct Content {
+    uint32_t counts[2];
+    uint8_t encodings[3];
+    const void* data[6];
+    size_t size[6];
+
+    Content(Geometry const& g, VertexFormat format)
+        : counts{g.getNbVertices(), g.getNbIndices()}, encodings{(uint8_t)format.position, (uint8_t)format.normal, (uint8_t)format.uv},
+          data{counts, encodings, g.getVertices(), g.getNormals(), g.getUVs(), g.getIndices()},
+          size{sizeof(counts), sizeof(encodings), 3 * sizeof(float) * g.getNbVertices(), 3 * sizeof(float) * g.getNbVertices(),
+               2 * sizeof(float) * g.getNbVertices(), g.isIndexed() ? sizeof(uint32_t) * g.getNbIndices() : 0}
+    {
+    }
+
+    // FNV-1a
+    uint64_t hash() const
+    {
+        uint64_t h = 0xcbf29ce484222325ull;
+        for (int k = 0; k < 6; k++)
+        {
+            const uint8_t* bytes = (const uint8_t*)data[k];
+            for (size_t i = 0; i < size[k]; i++)
+            {
+                h ^= bytes[i];
+                h *= 0x100000001b3ull;
+            }
+        }
+        return h;
+    }
+
+    bool operator==(std::vector<uint8_t> const& copy) const
+    {
+        size_t offset = 0;
+        for (int k = 0; k < 6; k++)
+        {
+            if (offset + size[k] > copy.size()) return false;
+            if (size[k] > 0 && memcmp(copy.data() + offset, data[k], size[k]) != 0) return false;
+            offset += size[k];
+        }
+        return offset == copy.size();
+    }
+
+    std::vector<uint8_t> copy() const
+    {
+        std::vector<uint8_t> bytes;
+        for (int k = 0; k < 6; k++) bytes.insert(bytes.end(), (const uint8_t*)data[k], (const uint8_t*)data[k] + size[k]);
+        return bytes;
+    }
+};
+
+}
+
+MeshHandle MeshRegistry::acquire(Geometry const& g, VertexFormat format)
+{
+    Content content(g, format);
+    uint64_t key = content.hash();
+    auto range = entries.equal_range(key);
+    auto it = range.first;
+    while (it != range.second && !(content == it->second.content)) ++it;
+    if (it == range.second)
+    {
+        Mesh* mesh = new Mesh(g, format);
+        residentSize += mesh->getGPUSize();
+        uploadedSize += mesh->getGPUSize();
+        it = entries.insert({key, {key, mesh, 0, content.copy()}});
+    }
+    requestedSize += it->second.mesh->getGPUSize();
+    return MeshHandle(&it->second);
+}
+
+void MeshRegistry::release(Entry* e)
+{
+    if (--e->refs > 0) return;
+
+    residentSize -= e->mesh->getGPUSize();
+    delete e->mesh;
+    auto range = entries.equal_range(e->key);
+    for (auto it = range.first; it != range.second; ++it)
+        if (&it->second == e)
+        {
+            entries.erase(it);
+            break;
+        }
+}
+
+void MeshRegistry::report()
+{
+    INFO("meshes : %zu uploaded (%zu bytes of vertices and indices), %zu bytes uploaded since the start instead of %zu (%zu saved by sharing)\n",
+         entries.size(), residentSize, uploadedSize, requestedSize, requestedSize - uploadedSize);
+}
+
+MeshHandle::MeshHandle(MeshRegistry::Entry* e) : entry(e)
+{
+    entry->refs++;
+}
+
+MeshHandle::MeshHandle(MeshHandle const& h) : entry(h.entry)
+{
+    if (entry != nullptr) entry->refs++;
+}
+
+MeshHandle::MeshHandle(MeshHandle&& h) noexcept : entry(h.entry)
+{
+    h.entry = nullptr;
+}
+
+MeshHandle& MeshHandle::operator=(MeshHandle h)
+{
+    std::swap(entry, h.entry);
+    return *this;
+}
+
+MeshHandle::~MeshHandle()
+{
+    if (entry != nullptr) MeshRegistry::release(entry);
+}
@@ -0,0 +1,114 @@
+#include "NameTable.h"
+#include <cstring>
+
+uint32_t NameTable::hash(const char* prefix, size_t prefixLength, const char* name, size_t length)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < prefixLength; i++)
+    {
+        h ^= (uint8_t)prefix[i];
+        h *= 16777619u;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        h ^= (uint8_t)name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+bool NameTable::equals(uint32_t offset, const char* prefix, size_t prefixLength, const char* name, size_t length) const
+{
+    // strncmp stops at the end of the name kept : it never reads after it
+    const char* s = get(offset);
+    return (prefixLength == 0 || strncmp(s, prefix, prefixLength) == 0)
+        && (length == 0 || strncmp(s + prefixLength, name, length) == 0) && s[prefixLength + length] == '\0';
+}
+
+void NameTable::reserve(uint32_t nbNames, size_t nbChars)
+{
+    chars.reserve(chars.size() + nbChars);
+    if (4 * (uint64_t)(nbUsed + nbNames) <= 3 * (uint64_t)slots.size()) return;
+    uint32_t nbSlots = 16;
+    while (4 * (uint64_t)(this->nbNames + nbNames) > 3 * (uint64_t)nbSlots) nbSlots *= 2;
+    rehash(nbSlots);
+}
+
+uint32_t NameTable::add(const char* prefix, size_t prefixLength, const char* name, size_t length, PoolHandle handle)
+{
+    // full : at most 3/8 used once rebuilt, so that the next rebuild is as many names away
+    if (4 * (uint64_t)(nbUsed + 1) > 3 * (uint64_t)slots.size())
+    {
+        uint32_t nbSlots = 16;
+        while (8 * (uint64_t)(nbNames + 1) > 3 * (uint64_t)nbSlots) nbSlots *= 2;
+        rehash(nbSlots);
+    }
+
+    // linear probing : the name is not there if an empty slot comes first, it then goes in the first free slot met
+    uint32_t h = hash(prefix, prefixLength, name, length), mask = (uint32_t)slots.size() - 1, free = NONE;
+    for (uint32_t i = h & mask;; i = (i + 1) & mask)
+    {
+        Slot const& s = slots[i];
+        if (s.offset == NONE)
+        {
+            if (free == NONE) free = i;
+            break;
+        }
+        if (s.offset == REMOVED)
+        {
+            if (free == NONE) free = i;
+        }
+        else if (s.hash == h && equals(s.offset, prefix, prefixLength, name, length)) return NONE;
+    }
+
+    Slot& s = slots[free];
+    if (s.offset == NONE) nbUsed++;
+    s.offset = (uint32_t)chars.size();
+    s.hash = h;
+    s.handle = handle;
+    chars.insert(chars.end(), prefix, prefix + prefixLength);
+    chars.insert(chars.end(), name, name + length);
+    chars.push_back('\0');
+    nbNames++;
+    return s.offset;
+}
+
+PoolHandle NameTable::find(const char* name, size_t length) const
+{
+    if (slots.empty()) return PoolHandle();
+    uint32_t h = hash(name, length, nullptr, 0), mask = (uint32_t)slots.size() - 1;
+    for (uint32_t i = h & mask; slots[i].offset != NONE; i = (i + 1) & mask)
+    {
+        Slot const& s = slots[i];
+        if (s.offset != REMOVED && s.hash == h && equals(s.offset, name, length, nullptr, 0)) return s.handle;
+    }
+    return PoolHandle();
+}
+
+void NameTable::remove(uint32_t offset)
+{
+    const char* name = get(offset);
+    uint32_t h = hash(name, strlen(name), nullptr, 0), mask = (uint32_t)slots.size() - 1;
+    for (uint32_t i = h & mask; slots[i].offset != NONE; i = (i + 1) & mask)
+    {
+        if (slots[i].offset != offset) continue;
+        slots[i].offset = REMOVED; // still used : the probes of the names after it go on through it
+        nbNames--;
+        return;
+    }
+}
+
+void NameTable::rehash(uint32_t nbSlots)
+{
+    std::vector<Slot> old(nbSlots);
+    old.swap(slots);
+    uint32_t mask = nbSlots - 1;
+    for (Slot const& s : old)
+    {
+        if (s.offset == NONE || s.offset == REMOVED) continue;
+        uint32_t i = s.hash & mask;
+        while (slots[i].offset != NONE) i = (i + 1) & mask;
+        slots[i] = s;
+    }
+    nbUsed = nbNames;
+}
@@ -0,0 +1,309 @@
+#include "NarrowPhase.h"
+#include <cmath>
+#include <cstring>
+
+// No fused multiply-add : every path rounds each product and each sum, so that they all find the same contacts,
+// and the same times, bit for bit (a contraction moves the balls at exactly the distance from one side to the other)
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define NARROW_SSE
+#define NARROW_AVX
+#define TARGET(t) __attribute__((target(t)))
+#elif defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define NARROW_SSE
+#define TARGET(t)
+#endif
+
+namespace {
+
+uint32_t bitCount(uint32_t v)
+{
+    uint32_t n = 0;
+    for (; v != 0; v &= v - 1) n++;
+    return n;
+}
+
+// the balls from begin, one by one : the scalar path, and the last ones of SSE
+uint32_t contactsScalar(glm::vec2 p, const float* x, const float* z, uint32_t begin, uint32_t count, float d2, uint32_t* mask)
+{
+    uint32_t n = 0;
+    for (uint32_t k = begin; k < count; k++)
+    {
+        float dx = x[k] - p.x, dz = z[k] - p.y;
+        if (dx * dx + dz * dz < d2)
+        {
+            mask[k >> 5] |= 1u << (k & 31);
+            n++;
+        }
+    }
+    return n;
+}
+
+// |c + b t| = d for the first time : a t^2 + 2 b t + c = 0 (a = b.b, b = c.b, c = c.c - d^2), approaching (b < 0).
+// The smaller root written c / (sqrt(b^2 - a c) - b), without cancellation
+void impactsScalar(glm::vec2 p, glm::vec2 v, const float* x, const float* z, const float* vx, const float* vz,
+                   uint32_t begin, uint32_t count, float d2, float horizon, float* times)
+{
+    for (uint32_t k = begin; k < count; k++)
+    {
+        float cx = x[k] - p.x, cz = z[k] - p.y;
+        float bx = vx[k] - v.x, bz = vz[k] - v.y;
+        float a = bx * bx + bz * bz, b = cx * bx + cz * bz, c = cx * cx + cz * cz - d2;
+        float disc = b * b - a * c;
+        float t = INFINITY;
+        if (b < 0.f && c <= 0.f) t = 0.f;
+        else if (b < 0.f && disc >= 0.f)
+        {
+            float root = c / (sqrtf(disc) - b);
+            if (root <= horizon) t = root;
+        }
+        times[k] = t;
+    }
+}
+
+#if defined(NARROW_SSE)
+TARGET("sse")
+uint32_t contactsSSE(glm::vec2 p, const float* x, const float* z, uint32_t count, float d2, uint32_t* mask)
+{
+    const __m128 px = _mm_set1_ps(p.x), pz = _mm_set1_ps(p.y), dist2 = _mm_set1_ps(d2);
+    uint32_t k = 0, n = 0;
+    for (; k + 4 <= count; k += 4)
+    {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + k), px);
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(z + k), pz);
+        __m128 l2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+        uint32_t m = (uint32_t)_mm_movemask_ps(_mm_cmplt_ps(l2, dist2));
+        mask[k >> 5] |= m << (k & 31);
+        n += bitCount(m);
+    }
+    return n + contactsScalar(p, x, z, k, count, d2, mask);
+}
+
+TARGET("sse")
+void impactsSSE(glm::vec2 p, glm::vec2 v, const float* x, const float* z, const float* vx, const float* vz,
+                uint32_t count, float d2, float horizon, float* times)
+{
+    const __m128 px = _mm_set1_ps(p.x), pz = _mm_set1_ps(p.y), pvx = _mm_set1_ps(v.x), pvz = _mm_set1_ps(v.y);
+    const __m128 dist2 = _mm_set1_ps(d2), h = _mm_set1_ps(horizon), zero = _mm_setzero_ps(), inf = _mm_set1_ps(INFINITY);
+    uint32_t k = 0;
+    for (; k + 4 <= count; k += 4)
+    {
+        __m128 cx = _mm_sub_ps(_mm_loadu_ps(x + k), px), cz = _mm_sub_ps(_mm_loadu_ps(z + k), pz);
+        __m128 bx = _mm_sub_ps(_mm_loadu_ps(vx + k), pvx), bz = _mm_sub_ps(_mm_loadu_ps(vz + k), pvz);
+        __m128 a = _mm_add_ps(_mm_mul_ps(bx, bx), _mm_mul_ps(bz, bz));
+        __m128 b = _mm_add_ps(_mm_mul_ps(cx, bx), _mm_mul_ps(cz, bz));
+        __m128 c = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cz, cz)), dist2);
+        __m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, c));
+        __m128 root = _mm_div_ps(c, _mm_sub_ps(_mm_sqrt_ps(_mm_max_ps(disc, zero)), b));
+
+        __m128 approaching = _mm_cmplt_ps(b, zero);
+        __m128 touching = _mm_and_ps(approaching, _mm_cmple_ps(c, zero));
+        __m128 hit = _mm_and_ps(approaching, _mm_and_ps(_mm_cmpge_ps(disc, zero), _mm_cmple_ps(root, h)));
+        __m128 t = _mm_or_ps(_mm_and_ps(hit, root), _mm_andnot_ps(hit, inf));
+        _mm_storeu_ps(times + k, _mm_andnot_ps(touching, t)); // 0 where touching
+    }
+    impactsScalar(p, v, x, z, vx, vz, k, count, d2, horizon, times);
+}
+#endif
+
+#if defined(NARROW_AVX)
+// the lanes of the balls from k : all of them, or those before count for the last ones
+TARGET("avx2")
+__m256i lanesAVX2(uint32_t k, uint32_t count)
+{
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32((int)(count - k)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+TARGET("avx2")
+uint32_t contactsAVX2(glm::vec2 p, const float* x, const float* z, uint32_t count, float d2, uint32_t* mask)
+{
+    const __m256 px = _mm256_set1_ps(p.x), pz = _mm256_set1_ps(p.y), dist2 = _mm256_set1_ps(d2);
+    uint32_t n = 0;
+    for (uint32_t k = 0; k < count; k += 8)
+    {
+        __m256i lanes = lanesAVX2(k, count);
+        __m256 dx = _mm256_sub_ps(_mm256_maskload_ps(x + k, lanes), px);
+        __m256 dz = _mm256_sub_ps(_mm256_maskload_ps(z + k, lanes), pz);
+        __m256 l2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dz, dz));
+        __m256 in = _mm256_and_ps(_mm256_cmp_ps(l2, dist2, _CMP_LT_OQ), _mm256_castsi256_ps(lanes));
+        uint32_t m = (uint32_t)_mm256_movemask_ps(in);
+        mask[k >> 5] |= m << (k & 31);
+        n += bitCount(m);
+    }
+    return n;
+}
+
+TARGET("avx2")
+void impactsAVX2(glm::vec2 p, glm::vec2 v, const float* x, const float* z, const float* vx, const float* vz,
+                 uint32_t count, float d2, float horizon, float* times)
+{
+    const __m256 px = _mm256_set1_ps(p.x), pz = _mm256_set1_ps(p.y), pvx = _mm256_set1_ps(v.x), pvz = _mm256_set1_ps(v.y);
+    const __m256 dist2 = _mm256_set1_ps(d2), h = _mm256_set1_ps(horizon), zero = _mm256_setzero_ps(), inf = _mm256_set1_ps(INFINITY);
+    for (uint32_t k = 0; k < count; k += 8)
+    {
+        __m256i lanes = lanesAVX2(k, count);
+        __m256 cx = _mm256_sub_ps(_mm256_maskload_ps(x + k, lanes), px), cz = _mm256_sub_ps(_mm256_maskload_ps(z + k, lanes), pz);
+        __m256 bx = _mm256_sub_ps(_mm256_maskload_ps(vx + k, lanes), pvx), bz = _mm256_sub_ps(_mm256_maskload_ps(vz + k, lanes), pvz);
+        __m256 a = _mm256_add_ps(_mm256_mul_ps(bx, bx), _mm256_mul_ps(bz, bz));
+        __m256 b = _mm256_add_ps(_mm256_mul_ps(cx, bx), _mm256_mul_ps(cz, bz));
+        __m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(cx, cx), _mm256_mul_ps(cz, cz)), dist2);
+        __m256 disc = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(a, c));
+        __m256 root = _mm256_div_ps(c, _mm256_sub_ps(_mm256_sqrt_ps(_mm256_max_ps(disc, zero)), b));
+
+        __m256 approaching = _mm256_cmp_ps(b, zero, _CMP_LT_OQ);
+        __m256 touching = _mm256_and_ps(approaching, _mm256_cmp_ps(c, zero, _CMP_LE_OQ));
+        __m256 hit = _mm256_and_ps(approaching, _mm256_and_ps(_mm256_cmp_ps(disc, zero, _CMP_GE_OQ), _mm256_cmp_ps(root, h, _CMP_LE_OQ)));
+        __m256 t = _mm256_blendv_ps(inf, root, hit);
+        _mm256_maskstore_ps(times + k, lanes, _mm256_blendv_ps(t, zero, touching));
+    }
+}
+
+TARGET("avx512f")
+__mmask16 lanesAVX512(uint32_t k, uint32_t count)
+{
+    return count - k >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << (count - k)) - 1);
+}
+
+TARGET("avx512f")
+uint32_t contactsAVX512(glm::vec2 p, const float* x, const float* z, uint32_t count, float d2, uint32_t* mask)
+{
+    const __m512 px = _mm512_set1_ps(p.x), pz = _mm512_set1_ps(p.y), dist2 = _mm512_set1_ps(d2);
+    uint32_t n = 0;
+    for (uint32_t k = 0; k < count; k += 16)
+    {
+        __mmask16 lanes = lanesAVX512(k, count);
+        __m512 dx = _mm512_sub_ps(_mm512_maskz_loadu_ps(lanes, x + k), px);
+        __m512 dz = _mm512_sub_ps(_mm512_maskz_loadu_ps(lanes, z + k), pz);
+        __m512 l2 = _mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dz, dz));
+        uint32_t m = (uint32_t)_mm512_mask_cmp_ps_mask(lanes, l2, dist2, _CMP_LT_OQ);
+        mask[k >> 5] |= m << (k & 31);
+        n += bitCount(m);
+    }
+    return n;
+}
+
+TARGET("avx512f")
+void impactsAVX512(glm::vec2 p, glm::vec2 v, const float* x, const float* z, const float* vx, const float* vz,
+                   uint32_t count, float d2, float horizon, float* times)
+{
+    const __m512 px = _mm512_set1_ps(p.x), pz = _mm512_set1_ps(p.y), pvx = _mm512_set1_ps(v.x), pvz = _mm512_set1_ps(v.y);
+    const __m512 dist2 = _mm512_set1_ps(d2), h = _mm512_set1_ps(horizon), zero = _mm512_setzero_ps(), inf = _mm512_set1_ps(INFINITY);
+    for (uint32_t k = 0; k < count; k += 16)
+    {
+        __mmask16 lanes = lanesAVX512(k, count);
+        __m512 cx = _mm512_sub_ps(_mm512_maskz_loadu_ps(lanes, x + k), px), cz = _mm512_sub_ps(_mm512_maskz_loadu_ps(lanes, z + k), pz);
+        __m512 bx = _mm512_sub_ps(_mm512_maskz_loadu_ps(lanes, vx + k), pvx), bz = _mm512_sub_ps(_mm512_maskz_loadu_ps(lanes, vz + k), pvz);
+        __m512 a = _mm512_add_ps(_mm512_mul_ps(bx, bx), _mm512_mul_ps(bz, bz));
+        __m512 b = _mm512_add_ps(_mm512_mul_ps(cx, bx), _mm512_mul_ps(cz, bz));
+        __m512 c = _mm512_sub_ps(_mm512_add_ps(_mm512_mul_ps(cx, cx), _mm512_mul_ps(cz, cz)), dist2);
+        __m512 disc = _mm512_sub_ps(_mm512_mul_ps(b, b), _mm512_mul_ps(a, c));
+
+        __mmask16 approaching = _mm512_mask_cmp_ps_mask(lanes, b, zero, _CMP_LT_OQ);
+        __mmask16 real = _mm512_mask_cmp_ps_mask(approaching, disc, zero, _CMP_GE_OQ);
+        __m512 root = _mm512_div_ps(c, _mm512_sub_ps(_mm512_maskz_sqrt_ps(real, disc), b));
+        __mmask16 touching = _mm512_mask_cmp_ps_mask(approaching, c, zero, _CMP_LE_OQ);
+        __mmask16 hit = _mm512_mask_cmp_ps_mask(real, root, h, _CMP_LE_OQ);
+        __m512 t = _mm512_mask_blend_ps(hit, inf, root);
+        _mm512_mask_storeu_ps(times + k, lanes, _mm512_mask_blend_ps(touching, t, zero));
+    }
+}
+#endif
+
+NarrowPhase::Path detect()
+{
+#if defined(NARROW_AVX)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return NarrowPhase::Path::AVX512;
+    if (__builtin_cpu_supports("avx2")) return NarrowPhase::Path::AVX2;
+    if (__builtin_cpu_supports("sse")) return NarrowPhase::Path::SSE;
+    return NarrowPhase::Path::Scalar;
+#elif defined(NARROW_SSE)
+    return NarrowPhase::Path::SSE;
+#else
+    return NarrowPhase::Path::Scalar;
+#endif
+}
+
+const NarrowPhase::Path best = detect();
+NarrowPhase::Path current = best;
+
+}
+
+uint32_t NarrowPhase::contacts(glm::vec2 p, const float* x, const float* z, uint32_t count, float distance, uint32_t* mask)
+{
+    memset(mask, 0, ((count + 31) / 32) * sizeof(uint32_t));
+    float d2 = distance * distance;
+    switch (current)
+    {
+#if defined(NARROW_AVX)
+        case Path::AVX512: return contactsAVX512(p, x, z, count, d2, mask);
+        case Path::AVX2: return contactsAVX2(p, x, z, count, d2, mask);
+#endif
+#if defined(NARROW_SSE)
+        case Path::SSE: return contactsSSE(p, x, z, count, d2, mask);
+#endif
+        default: return contactsScalar(p, x, z, 0, count, d2, mask);
+    }
+}
+
+float NarrowPhase::impacts(glm::vec2 p, glm::vec2 v, const float* x, const float* z, const float* vx, const float* vz,
+                           uint32_t count, float distance, float horizon, float* times, uint32_t& first)
+{
+    float d2 = distance * distance;
+    switch (current)
+    {
+#if defined(NARROW_AVX)
+        case Path::AVX512: impactsAVX512(p, v, x, z, vx, vz, count, d2, horizon, times); break;
+        case Path::AVX2: impactsAVX2(p, v, x, z, vx, vz, count, d2, horizon, times); break;
+#endif
+#if defined(NARROW_SSE)
+        case Path::SSE: impactsSSE(p, v, x, z, vx, vz, count, d2, horizon, times); break;
+#endif
+        default: impactsScalar(p, v, x, z, vx, vz, 0, count, d2, horizon, times); break;
+    }
+
+    float earliest = INFINITY;
+    first = NONE;
+    for (uint32_t k = 0; k < count; k++)
+    {
+        if (times[k] < earliest)
+        {
+            earliest = times[k];
+            first = k;
+        }
+    }
+    return earliest;
+}
+
+NarrowPhase::Path NarrowPhase::getBestPath()
+{
+    return best;
+}
+
+NarrowPhase::Path NarrowPhase::getPath()
+{
+    return current;
+}
+
+void NarrowPhase::setPath(Path path)
+{
+    current = path <= best ? path : best;
+}
+
+const char* NarrowPhase::getName(Path path)
+{
+    switch (path)
+    {
+        case Path::AVX512: return "avx512";
+        case Path::AVX2: return "avx2";
+        case Path::SSE: return "sse";
+        default: return "scalar";
+    }
+}
@@ -0,0 +1,115 @@
+#include "RayCandidates.h"
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define RAY_SSE
+#endif
+
+void RayCandidates::clear()
+{
+    sphereIds.clear();
+    sx.clear(); sy.clear(); sz.clear(); sr.clear();
+    boxIds.clear();
+    ox.clear(); oy.clear(); oz.clear();
+    ix.clear(); iy.clear(); iz.clear();
+    minX.clear(); minY.clear(); minZ.clear();
+    maxX.clear(); maxY.clear(); maxZ.clear();
+}
+
+void RayCandidates::addSphere(uint32_t id, glm::vec3 const& center, float radius)
+{
+    sphereIds.push_back(id);
+    sx.push_back(center.x); sy.push_back(center.y); sz.push_back(center.z); sr.push_back(radius);
+}
+
+void RayCandidates::addBox(uint32_t id, AABB const& box, glm::vec3 const& origin, glm::vec3 const& dir)
+{
+    boxIds.push_back(id);
+    ox.push_back(origin.x); oy.push_back(origin.y); oz.push_back(origin.z);
+    ix.push_back(1.f / dir.x); iy.push_back(1.f / dir.y); iz.push_back(1.f / dir.z);
+    minX.push_back(box.min.x); minY.push_back(box.min.y); minZ.push_back(box.min.z);
+    maxX.push_back(box.max.x); maxY.push_back(box.max.y); maxZ.push_back(box.max.z);
+}
+
+bool RayCandidates::closest(Ray const& ray, uint32_t& id, float& t) const
+{
+    float best = INFINITY;
+    uint32_t bestId = 0;
+    auto keep = [&](float d, uint32_t candidate) { if (d < best) { best = d; bestId = candidate; } };
+
+    // spheres : |o + t d - c|^2 = r^2 with |d| = 1, the far root if the origin is inside
+    uint32_t n = (uint32_t)sphereIds.size(), i = 0;
+#ifdef RAY_SSE
+    __m128 rox = _mm_set1_ps(ray.origin.x), roy = _mm_set1_ps(ray.origin.y), roz = _mm_set1_ps(ray.origin.z);
+    __m128 rdx = _mm_set1_ps(ray.dir.x), rdy = _mm_set1_ps(ray.dir.y), rdz = _mm_set1_ps(ray.dir.z);
+    __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 ocx = _mm_sub_ps(rox, _mm_loadu_ps(&sx[i]));
+        __m128 ocy = _mm_sub_ps(roy, _mm_loadu_ps(&sy[i]));
+        __m128 ocz = _mm_sub_ps(roz, _mm_loadu_ps(&sz[i]));
+        __m128 r = _mm_loadu_ps(&sr[i]);
+        __m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ocx, rdx), _mm_mul_ps(ocy, rdy)), _mm_mul_ps(ocz, rdz));
+        __m128 c = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ocx, ocx), _mm_mul_ps(ocy, ocy)), _mm_mul_ps(ocz, ocz)), _mm_mul_ps(r, r));
+        __m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), c);
+        __m128 sq = _mm_sqrt_ps(_mm_max_ps(disc, zero));
+        __m128 t0 = _mm_sub_ps(_mm_sub_ps(zero, b), sq);
+        __m128 t1 = _mm_add_ps(_mm_sub_ps(zero, b), sq);
+        __m128 near = _mm_cmpge_ps(t0, zero);
+        __m128 d = _mm_or_ps(_mm_and_ps(near, t0), _mm_andnot_ps(near, t1));
+        int hit = _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(disc, zero), _mm_cmpge_ps(d, zero)));
+        if (hit == 0) continue;
+
+        alignas(16) float ds[4];
+        _mm_store_ps(ds, d);
+        for (int k = 0; k < 4; k++)
+            if (hit & (1 << k)) keep(ds[k], sphereIds[i + k]);
+    }
+#endif
+    for (; i < n; i++)
+    {
+        glm::vec3 oc = ray.origin - glm::vec3(sx[i], sy[i], sz[i]);
+        float b = glm::dot(oc, ray.dir);
+        float disc = b * b - (glm::dot(oc, oc) - sr[i] * sr[i]);
+        if (disc < 0.f) continue;
+        float sq = sqrtf(disc);
+        float d = -b - sq >= 0.f ? -b - sq : -b + sq;
+        if (d >= 0.f) keep(d, sphereIds[i]);
+    }
+
+    // boxes : slab test in the space of each box, 0 if the origin is inside
+    n = (uint32_t)boxIds.size();
+    i = 0;
+#ifdef RAY_SSE
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 px = _mm_loadu_ps(&ox[i]), py = _mm_loadu_ps(&oy[i]), pz = _mm_loadu_ps(&oz[i]);
+        __m128 qx = _mm_loadu_ps(&ix[i]), qy = _mm_loadu_ps(&iy[i]), qz = _mm_loadu_ps(&iz[i]);
+        __m128 ax = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&minX[i]), px), qx), bx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&maxX[i]), px), qx);
+        __m128 ay = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&minY[i]), py), qy), by = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&maxY[i]), py), qy);
+        __m128 az = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&minZ[i]), pz), qz), bz = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&maxZ[i]), pz), qz);
+        __m128 enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(ax, bx), _mm_min_ps(ay, by)), _mm_min_ps(az, bz));
+        __m128 exit  = _mm_min_ps(_mm_min_ps(_mm_max_ps(ax, bx), _mm_max_ps(ay, by)), _mm_max_ps(az, bz));
+        __m128 d = _mm_max_ps(enter, _mm_setzero_ps());
+        int hit = _mm_movemask_ps(_mm_cmpge_ps(exit, d));
+        if (hit == 0) continue;
+
+        alignas(16) float ds[4];
+        _mm_store_ps(ds, d);
+        for (int k = 0; k < 4; k++)
+            if (hit & (1 << k)) keep(ds[k], boxIds[i + k]);
+    }
+#endif
+    for (; i < n; i++)
+    {
+        AABB box{glm::vec3(minX[i], minY[i], minZ[i]), glm::vec3(maxX[i], maxY[i], maxZ[i])};
+        float d;
+        if (box.intersects(glm::vec3(ox[i], oy[i], oz[i]), glm::vec3(ix[i], iy[i], iz[i]), d)) keep(d, boxIds[i]);
+    }
+
+    if (best == INFINITY) return false;
+    id = bestId;
+    t = best;
+    return true;
+}
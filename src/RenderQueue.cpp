@@ -0,0 +1,128 @@
+#include "RenderQueue.h"
+#include "GLState.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+RenderQueue::RenderQueue(DepthOrder order, float farPlane) : order(order), farPlane(farPlane) {}
+
+void RenderQueue::begin(FrameData const& frame)
+{
+    this->frame = frame;
+    items.clear();
+    entries.clear();
+}
+
+void RenderQueue::push(DrawItem const& item)
+{
+    entries.push_back({makeKey(item), (uint32_t)items.size()});
+    items.push_back(item);
+}
+
+uint64_t RenderQueue::makeKey(DrawItem const& item) const
+{
+    // view space depth of the object origin, quantized on 24 bits
+    float z = -(frame.view * item.model[3]).z;
+    float d = glm::clamp(z / farPlane, 0.f, 1.f);
+    uint64_t depth = (uint64_t)(d * 0xFFFFFF);
+
+    uint64_t program  = item.program->getProgramID() & 0xFF;
+    uint64_t texture  = item.mtl->getTexture() != nullptr ? item.mtl->getTexture()->getID() & 0xFFF : 0;
+    uint64_t material = item.mtl->getId() & 0xFFF;
+    uint64_t mesh     = item.mesh->getVAO() & 0xFF;
+    uint64_t state    = (program << 32) | (texture << 20) | (material << 8) | mesh;
+
+    if (order == DepthOrder::FrontToBack)
+        return (state << 24) | depth;
+    return ((0xFFFFFF - depth) << 40) | state;
+}
+
+void RenderQueue::sort()
+{
+    // LSD radix sort, 8 bits per pass. All the histograms are built in one go,
+    // and a pass is skipped when every key has the same byte (the common case for the state bits)
+    size_t n = entries.size();
+    if (n < 2) return;
+
+    uint32_t histograms[8][256] = {};
+    for (size_t i = 0; i < n; i++)
+        for (int b = 0; b < 8; b++)
+            histograms[b][(entries[i].key >> (8 * b)) & 0xFF]++;
+
+    scratch.resize(n);
+    for (int b = 0; b < 8; b++)
+    {
+        uint32_t* h = histograms[b];
+        if (h[(entries[0].key >> (8 * b)) & 0xFF] == n) continue;
+
+        uint32_t offsets[256];
+        uint32_t sum = 0;
+        for (int i = 0; i < 256; i++)
+        {
+            offsets[i] = sum;
+            sum += h[i];
+        }
+        for (size_t i = 0; i < n; i++)
+            scratch[offsets[(entries[i].key >> (8 * b)) & 0xFF]++] = entries[i];
+        entries.swap(scratch);
+    }
+}
+
+void RenderQueue::submit(UniformRing& objects)
+{
+    // every per draw uniform of the frame goes to the GPU in one mapped write
+    offsets.resize(entries.size());
+    objects.begin(entries.size());
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        DrawItem const& item = items[entries[i].index];
+        ObjectBlock block;
+        block.model = item.model;
+        for (int c = 0; c < 3; c++)
+            block.invModel3x3[c] = glm::vec4(item.invModel3x3[c], 0.f);
+        block.mtlColor = glm::vec4(item.mtl->getColor(), 0.f);
+        block.mtlCts   = item.mtl->getCoefs();
+        offsets[i] = objects.push(&block);
+    }
+    objects.end();
+
+    const ShadingProgram* program = nullptr;
+    const Mesh* mesh = nullptr;
+    GLuint texture = ~0u;
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        DrawItem const& item = items[entries[i].index];
+
+        if (item.program != program)
+        {
+            program = item.program;
+            GLState::useProgram(program->getProgramID());
+        }
+
+        Texture* tex = item.mtl->getTexture();
+        GLuint texID = tex != nullptr ? tex->getID() : 0;
+        if (texID != texture)
+        {
+            texture = texID;
+            if (tex != nullptr) tex->bind();
+            else
+            {
+                GLState::activeTexture(GL_TEXTURE0);
+                GLState::bindTexture(GL_TEXTURE_2D, 0);
+            }
+        }
+
+        if (legacyAttribs) item.mesh->bindLegacy();
+        else if (item.mesh != mesh) item.mesh->bind();
+        mesh = item.mesh;
+
+        objects.bind(offsets[i]);
+        item.mesh->draw();
+    }
+
+    // leave a clean state behind
+    if (mesh != nullptr) mesh->unbind();
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
+    GLState::useProgram(0);
+}
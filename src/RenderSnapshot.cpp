@@ -0,0 +1,27 @@
+#include "RenderSnapshot.h"
+
+void RenderFrame::submit(RenderQueue& queue) const
+{
+    for (DrawItem const& item : items) queue.push(item);
+    for (Instance const& i : instances) i.batch->push(i.model, i.color, i.layer);
+}
+
+RenderFrame& RenderSnapshot::beginWrite()
+{
+    frames[writing].clear();
+    return frames[writing];
+}
+
+void RenderSnapshot::publish()
+{
+    frames[writing].number = ++nbPublished;
+    // release : the reader that takes this frame sees everything written in it
+    writing = ready.exchange(writing | FRESH, std::memory_order_acq_rel) & ~FRESH;
+}
+
+RenderFrame const& RenderSnapshot::acquire()
+{
+    if (ready.load(std::memory_order_relaxed) & FRESH)
+        reading = ready.exchange(reading, std::memory_order_acq_rel) & ~FRESH;
+    return frames[reading];
+}
@@ -0,0 +1,18 @@
+#include "RenderSystem.h"
+
+void RenderSystem::sync(World& world, Scene& scene)
+{
+    world.each<TransformComponent, MeshComponent>([&](Entity, TransformComponent& t, MeshComponent& m) {
+        if (t.moved) scene.partSetMatrices(m.node, t.getPropagate(), t.getSelf());
+    });
+    world.each<MeshComponent, MaterialComponent>([&](Entity, MeshComponent& m, MaterialComponent& mat) {
+        scene.partSetMaterial(m.node, mat.material);
+    });
+    world.each<TransformComponent, LightComponent>([](Entity, TransformComponent& t, LightComponent& l) {
+        if (t.moved) l.light->setPosition(t.position);
+    });
+
+    world.eachArray<TransformComponent>([](uint32_t count, TransformComponent* t) {
+        for (uint32_t i = 0; i < count; i++) t[i].moved = false;
+    });
+}
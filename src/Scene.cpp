@@ -5,96 +5,494 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/fwd.hpp>
 #include <GL/glew.h>
+#include <algorithm>
+#include <cstring>
 
-std::stack<glm::mat4> SceneNode::matrices;
-
-SceneNode::SceneNode(Geometry* g, glm::mat4 m)
+SceneNode::SceneNode(Geometry* g, glm::mat4 m, VertexFormat format) : geometry(g)
 {
     matrixPropagate = m;
     matrixSelf = m;
 
-    // if this body part has geometry, create a vertex buffer and fill it
-    if (g != nullptr)
-    {
-        nbVert = g->getNbVertices();
-        glGenVertexArrays(1, &vaoID);
-        glBindVertexArray(vaoID);
+    // if this body part has geometry, get its mesh (uploaded only if no other node uses the same geometry)
+    if (g != nullptr) {
+        mesh = MeshRegistry::acquire(*g, format);
+        bounds = g->computeAABB();
+        sphere = g->computeBoundingSphere();
+    }
+}
 
-        glGenBuffers(1, &vboID);
-        glBindBuffer(GL_ARRAY_BUFFER, vboID);
+SceneNode::SceneNode(const Geometry* g, MeshHandle const& mesh, AABB const& bounds, BoundingSphere const& sphere,
+                     glm::mat4 const& mp, glm::mat4 const& ms)
+    : geometry(g), bounds(bounds), sphere(sphere), mesh(mesh), matrixPropagate(mp), matrixSelf(ms) {}
 
-            glBufferData(GL_ARRAY_BUFFER, (3 + 3 + 2) * sizeof(float)*nbVert, nullptr, GL_DYNAMIC_DRAW);
+void SceneNode::setMatrixS(glm::mat4 const& m)
+{
+    if (scene != nullptr) scene->transforms.setSelf(transform, m);
+    else matrixSelf = m;
+}
 
-            glBufferSubData(GL_ARRAY_BUFFER, 0,                       sizeof(float)*3*nbVert, g->getVertices());
-            glBufferSubData(GL_ARRAY_BUFFER, 3*sizeof(float)*nbVert,  3*sizeof(float)*nbVert, g->getNormals());
-            glBufferSubData(GL_ARRAY_BUFFER, 2*3*sizeof(float)*nbVert,  2*sizeof(float)*nbVert, g->getUVs());
+void SceneNode::setMatrixP(glm::mat4 const& m)
+{
+    if (scene != nullptr) scene->transforms.setPropagate(transform, m);
+    else matrixPropagate = m;
+}
 
-            glVertexAttribPointer(0, 3, GL_FLOAT, 0, 0, 0);
-            glVertexAttribPointer(1, 2, GL_FLOAT, 0, 0, (void*)(nbVert*3*2*sizeof(float)));
-            glVertexAttribPointer(2, 3, GL_FLOAT, 0, 0, (void*)(nbVert*3*sizeof(float)));
-            glEnableVertexAttribArray(0);
-            glEnableVertexAttribArray(1);
-            glEnableVertexAttribArray(2);
+glm::mat4 const& SceneNode::getMatrixS() const
+{
+    return scene != nullptr ? scene->transforms.getSelf(transform) : matrixSelf;
+}
+
+glm::mat4 const& SceneNode::getMatrixP() const
+{
+    return scene != nullptr ? scene->transforms.getPropagate(transform) : matrixPropagate;
+}
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+SceneNode* SceneNode::addChild(SceneNode* bp)
+{
+    bp->parent = this;
+    if (lastChild != nullptr) lastChild->nextSibling = bp;
+    else firstChild = bp;
+    lastChild = bp;
+    if (scene != nullptr) scene->attach(bp, transform);
+    return bp;
+}
+
+void SceneNode::renderSelf(GLint uMV, glm::mat4 const& mv)
+{
+    if (!mesh) return;
+
+    mesh->bind();
+    if (mat != nullptr) mat->use();
+    glUniformMatrix4fv(uMV, 1, false, glm::value_ptr(mv));
+    mesh->draw();
+    if (mat != nullptr) mat->unuse();
+    mesh->unbind();
+}
+
+void SceneNode::recordSelf(RenderFrame& frame, glm::mat4 const& model, glm::mat3 const& normal)
+{
+    // self, unless it is already in the static batch of an ancestor
+    if (instances != nullptr)
+        frame.push(instances, model, mat->getColor(), layer);
+    else if (mesh && !isStatic)
+        frame.push({program, mat, mesh.get(), model, normal});
+}
+
+bool SceneNode::isPickedBySphere(glm::mat4 const& model, float& scale) const
+{
+    float sx = glm::length(glm::vec3(model[0])), sy = glm::length(glm::vec3(model[1])), sz = glm::length(glm::vec3(model[2]));
+    scale = sx;
+    if (fabsf(sx - sy) > 1e-4f * sx || fabsf(sx - sz) > 1e-4f * sx) return false;
+
+    glm::vec3 size = bounds.max - bounds.min;
+    float r = sphere.radius;
+    return 4.18879f * r * r * r < size.x * size.y * size.z;
+}
+
+bool SceneNode::bakeStatic(SceneNode& anchor, glm::mat4 const& toAnchor, std::vector<StaticBatch*>& batches)
+{
+    bool baked = true;
+    for (SceneNode* c = firstChild; c != nullptr; c = c->nextSibling)
+    {
+        if (c->isStatic && c->instances == nullptr)
+        {
+            glm::mat4 propagated = toAnchor * c->getMatrixP();
+            if (c->mesh && c->geometry != nullptr)
+            {
+                if (anchor.staticBatch == nullptr)
+                {
+                    anchor.staticBatch = new StaticBatch();
+                    batches.push_back(anchor.staticBatch);
+                }
+                c->bakedModel = propagated * c->getMatrixS();
+                anchor.staticBatch->add(*c->geometry, c->bakedModel, c->program, c->mat);
+                c->mesh = MeshHandle(); // only the batch draws it now
+                c->bakedIn = &anchor;
+                anchor.bakedNodes.push_back(c);
+            }
+            c->fullyBaked = c->bakeStatic(anchor, propagated, batches);
+            baked = baked && c->fullyBaked;
+        }
+        else
+        {
+            c->bakeStatic(*c, glm::mat4(1.f), batches);
+            baked = false;
+        }
     }
+    return baked;
 }
 
-SceneNode::~SceneNode()
+
+Scene::Scene() : view(glm::mat4(1.f))
 {
-    // cleanup
-    if (vaoID != 0) glDeleteVertexArrays(1, &vaoID);
-    if (vboID != 0) glDeleteBuffers(1, &vboID);
-    for (auto c : childs) delete c;
-    childs.clear();
+    root = createNode(nullptr, glm::mat4(1.f));
+    attach(root, TransformHierarchy::NO_PARENT);
 }
 
-void SceneNode::Render(GLint uMV)
+Scene::~Scene()
 {
-    // push matrix
-    glm::mat4 m = matrixSelf;
-    if (matrices.empty()) matrices.push(matrixPropagate);
-    else
+    // the nodes are destroyed with the pool
+    for (auto b : staticBatches) delete b;
+}
+
+SceneNode* Scene::createNode(Geometry* g, glm::mat4 m, VertexFormat format)
+{
+    PartHandle h = pool.create(g, m, format);
+    SceneNode* node = pool.get(h);
+    node->handle = h;
+    return node;
+}
+
+void Scene::destroy(PartHandle part)
+{
+    SceneNode* node = pool.get(part);
+    if (node == nullptr || node == root) return;
+
+    if (SceneNode* p = node->parent)
     {
-        m = matrices.top() * m;
-        matrices.push(matrices.top() * matrixPropagate);
+        SceneNode* previous = nullptr;
+        for (SceneNode* c = p->firstChild; c != node; c = c->nextSibling) previous = c;
+        if (previous != nullptr) previous->nextSibling = node->nextSibling;
+        else p->firstChild = node->nextSibling;
+        if (p->lastChild == node) p->lastChild = previous;
     }
 
-    // render self
-    if (vaoID != 0)
+    // the whole subtree, breadth first
+    std::vector<SceneNode*> subtree(1, node);
+    for (size_t i = 0; i < subtree.size(); i++)
+        for (SceneNode* c = subtree[i]->firstChild; c != nullptr; c = c->nextSibling) subtree.push_back(c);
+
+    // one compaction of the hierarchy for the whole subtree : the remaining nodes keep their order
+    if (node->scene == this)
     {
-        glBindVertexArray(vaoID);
-        if (mat != nullptr) mat->use();
-        glUniformMatrix4fv(uMV, 1, false, glm::value_ptr(m));
-        glDrawArrays(GL_TRIANGLES, 0, nbVert);
-        if (mat != nullptr) mat->unuse();
-        glBindVertexArray(0);
+        std::vector<uint8_t> removed(nodes.size(), 0);
+        for (SceneNode* n : subtree) removed[n->transform] = 1;
+
+        for (SceneNode* n : subtree)
+        {
+            if (n->bakedIn != nullptr && !removed[n->bakedIn->transform])
+            {
+                WARNING("a destroyed node stays drawn by the static batch of its anchor until the anchor is destroyed\n");
+                break;
+            }
+        }
+
+        transforms.remove(removed);
+        uint32_t j = 0;
+        for (uint32_t i = 0; i < nodes.size(); i++)
+        {
+            if (removed[i]) continue;
+            nodes[j] = nodes[i];
+            nodes[j]->transform = j;
+            j++;
+        }
+        nodes.resize(j);
+        bvhBuilt = false;
     }
 
-    // render all childs
-    for (auto c : childs) c->Render(uMV);
+    // before any node is destroyed : the anchors may be in the subtree
+    for (SceneNode* n : subtree)
+    {
+        if (n->bakedIn == nullptr) continue;
+        auto& baked = n->bakedIn->bakedNodes;
+        baked.erase(std::find(baked.begin(), baked.end(), n));
+    }
 
-    // pop matrix
-    matrices.pop();
+    for (SceneNode* n : subtree)
+    {
+        if (n->staticBatch != nullptr)
+        {
+            staticBatches.erase(std::find(staticBatches.begin(), staticBatches.end(), n->staticBatch));
+            delete n->staticBatch;
+        }
+        if (n->name != NameTable::NONE) partNames.remove(n->name);
+        pool.destroy(n->handle);
+    }
 }
 
+void Scene::attach(SceneNode* node, uint32_t parent)
+{
+    node->scene = this;
+    node->transform = transforms.add(parent, node->matrixPropagate, node->matrixSelf);
+    nodes.push_back(node);
+    bvhBuilt = false;
 
-Scene::Scene() : root(new SceneNode(nullptr, glm::mat4(1.f))), view(glm::mat4(1.f)) {}
+    // childs added before the node was in the scene
+    for (SceneNode* c = node->firstChild; c != nullptr; c = c->nextSibling) attach(c, node->transform);
+}
 
-Scene::~Scene()
+PartHandle Scene::addPart(std::string const& name, PartHandle parent, SceneNode* node)
 {
-    delete root;
+    return addPart("", 0, name.c_str(), name.size(), parent, node);
+}
+
+PartHandle Scene::addPart(const char* prefix, size_t prefixLength, const char* name, size_t length, PartHandle parent, SceneNode* node)
+{
+    SceneNode* p = parent.isNull() ? root : pool.get(parent);
+    if (p == nullptr)
+    {
+        ERROR("the parent of scene part '%.*s%.*s' was destroyed\n", (int)prefixLength, prefix, (int)length, name);
+        exit(1);
+    }
+    if (prefixLength + length > 0)
+    {
+        node->name = partNames.add(prefix, prefixLength, name, length, node->handle);
+        if (node->name == NameTable::NONE)
+        {
+            ERROR("scene part '%.*s%.*s' already exists\n", (int)prefixLength, prefix, (int)length, name);
+            exit(1);
+        }
+    }
+    p->addChild(node);
+    return node->handle;
+}
+
+PartHandle Scene::load(SceneFile const& file, SceneLibrary const& library, PartHandle parent, std::string const& prefix)
+{
+    // one lookup, upload and box per shape of the file, not per node
+    std::vector<const Geometry*> geometries(file.getNbMeshes());
+    std::vector<MeshHandle> meshes(file.getNbMeshes());
+    std::vector<AABB> bounds(file.getNbMeshes());
+    std::vector<BoundingSphere> spheres(file.getNbMeshes());
+    for (uint32_t i = 0; i < file.getNbMeshes(); i++)
+    {
+        Geometry* g = library.findMesh(file.getMeshName(i));
+        if (g == nullptr)
+        {
+            ERROR("no shape named '%s' in the scene library\n", file.getMeshName(i));
+            exit(1);
+        }
+        geometries[i] = g;
+        meshes[i] = MeshRegistry::acquire(*g, library.getFormat());
+        bounds[i] = g->computeAABB();
+        spheres[i] = g->computeBoundingSphere();
+    }
+
+    std::vector<Material*> materials(file.getNbMaterials());
+    for (uint32_t i = 0; i < file.getNbMaterials(); i++)
+    {
+        materials[i] = library.findMaterial(file.getMaterialName(i));
+        if (materials[i] == nullptr)
+        {
+            ERROR("no material named '%s' in the scene library\n", file.getMaterialName(i));
+            exit(1);
+        }
+    }
+
+    uint32_t n = file.getNbNodes();
+    size_t nbChars = 0;
+    for (uint32_t i = 0; i < n; i++) nbChars += prefix.size() + strlen(file.getName(file.getNode(i).name)) + 1;
+    partNames.reserve(n, nbChars);
+    nodes.reserve(nodes.size() + n);
+    transforms.reserve(transforms.size() + n);
+
+    // the nodes are built from the blob as is, in the free slots of the pool
+    std::vector<PartHandle> handles(n);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        SceneFile::Node const& fn = file.getNode(i);
+        bool hasMesh = fn.mesh != SceneFile::NONE;
+        handles[i] = pool.create(hasMesh ? geometries[fn.mesh] : nullptr,
+                                 hasMesh ? meshes[fn.mesh] : MeshHandle(),
+                                 hasMesh ? bounds[fn.mesh] : AABB(),
+                                 hasMesh ? spheres[fn.mesh] : BoundingSphere(),
+                                 glm::make_mat4(fn.propagate), glm::make_mat4(fn.self));
+        SceneNode* node = pool.get(handles[i]);
+        node->handle = handles[i];
+        node->isStatic = (fn.flags & SceneFile::FLAG_STATIC) != 0;
+        node->program = library.getProgram();
+        if (fn.material != SceneFile::NONE) node->mat = materials[fn.material];
+
+        const char* name = file.getName(fn.name);
+        addPart(prefix.c_str(), prefix.size(), name, strlen(name), fn.parent == SceneFile::NONE ? parent : handles[fn.parent], node);
+    }
+    return n > 0 ? handles[0] : PartHandle();
+}
+
+PartHandle Scene::findPart(std::string const& name) const
+{
+    PartHandle part = partNames.find(name.c_str(), name.size());
+    if (part.isNull())
+    {
+        ERROR("no scene part named '%s'\n", name.c_str());
+        exit(1);
+    }
+    return part;
+}
+
+const char* Scene::getPartName(PartHandle part) const
+{
+    SceneNode* node = pool.get(part);
+    return node != nullptr && node->name != NameTable::NONE ? partNames.get(node->name) : "";
 }
 
 void Scene::Render(GLint uMV)
 {
-    // push the view matrix then render everything
-    SceneNode::matrices.push(view);
     if (light != nullptr) {
         light->setView(view);
         light->sendUniforms();
     }
-    root->Render(uMV);
-    SceneNode::matrices.pop();
+
+    // one linear pass over the moved matrices, then render everything with the view matrix as root matrix
+    transforms.update();
+    for (uint32_t i = 0; i < nodes.size(); i++)
+        nodes[i]->renderSelf(uMV, view * transforms.getModel(i));
+}
+
+void Scene::enqueue(RenderQueue& queue, Frustum const& frustum)
+{
+    scratch.clear();
+    record(scratch, frustum);
+    scratch.submit(queue);
+}
+
+void Scene::record(RenderFrame& frame, Frustum const& frustum)
+{
+    updateBounds();
+
+    bvh.cull(frustum, visible);
+    for (uint32_t k : visible)
+    {
+        uint32_t i = drawables[k].node;
+        if (drawables[k].batch) nodes[i]->staticBatch->record(transforms.getWorld(i), frame);
+        else nodes[i]->recordSelf(frame, transforms.getModel(i), transforms.getNormal(i));
+    }
+    nbDrawn = (uint32_t)visible.size();
+    nbCulled = (uint32_t)drawables.size() - nbDrawn;
+    frame.nbDrawn += nbDrawn;
+    frame.nbCulled += nbCulled;
+}
+
+void Scene::updateBounds()
+{
+    transforms.update();
+
+    // refit the boxes of what moved
+    if (!bvhBuilt) buildBVH();
+    else if (transforms.getNbUpdated() > 0)
+    {
+        for (uint32_t k = 0; k < drawables.size(); k++)
+            if (transforms.wasUpdated(drawables[k].node)) bvh.setBounds(k, getWorldBounds(drawables[k]));
+        bvh.refit();
+    }
+}
+
+RayHit Scene::raycast(glm::vec3 const& origin, glm::vec3 const& dir)
+{
+    RayHit hit;
+    Ray ray{origin, glm::normalize(dir)};
+    updateBounds();
+    bvh.raycast(ray.origin, ray.dir, rayHits);
+
+    // the exact shape of every node whose box (or batch box) is crossed
+    candidates.clear();
+    auto addNode = [&](SceneNode const* n) {
+        if (n->geometry == nullptr) return;
+        uint32_t i = n->transform;
+        glm::mat4 model;
+        glm::mat3 inv;
+        getPickMatrices(n, model, inv);
+        float scale;
+        if (n->isPickedBySphere(model, scale))
+            candidates.addSphere(i, glm::vec3(model * glm::vec4(n->sphere.center, 1.f)), n->sphere.radius * scale);
+        else
+            candidates.addBox(i, n->bounds, inv * (ray.origin - glm::vec3(model[3])), inv * ray.dir);
+    };
+    for (uint32_t k : rayHits)
+    {
+        SceneNode const* n = nodes[drawables[k].node];
+        if (!drawables[k].batch) addNode(n);
+        else for (SceneNode const* b : n->bakedNodes) addNode(b);
+    }
+
+    uint32_t i;
+    if (!candidates.closest(ray, i, hit.distance)) return hit;
+
+    SceneNode const* n = nodes[i];
+    glm::mat4 model;
+    glm::mat3 inv;
+    getPickMatrices(n, model, inv);
+    hit.node = n->handle;
+    hit.point = ray.origin + hit.distance * ray.dir;
+
+    // the normal of the face of the box (or of the sphere) at the hit point, in node space
+    glm::vec3 local = inv * (hit.point - glm::vec3(model[3]));
+    glm::vec3 normal;
+    float scale;
+    if (n->isPickedBySphere(model, scale)) normal = local - n->sphere.center;
+    else
+    {
+        glm::vec3 d = (local - n->bounds.getCenter()) / glm::max(n->bounds.getExtents(), glm::vec3(1e-6f));
+        glm::vec3 a = glm::abs(d);
+        int axis = a.x > a.y ? (a.x > a.z ? 0 : 2) : (a.y > a.z ? 1 : 2);
+        normal = glm::vec3(0.f);
+        normal[axis] = d[axis] < 0.f ? -1.f : 1.f;
+    }
+    hit.normal = glm::normalize(glm::transpose(inv) * normal);
+    return hit;
+}
+
+void Scene::buildBVH()
+{
+    drawables.clear();
+    for (uint32_t i = 0; i < nodes.size(); i++)
+    {
+        // the childs of a fully baked node are fully baked too
+        if (nodes[i]->fullyBaked) continue;
+        if (nodes[i]->staticBatch != nullptr) drawables.push_back({i, true});
+        if (nodes[i]->isDrawn()) drawables.push_back({i, false});
+    }
+
+    std::vector<AABB> bounds;
+    bounds.reserve(drawables.size());
+    for (Drawable const& d : drawables) bounds.push_back(getWorldBounds(d));
+    bvh.build(bounds);
+    bvhBuilt = true;
+}
+
+AABB Scene::getWorldBounds(Drawable const& d) const
+{
+    if (d.batch) return nodes[d.node]->staticBatch->getBounds().transformed(transforms.getWorld(d.node));
+    return nodes[d.node]->bounds.transformed(transforms.getModel(d.node));
+}
+
+void Scene::getPickMatrices(SceneNode const* n, glm::mat4& model, glm::mat3& inv) const
+{
+    if (n->bakedIn == nullptr)
+    {
+        model = transforms.getModel(n->transform);
+        inv = transforms.getNormal(n->transform);
+        return;
+    }
+    model = transforms.getWorld(n->bakedIn->transform) * n->bakedModel;
+    inv = glm::inverse(glm::mat3(model));
+}
+
+void Scene::bakeStatic(VertexFormat format)
+{
+    root->bakeStatic(*root, glm::mat4(1.f), staticBatches);
+    bvhBuilt = false;
+
+    // only the matrices of the anchors are read now : the batches are drawn with them, the picking derives the rest
+    uint32_t nbFrozen = 0;
+    for (SceneNode* n : nodes)
+    {
+        if (!n->fullyBaked) continue;
+        transforms.freeze(n->transform);
+        nbFrozen++;
+    }
+
+    size_t nbObjects = 0, nbDraws = 0;
+    for (auto b : staticBatches)
+    {
+        b->upload(format);
+        nbObjects += b->getNbObjects();
+        nbDraws += b->getNbDraws();
+    }
+    INFO("static batching : %zu objects drawn in %zu draws, %u nodes no longer updated\n", nbObjects, nbDraws, nbFrozen);
+}
+
+void Scene::reportMemory() const
+{
+    MeshRegistry::report();
 }
@@ -0,0 +1,396 @@
+#include "SceneFile.h"
+#include "logger.h"
+
+#include <cctype>
+#include <cstring>
+#include <vector>
+#include <sys/stat.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+static const char SCENE_FILE_MAGIC[4] = {'S', 'C', 'N', 'B'};
+static const uint32_t SCENE_FILE_VERSION = 2;
+
+Geometry* SceneLibrary::findMesh(const char* name) const
+{
+    auto it = meshes.find(name);
+    return it != meshes.end() ? it->second : nullptr;
+}
+
+Material* SceneLibrary::findMaterial(const char* name) const
+{
+    auto it = materials.find(name);
+    return it != materials.end() ? it->second : nullptr;
+}
+
+namespace {
+
+    // reads the text form, reporting errors with the file and the line
+    struct SceneParser {
+        const char* path;
+        int line = 0;
+        std::unordered_map<std::string, float> vars;
+
+        bool fail(const char* what, std::string const& token)
+        {
+            ERROR("%s:%d : %s '%s'\n", path, line, what, token.c_str());
+            return false;
+        }
+
+        // expr := term (('+'|'-') term)*, term := factor (('*'|'/') factor)*,
+        // factor := '-' factor | '(' expr ')' | number | var
+        bool expr(const char*& s, float& v)
+        {
+            if (!term(s, v)) return false;
+            while (*s == '+' || *s == '-')
+            {
+                char op = *s++;
+                float r;
+                if (!term(s, r)) return false;
+                v = op == '+' ? v + r : v - r;
+            }
+            return true;
+        }
+
+        bool term(const char*& s, float& v)
+        {
+            if (!factor(s, v)) return false;
+            while (*s == '*' || *s == '/')
+            {
+                char op = *s++;
+                float r;
+                if (!factor(s, r)) return false;
+                v = op == '*' ? v * r : v / r;
+            }
+            return true;
+        }
+
+        bool factor(const char*& s, float& v)
+        {
+            if (*s == '-') { s++; if (!factor(s, v)) return false; v = -v; return true; }
+            if (*s == '(')
+            {
+                s++;
+                if (!expr(s, v) || *s != ')') return false;
+                s++;
+                return true;
+            }
+            if (isdigit((unsigned char)*s) || *s == '.')
+            {
+                char* end;
+                v = strtof(s, &end);
+                s = end;
+                return true;
+            }
+            const char* start = s;
+            while (isalnum((unsigned char)*s) || *s == '_') s++;
+            auto it = vars.find(std::string(start, s));
+            if (s == start || it == vars.end()) return false;
+            v = it->second;
+            return true;
+        }
+
+        bool value(std::string const& token, float& v)
+        {
+            const char* s = token.c_str();
+            if (!expr(s, v) || *s != '\0') return fail("invalid expression", token);
+            return true;
+        }
+
+        // ops := ('translate' x y z | 'rotate' degrees x y z | 'scale' x y z | 'scale' s)*
+        bool transform(std::vector<std::string> const& tokens, glm::mat4& m)
+        {
+            m = glm::mat4(1.0f);
+            auto isOp = [&](size_t i) {
+                return i >= tokens.size() || tokens[i] == "translate" || tokens[i] == "rotate" || tokens[i] == "scale";
+            };
+            size_t i = 1;
+            while (i < tokens.size())
+            {
+                std::string const& op = tokens[i++];
+                if (op != "translate" && op != "rotate" && op != "scale") return fail("unknown transformation", op);
+                size_t nbArgs = op == "rotate" ? 4 : 3;
+                if (op == "scale" && isOp(i + 1)) nbArgs = 1;
+
+                float a[4];
+                for (size_t k = 0; k < nbArgs; k++)
+                {
+                    if (i >= tokens.size()) return fail("missing value after", op);
+                    if (!value(tokens[i++], a[k])) return false;
+                }
+
+                if (op == "translate") m = glm::translate(m, glm::vec3(a[0], a[1], a[2]));
+                else if (op == "rotate") m = glm::rotate(m, glm::radians(a[0]), glm::vec3(a[1], a[2], a[3]));
+                else if (nbArgs == 1) m = glm::scale(m, glm::vec3(a[0]));
+                else m = glm::scale(m, glm::vec3(a[0], a[1], a[2]));
+            }
+            return true;
+        }
+    };
+
+    // the string table of the blob, each name stored once
+    struct StringTable {
+        std::string data;
+        std::unordered_map<std::string, uint32_t> offsets;
+
+        uint32_t add(std::string const& s)
+        {
+            auto it = offsets.find(s);
+            if (it != offsets.end()) return it->second;
+            uint32_t offset = (uint32_t)data.size();
+            data.append(s).push_back('\0');
+            offsets[s] = offset;
+            return offset;
+        }
+    };
+
+    // index of a name in a list, added if not there yet
+    uint32_t indexOf(std::vector<std::string>& list, std::string const& name)
+    {
+        if (name == "-") return SceneFile::NONE;
+        for (uint32_t i = 0; i < list.size(); i++)
+            if (list[i] == name) return i;
+        list.push_back(name);
+        return (uint32_t)list.size() - 1;
+    }
+
+    uint32_t align(uint32_t offset, uint32_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+}
+
+bool SceneFile::compile(const char* textPath, const char* blobPath)
+{
+    FILE* f = fopen(textPath, "r");
+    if (f == nullptr)
+    {
+        ERROR("could not open '%s'\n", textPath);
+        return false;
+    }
+
+    SceneParser parser{textPath, 0, {}};
+    std::vector<Node> nodes;
+    std::vector<std::string> meshNames, materialNames;
+    std::unordered_map<std::string, uint32_t> nodeIndices;
+    StringTable names;
+    bool ok = true;
+
+    char buffer[1024];
+    while (ok && fgets(buffer, sizeof(buffer), f) != nullptr)
+    {
+        parser.line++;
+        char* comment = strchr(buffer, '#');
+        if (comment != nullptr) *comment = '\0';
+
+        std::vector<std::string> tokens;
+        for (char* t = strtok(buffer, " \t\r\n"); t != nullptr; t = strtok(nullptr, " \t\r\n"))
+            tokens.push_back(t);
+        if (tokens.empty()) continue;
+
+        std::string const& statement = tokens[0];
+        if (statement == "var")
+        {
+            float v;
+            if (tokens.size() != 3) ok = parser.fail("expected 'var <name> <expr>' in", statement);
+            else if ((ok = parser.value(tokens[2], v))) parser.vars[tokens[1]] = v;
+        }
+        else if (statement == "node")
+        {
+            if (tokens.size() < 5 || tokens.size() > 6 || (tokens.size() == 6 && tokens[5] != "static"))
+            {
+                ok = parser.fail("expected 'node <name> <parent|-> <mesh|-> <material|-> [static]' in", statement);
+                break;
+            }
+            if (nodeIndices.count(tokens[1]) != 0) { ok = parser.fail("node declared twice :", tokens[1]); break; }
+
+            Node n;
+            memset(&n, 0, sizeof(n));
+            n.name = names.add(tokens[1]);
+            n.parent = NONE;
+            if (tokens[2] != "-")
+            {
+                auto it = nodeIndices.find(tokens[2]);
+                if (it == nodeIndices.end()) { ok = parser.fail("unknown parent", tokens[2]); break; }
+                n.parent = it->second;
+            }
+            n.mesh = indexOf(meshNames, tokens[3]);
+            n.material = indexOf(materialNames, tokens[4]);
+            n.flags = tokens.size() == 6 ? FLAG_STATIC : 0;
+            memcpy(n.propagate, glm::value_ptr(glm::mat4(1.0f)), sizeof(n.propagate));
+            memcpy(n.self, glm::value_ptr(glm::mat4(1.0f)), sizeof(n.self));
+
+            nodeIndices[tokens[1]] = (uint32_t)nodes.size();
+            nodes.push_back(n);
+        }
+        else if (statement == "propagate" || statement == "local")
+        {
+            glm::mat4 m;
+            if (nodes.empty()) ok = parser.fail("no node before", statement);
+            else if ((ok = parser.transform(tokens, m)))
+                memcpy(statement == "local" ? nodes.back().self : nodes.back().propagate, glm::value_ptr(m), sizeof(nodes.back().self));
+        }
+        else ok = parser.fail("unknown statement", statement);
+    }
+    fclose(f);
+    if (!ok) return false;
+
+    // the names of the shapes and materials, then the layout of the blob
+    std::vector<Var> vars;
+    for (auto const& v : parser.vars) vars.push_back({names.add(v.first), v.second});
+    std::vector<uint32_t> meshOffsets, materialOffsets;
+    for (auto const& m : meshNames) meshOffsets.push_back(names.add(m));
+    for (auto const& m : materialNames) materialOffsets.push_back(names.add(m));
+
+    Header header;
+    memcpy(header.magic, SCENE_FILE_MAGIC, sizeof(header.magic));
+    header.version = SCENE_FILE_VERSION;
+    header.nbVars = (uint32_t)vars.size();
+    header.nbNodes = (uint32_t)nodes.size();
+    header.nbMeshes = (uint32_t)meshNames.size();
+    header.nbMaterials = (uint32_t)materialNames.size();
+    header.varsOffset = sizeof(Header);
+    header.meshesOffset = header.varsOffset + header.nbVars * sizeof(Var);
+    header.materialsOffset = header.meshesOffset + header.nbMeshes * sizeof(uint32_t);
+    header.nodesOffset = align(header.materialsOffset + header.nbMaterials * sizeof(uint32_t), 16);
+    header.namesOffset = header.nodesOffset + header.nbNodes * sizeof(Node);
+    header.size = header.namesOffset + (uint32_t)names.data.size();
+
+    std::vector<uint8_t> blob(header.size, 0);
+    memcpy(blob.data(), &header, sizeof(header));
+    if (!vars.empty()) memcpy(blob.data() + header.varsOffset, vars.data(), vars.size() * sizeof(Var));
+    if (!meshOffsets.empty()) memcpy(blob.data() + header.meshesOffset, meshOffsets.data(), meshOffsets.size() * sizeof(uint32_t));
+    if (!materialOffsets.empty()) memcpy(blob.data() + header.materialsOffset, materialOffsets.data(), materialOffsets.size() * sizeof(uint32_t));
+    if (!nodes.empty()) memcpy(blob.data() + header.nodesOffset, nodes.data(), nodes.size() * sizeof(Node));
+    memcpy(blob.data() + header.namesOffset, names.data.data(), names.data.size());
+
+    FILE* out = fopen(blobPath, "wb");
+    if (out == nullptr)
+    {
+        ERROR("could not open '%s'\n", blobPath);
+        return false;
+    }
+    bool written = fwrite(blob.data(), 1, blob.size(), out) == blob.size();
+    fclose(out);
+    if (!written)
+    {
+        ERROR("could not write '%s'\n", blobPath);
+        remove(blobPath);
+        return false;
+    }
+    INFO("compiled '%s' : %u nodes, %u bytes\n", textPath, header.nbNodes, header.size);
+    return true;
+}
+
+SceneFile* SceneFile::openCompiled(const char* textPath, const char* blobPath)
+{
+    struct stat text, blob;
+    bool hasText = stat(textPath, &text) == 0;
+    bool hasBlob = stat(blobPath, &blob) == 0;
+    if (hasText && (!hasBlob || blob.st_mtime < text.st_mtime) && !compile(textPath, blobPath))
+        return nullptr;
+    return open(blobPath);
+}
+
+SceneFile* SceneFile::open(const char* blobPath)
+{
+    SceneFile* file = new SceneFile();
+
+#ifdef _WIN32
+    // no mmap : the blob is read in one buffer
+    FILE* f = fopen(blobPath, "rb");
+    if (f != nullptr)
+    {
+        fseek(f, 0, SEEK_END);
+        file->size = (size_t)ftell(f);
+        fseek(f, 0, SEEK_SET);
+        uint8_t* buffer = new uint8_t[file->size];
+        if (fread(buffer, 1, file->size, f) == file->size) file->data = buffer;
+        else delete[] buffer;
+        fclose(f);
+    }
+#else
+    int fd = ::open(blobPath, O_RDONLY);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED)
+        {
+            file->data = (const uint8_t*)p;
+            file->size = (size_t)st.st_size;
+            file->mapped = true;
+        }
+    }
+    if (fd >= 0) close(fd);
+#endif
+
+    if (file->data == nullptr)
+    {
+        ERROR("could not open '%s'\n", blobPath);
+        delete file;
+        return nullptr;
+    }
+
+    // the blob is used as is : check every offset and index once, so that nothing has to be checked when instantiating
+    const Header* h = (const Header*)file->data;
+    bool valid = file->size >= sizeof(Header) && memcmp(h->magic, SCENE_FILE_MAGIC, sizeof(h->magic)) == 0
+              && h->version == SCENE_FILE_VERSION && h->size == file->size
+              && h->varsOffset >= sizeof(Header)
+              && (uint64_t)h->varsOffset + h->nbVars * sizeof(Var) <= h->meshesOffset
+              && (uint64_t)h->meshesOffset + h->nbMeshes * sizeof(uint32_t) <= h->materialsOffset
+              && (uint64_t)h->materialsOffset + h->nbMaterials * sizeof(uint32_t) <= h->nodesOffset
+              && h->nodesOffset % 16 == 0 && (uint64_t)h->nodesOffset + (uint64_t)h->nbNodes * sizeof(Node) <= h->namesOffset
+              && h->namesOffset < h->size && file->data[h->size - 1] == '\0';
+    if (valid)
+    {
+        file->header = h;
+        file->vars = (const Var*)(file->data + h->varsOffset);
+        file->meshes = (const uint32_t*)(file->data + h->meshesOffset);
+        file->materials = (const uint32_t*)(file->data + h->materialsOffset);
+        file->nodes = (const Node*)(file->data + h->nodesOffset);
+        file->names = (const char*)(file->data + h->namesOffset);
+        uint32_t namesSize = h->size - h->namesOffset;
+
+        for (uint32_t i = 0; valid && i < h->nbVars; i++) valid = file->vars[i].name < namesSize;
+        for (uint32_t i = 0; valid && i < h->nbMeshes; i++) valid = file->meshes[i] < namesSize;
+        for (uint32_t i = 0; valid && i < h->nbMaterials; i++) valid = file->materials[i] < namesSize;
+        for (uint32_t i = 0; valid && i < h->nbNodes; i++)
+        {
+            const Node& n = file->nodes[i];
+            valid = n.name < namesSize && (n.parent == NONE || n.parent < i)
+                 && (n.mesh == NONE || n.mesh < h->nbMeshes) && (n.material == NONE || n.material < h->nbMaterials);
+        }
+    }
+
+    if (!valid)
+    {
+        ERROR("'%s' is not a valid compiled scene\n", blobPath);
+        delete file;
+        return nullptr;
+    }
+    return file;
+}
+
+float SceneFile::getVar(const char* name) const
+{
+    for (uint32_t i = 0; i < header->nbVars; i++)
+        if (strcmp(names + vars[i].name, name) == 0) return vars[i].value;
+    ERROR("no var named '%s' in the scene file\n", name);
+    exit(1);
+}
+
+SceneFile::~SceneFile()
+{
+#ifdef _WIN32
+    delete[] data;
+#else
+    if (mapped) munmap((void*)data, size);
+#endif
+}
@@ -1,11 +1,14 @@
 #include "Shader.h"
+#include "GLState.h"
+#include "UniformBlocks.h"
+#include <algorithm>
 
 Shader::Shader() : m_programID(0), m_vertexID(0), m_fragID(0)
 {}
 
 Shader::~Shader()
 {
-    glDeleteProgram(m_programID);
+    GLState::deleteProgram(m_programID);
     glDeleteShader(m_vertexID);
     glDeleteShader(m_fragID);
 }
@@ -77,6 +80,9 @@ Shader* Shader::loadFromStrings(const std::string& vertexString, const std::stri
         return NULL;
     }
 
+    /* Read the uniforms and attributes once, so that nobody has to ask the driver by name afterward */
+    shader->readActiveVariables();
+
     return shader;
 }
 
@@ -126,4 +132,98 @@ void Shader::bindAttributes()
     glBindAttribLocation(m_programID, 0, "vPosition");
     glBindAttribLocation(m_programID, 1, "vUV");
     glBindAttribLocation(m_programID, 2, "vNormal");
+    glBindAttribLocation(m_programID, 3, "iModel");      // per instance, takes 3 to 6
+    glBindAttribLocation(m_programID, 7, "iColorLayer"); // per instance
+}
+
+GLint Shader::getUniformLocation(const std::string& name) const
+{
+    const ActiveVariable* var = find(m_uniforms, name);
+    return var ? var->location : -1;
+}
+
+GLint Shader::getAttribLocation(const std::string& name) const
+{
+    const ActiveVariable* var = find(m_attributes, name);
+    return var ? var->location : -1;
+}
+
+GLint Shader::getUniformBlockSize(const std::string& name) const
+{
+    const ActiveVariable* var = find(m_blocks, name);
+    return var ? var->size : -1;
+}
+
+void Shader::readActiveVariables()
+{
+    char  name[ERROR_MAX_LENGTH];
+    GLint count = 0;
+
+    /* Uniforms */
+    glGetProgramiv(m_programID, GL_ACTIVE_UNIFORMS, &count);
+    m_uniforms.reserve(count);
+    for(GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        ActiveVariable var;
+        glGetActiveUniform(m_programID, i, ERROR_MAX_LENGTH, &length, &var.size, &var.type, name);
+        var.name     = std::string(name, length);
+        var.location = glGetUniformLocation(m_programID, name);
+
+        /* Uniforms inside a uniform block have no location */
+        if(var.location < 0)
+            continue;
+
+        /* Arrays are reported as "name[0]" */
+        if(var.name.size() > 3 && var.name.compare(var.name.size()-3, 3, "[0]") == 0)
+            var.name.resize(var.name.size()-3);
+        m_uniforms.push_back(var);
+    }
+
+    /* Attributes */
+    glGetProgramiv(m_programID, GL_ACTIVE_ATTRIBUTES, &count);
+    m_attributes.reserve(count);
+    for(GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        ActiveVariable var;
+        glGetActiveAttrib(m_programID, i, ERROR_MAX_LENGTH, &length, &var.size, &var.type, name);
+        var.name     = std::string(name, length);
+        var.location = glGetAttribLocation(m_programID, name);
+        m_attributes.push_back(var);
+    }
+
+    /* Uniform blocks : the shared ones get their fixed binding point, so that a buffer bound once serves every program */
+    glGetProgramiv(m_programID, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    m_blocks.reserve(count);
+    for(GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        ActiveVariable var;
+        glGetActiveUniformBlockName(m_programID, i, ERROR_MAX_LENGTH, &length, name);
+        glGetActiveUniformBlockiv(m_programID, i, GL_UNIFORM_BLOCK_DATA_SIZE, &var.size);
+        var.name     = std::string(name, length);
+        var.location = i;
+        var.type     = GL_UNIFORM_BUFFER;
+        m_blocks.push_back(var);
+
+        if(var.name == FRAME_BLOCK_NAME)
+            glUniformBlockBinding(m_programID, i, FRAME_BLOCK_BINDING);
+        else if(var.name == OBJECT_BLOCK_NAME)
+            glUniformBlockBinding(m_programID, i, OBJECT_BLOCK_BINDING);
+    }
+
+    auto byName = [](const ActiveVariable& a, const ActiveVariable& b) {return a.name < b.name;};
+    std::sort(m_uniforms.begin(),   m_uniforms.end(),   byName);
+    std::sort(m_attributes.begin(), m_attributes.end(), byName);
+    std::sort(m_blocks.begin(),     m_blocks.end(),     byName);
+}
+
+const Shader::ActiveVariable* Shader::find(const std::vector<ActiveVariable>& table, const std::string& name)
+{
+    auto it = std::lower_bound(table.begin(), table.end(), name,
+                               [](const ActiveVariable& var, const std::string& n) {return var.name < n;});
+    if(it == table.end() || it->name != name)
+        return NULL;
+    return &(*it);
 }
@@ -0,0 +1,46 @@
+#include "ShadingProgram.h"
+#include "GLState.h"
+#include "UniformBlocks.h"
+
+ShadingProgram* ShadingProgram::loadFromFiles(const char* vertPath, const char* fragPath)
+{
+    FILE* vertFile = fopen(vertPath, "r");
+    FILE* fragFile = fopen(fragPath, "r");
+    if (vertFile == nullptr || fragFile == nullptr)
+    {
+        ERROR("could not open '%s' or '%s'\n", vertPath, fragPath);
+        if (vertFile != nullptr) fclose(vertFile);
+        if (fragFile != nullptr) fclose(fragFile);
+        return nullptr;
+    }
+
+    Shader* shader = Shader::loadFromFiles(vertFile, fragFile);
+    fclose(vertFile);
+    fclose(fragFile);
+    if (shader == nullptr) return nullptr;
+
+    ShadingProgram* p = new ShadingProgram(shader);
+    Uniform<int> uTexture = shader->uniform<int>("uTexture");
+    GLint frameSize  = shader->getUniformBlockSize(FRAME_BLOCK_NAME);
+    GLint objectSize = shader->getUniformBlockSize(OBJECT_BLOCK_NAME);
+
+    if (!uTexture.isValid() || frameSize != (GLint)sizeof(FrameBlock) || objectSize != (GLint)sizeof(ObjectBlock))
+    {
+        ERROR("'%s' / '%s' do not declare the uniforms expected by the renderer (Frame block : %d bytes, Object block : %d bytes)\n",
+              vertPath, fragPath, frameSize, objectSize);
+        delete p;
+        return nullptr;
+    }
+
+    // the texture is always on unit 0
+    GLState::useProgram(shader->getProgramID());
+    uTexture.set(0);
+    GLState::useProgram(0);
+
+    return p;
+}
+
+ShadingProgram::~ShadingProgram()
+{
+    delete shader;
+}
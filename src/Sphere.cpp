@@ -37,24 +37,26 @@ Sphere::Sphere(uint32_t nbLatitude, uint32_t nbLongitude)
 		}
 	}
 
-    //Merge everything
-    m_nbVertices = nbLongitude*(nbLatitude-1)*6;
+    //Keep the unique vertices and draw them with the orders
+    m_nbVertices = nbLongitude*nbLatitude;
     m_vertices = (float*)malloc(sizeof(float)*m_nbVertices*3);
     m_uvs      = (float*)malloc(sizeof(float)*m_nbVertices*2);
     m_normals  = (float*)malloc(sizeof(float)*m_nbVertices*3);
-    for(uint32_t i = 0; i < nbLatitude*(nbLongitude-1)*6; i++)
+    for(uint32_t i = 0; i < m_nbVertices; i++)
     {
-        uint32_t indice   = order[i];
+        glm::vec3 normal = glm::normalize(vertexCoord[i]);
         for(uint32_t j = 0; j < 3; j++)
         {
-            m_vertices[3*i+j] = vertexCoord[indice][j];
-            m_normals [3*i+j] = glm::normalize(vertexCoord[indice])[j];
+            m_vertices[3*i+j] = vertexCoord[i][j];
+            m_normals [3*i+j] = normal[j];
         }
         for(uint32_t j = 0; j < 2; j++)
-            m_uvs[2*i+j] = uvCoord[indice][j];
+            m_uvs[2*i+j] = uvCoord[i][j];
     }
 
-    free(order);
+    m_nbIndices = nbLongitude*(nbLatitude-1)*6;
+    m_indices   = order;
+
     free(vertexCoord);
     free(uvCoord);
 }
@@ -0,0 +1,41 @@
+#include "StaticBatch.h"
+#include "TransformKernel.h"
+
+StaticBatch::~StaticBatch()
+{
+    for (Part& p : parts)
+        delete p.mesh;
+}
+
+void StaticBatch::add(Geometry const& g, glm::mat4 const& transform, const ShadingProgram* program, const Material* mtl)
+{
+    nbObjects++;
+    bounds.extend(g.computeAABB().transformed(transform));
+    for (Part& p : parts)
+    {
+        if (p.program == program && p.mtl == mtl)
+        {
+            p.geometry.append(g, transform);
+            return;
+        }
+    }
+    parts.push_back({program, mtl, MergedGeometry(), nullptr});
+    parts.back().geometry.append(g, transform);
+}
+
+void StaticBatch::upload(VertexFormat format)
+{
+    for (Part& p : parts)
+    {
+        if (p.mesh == nullptr)
+            p.mesh = new Mesh(p.geometry, format);
+        p.geometry = MergedGeometry();
+    }
+}
+
+void StaticBatch::record(glm::mat4 const& anchor, RenderFrame& frame) const
+{
+    glm::mat3 invModel3x3 = TransformKernel::normalMatrix(anchor);
+    for (Part const& p : parts)
+        frame.push({p.program, p.mtl, p.mesh, anchor, invModel3x3});
+}
@@ -0,0 +1,109 @@
+#include "TableCollision.h"
+#include <cmath>
+#include <algorithm>
+
+TableCollision::TableCollision(float length, float width, float radius, float railWidth, float cornerMouth, float sideMouth)
+{
+    const float hx = 0.5f * length, hz = 0.5f * width;
+    const float c = cornerMouth / sqrtf(2.f); // from a corner of the table to the ends of its cushions
+    const float s = 0.5f * sideMouth;
+    const float jawAngle = 14.f * 3.14159265f / 180.f; // the side jaws narrow toward the pocket
+
+    // the segments are on the edges of the table or beyond, the centers of the pockets beyond
+    const float margin = std::max(radius, 0.5f * std::max(cornerMouth, sideMouth));
+    clearX = hx - margin;
+    clearZ = hz - margin;
+
+    for (float sign : {-1.f, 1.f})
+    {
+        // the short cushions, then the long ones on each side of the side pocket
+        addCushion(glm::vec2(sign * hx, -hz + c), glm::vec2(sign * hx, hz - c), glm::vec2(-sign, 0.f));
+        addCushion(glm::vec2(-hx + c, sign * hz), glm::vec2(-s, sign * hz), glm::vec2(0.f, -sign));
+        addCushion(glm::vec2(s, sign * hz), glm::vec2(hx - c, sign * hz), glm::vec2(0.f, -sign));
+
+        // the side pocket : its jaws facing each other, and its circle behind the noses
+        for (float side : {-1.f, 1.f})
+        {
+            glm::vec2 a(side * s, sign * hz);
+            addJaw(a, a + railWidth * glm::vec2(-side * sinf(jawAngle), sign * cosf(jawAngle)), glm::vec2(-side, 0.f));
+        }
+        pocketX.push_back(0.f);
+        pocketZ.push_back(sign * (hz + radius));
+        pocketR.push_back(s);
+    }
+
+    // the corner pockets : the jaws go along the diagonal, the mouth stays as wide down to the pocket
+    for (float sx : {-1.f, 1.f})
+        for (float sz : {-1.f, 1.f})
+        {
+            glm::vec2 diagonal = glm::vec2(sx, sz) / sqrtf(2.f);
+            glm::vec2 a1(sx * hx, sz * (hz - c)), a2(sx * (hx - c), sz * hz);
+            addJaw(a1, a1 + railWidth * sqrtf(2.f) * diagonal, a2 - a1);
+            addJaw(a2, a2 + railWidth * sqrtf(2.f) * diagonal, a1 - a2);
+            pocketX.push_back(sx * hx + radius * diagonal.x);
+            pocketZ.push_back(sz * hz + radius * diagonal.y);
+            pocketR.push_back(0.5f * cornerMouth);
+        }
+}
+
+void TableCollision::addCushion(glm::vec2 a, glm::vec2 b, glm::vec2 front)
+{
+    glm::vec2 d = b - a;
+    float l = glm::length(d);
+    d /= l;
+    glm::vec2 n(-d.y, d.x);
+    if (glm::dot(n, front) < 0.f) n = -n;
+
+    ax.push_back(a.x); az.push_back(a.y);
+    dx.push_back(d.x); dz.push_back(d.y);
+    len.push_back(l);
+    nx.push_back(n.x); nz.push_back(n.y);
+}
+
+void TableCollision::addJaw(glm::vec2 a, glm::vec2 b, glm::vec2 front)
+{
+    addCushion(a, b, front);
+    cornerX.push_back(a.x); cornerZ.push_back(a.y);
+    cornerX.push_back(b.x); cornerZ.push_back(b.y);
+}
+
+TableCollision::Segment TableCollision::getSegment(uint32_t k) const
+{
+    Segment s;
+    s.a = glm::vec2(ax[k], az[k]);
+    s.dir = glm::vec2(dx[k], dz[k]);
+    s.length = len[k];
+    s.normal = glm::vec2(nx[k], nz[k]);
+    return s;
+}
+
+float TableCollision::closest(glm::vec2 p, glm::vec2& normal) const
+{
+    // the closest point of each segment, kept by selects : no branch to mispredict in the loop
+    float best = INFINITY, bx = 0.f, bz = 0.f;
+    for (uint32_t k = 0; k < ax.size(); k++)
+    {
+        float ox = p.x - ax[k], oz = p.y - az[k];
+        float t = std::min(std::max(ox * dx[k] + oz * dz[k], 0.f), len[k]);
+        float qx = ox - t * dx[k], qz = oz - t * dz[k];
+        float d2 = qx * qx + qz * qz;
+        bool closer = d2 < best;
+        best = closer ? d2 : best;
+        bx = closer ? qx : bx;
+        bz = closer ? qz : bz;
+    }
+    float d = sqrtf(best);
+    normal = d > 0.f ? glm::vec2(bx, bz) / d : glm::vec2(0.f);
+    return d;
+}
+
+uint32_t TableCollision::pocket(glm::vec2 p) const
+{
+    uint32_t found = NONE;
+    for (uint32_t k = 0; k < pocketX.size(); k++)
+    {
+        float ox = p.x - pocketX[k], oz = p.y - pocketZ[k];
+        found = ox * ox + oz * oz < pocketR[k] * pocketR[k] ? k : found;
+    }
+    return found;
+}
@@ -1,4 +1,5 @@
 #include "Texture.h"
+#include "GLState.h"
 
 #include <SDL2/SDL_image.h>
 
@@ -9,7 +10,7 @@ Texture::Texture(std::string filename)
     SDL_FreeSurface(img);
 
     glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
+    GLState::bindTexture(GL_TEXTURE_2D, texID);
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -17,7 +18,7 @@ Texture::Texture(std::string filename)
       glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, rgbImg->w, rgbImg->h, 0,
                    GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*)rgbImg->pixels);
       glGenerateMipmap(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
 
     w = rgbImg->w;
     h = rgbImg->h;
@@ -27,16 +28,17 @@ Texture::Texture(std::string filename)
 
 Texture::~Texture()
 {
-    glDeleteTextures(1, &texID);
+    GLState::deleteTexture(texID);
 }
 
 void Texture::bind()
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texID);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, texID);
 }
 
 void Texture::unbind()
 {
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
 }
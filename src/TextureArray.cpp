@@ -0,0 +1,68 @@
+#include "TextureArray.h"
+#include "GLState.h"
+#include "logger.h"
+
+#include <SDL2/SDL_image.h>
+
+TextureArray::TextureArray(std::vector<std::string> const& filenames)
+{
+    layers = (int)filenames.size();
+
+    glGenTextures(1, &texID);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D_ARRAY, texID);
+      glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+      glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+      for (int i = 0; i < layers; i++)
+      {
+          SDL_Surface* img = IMG_Load(filenames[i].c_str());
+          if (img == nullptr)
+          {
+              ERROR("could not load '%s' : %s\n", filenames[i].c_str(), IMG_GetError());
+              continue;
+          }
+          SDL_Surface* rgbImg = SDL_ConvertSurfaceFormat(img, SDL_PIXELFORMAT_RGBA32, 0);
+          SDL_FreeSurface(img);
+
+          // the first image gives the size of every layer
+          if (w == 0)
+          {
+              w = rgbImg->w;
+              h = rgbImg->h;
+              glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, w, h, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+          }
+          if (rgbImg->w != w || rgbImg->h != h)
+          {
+              WARNING("'%s' is %dx%d, scaling it to %dx%d for the texture array\n", filenames[i].c_str(), rgbImg->w, rgbImg->h, w, h);
+              SDL_Surface* scaled = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGBA32);
+              SDL_BlitScaled(rgbImg, nullptr, scaled, nullptr);
+              SDL_FreeSurface(rgbImg);
+              rgbImg = scaled;
+          }
+
+          glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, w, h, 1, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*)rgbImg->pixels);
+          SDL_FreeSurface(rgbImg);
+      }
+      if (w != 0) glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+TextureArray::~TextureArray()
+{
+    GLState::deleteTexture(texID);
+}
+
+void TextureArray::bind()
+{
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D_ARRAY, texID);
+}
+
+void TextureArray::unbind()
+{
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
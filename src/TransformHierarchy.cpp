@@ -0,0 +1,80 @@
+#include "TransformHierarchy.h"
+
+uint32_t TransformHierarchy::add(uint32_t parent, glm::mat4 const& propagate, glm::mat4 const& self)
+{
+    uint32_t i = size();
+    parents.push_back(parent);
+    this->propagate.push_back(propagate);
+    this->self.push_back(self);
+    world.push_back(propagate);
+    model.push_back(self);
+    normal.push_back(glm::mat3(1.f));
+    dirty.push_back(1);
+    updated.push_back(0);
+    frozen.push_back(0);
+    return i;
+}
+
+void TransformHierarchy::reserve(uint32_t n)
+{
+    parents.reserve(n);
+    propagate.reserve(n);
+    self.reserve(n);
+    world.reserve(n);
+    model.reserve(n);
+    normal.reserve(n);
+    dirty.reserve(n);
+    updated.reserve(n);
+    frozen.reserve(n);
+}
+
+void TransformHierarchy::remove(std::vector<uint8_t> const& removed)
+{
+    std::vector<uint32_t> remap(size(), (uint32_t)NO_PARENT); // by value : NO_PARENT has no definition to bind a reference to
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < size(); i++)
+    {
+        if (removed[i]) continue;
+        remap[i] = j;
+        parents[j] = parents[i] == NO_PARENT ? NO_PARENT : remap[parents[i]];
+        propagate[j] = propagate[i];
+        self[j] = self[i];
+        world[j] = world[i];
+        model[j] = model[i];
+        normal[j] = normal[i];
+        dirty[j] = dirty[i];
+        updated[j] = updated[i];
+        frozen[j] = frozen[i];
+        j++;
+    }
+    parents.resize(j);
+    propagate.resize(j);
+    self.resize(j);
+    world.resize(j);
+    model.resize(j);
+    normal.resize(j);
+    dirty.resize(j);
+    updated.resize(j);
+    frozen.resize(j);
+}
+
+void TransformHierarchy::update()
+{
+    // the parent of a node is always before it : we already know if it changed,
+    // and the kernel computes its world matrix before those of its childs
+    uint32_t n = size();
+    batch.clear();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (frozen[i]) continue; // updated[i] stays 0, and so do those of its descendants, frozen too
+        uint32_t p = parents[i];
+        updated[i] = dirty[i] || (p != NO_PARENT && updated[p]);
+        if (!updated[i]) continue;
+
+        dirty[i] = 0;
+        batch.push_back(i);
+    }
+    nbUpdated = (uint32_t)batch.size();
+    TransformKernel::compose(batch.data(), nbUpdated, parents.data(), propagate.data(), self.data(),
+                             world.data(), model.data(), normal.data());
+}
@@ -0,0 +1,225 @@
+#include "TransformKernel.h"
+#include <cmath>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define KERNEL_SSE
+#define KERNEL_AVX
+#define TARGET(t) __attribute__((target(t)))
+#elif defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define KERNEL_SSE
+#define TARGET(t)
+#endif
+
+namespace {
+
+void mul2Scalar(glm::mat4 const& w, glm::mat4 const& p, glm::mat4 const& s, glm::mat4& world, glm::mat4& model)
+{
+    world = w * p;
+    model = w * s;
+}
+
+#if defined(KERNEL_SSE)
+// out = a * b, a column of out is a combination of the columns of a
+TARGET("sse")
+void mulSSE(glm::mat4 const& a, glm::mat4 const& b, glm::mat4& out)
+{
+    __m128 c0 = _mm_loadu_ps(&a[0][0]), c1 = _mm_loadu_ps(&a[1][0]);
+    __m128 c2 = _mm_loadu_ps(&a[2][0]), c3 = _mm_loadu_ps(&a[3][0]);
+    for (int j = 0; j < 4; j++)
+    {
+        __m128 bj = _mm_loadu_ps(&b[j][0]);
+        __m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(bj, bj, 0x00));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(bj, bj, 0x55)));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(bj, bj, 0xAA)));
+        r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(bj, bj, 0xFF)));
+        _mm_storeu_ps(&out[j][0], r);
+    }
+}
+
+TARGET("sse")
+void mul2SSE(glm::mat4 const& w, glm::mat4 const& p, glm::mat4 const& s, glm::mat4& world, glm::mat4& model)
+{
+    mulSSE(w, p, world);
+    mulSSE(w, s, model);
+}
+#endif
+
+#if defined(KERNEL_AVX)
+// world = w * p and model = w * s, the columns of p in the low lanes and those of s in the high lanes
+TARGET("avx")
+void mul2AVX(glm::mat4 const& w, glm::mat4 const& p, glm::mat4 const& s, glm::mat4& world, glm::mat4& model)
+{
+    __m256 c[4];
+    for (int k = 0; k < 4; k++)
+    {
+        __m128 col = _mm_loadu_ps(&w[k][0]);
+        c[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(col), col, 1);
+    }
+    for (int j = 0; j < 4; j++)
+    {
+        __m256 b = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&p[j][0])), _mm_loadu_ps(&s[j][0]), 1);
+        __m256 r = _mm256_mul_ps(c[0], _mm256_permute_ps(b, 0x00));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c[1], _mm256_permute_ps(b, 0x55)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c[2], _mm256_permute_ps(b, 0xAA)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c[3], _mm256_permute_ps(b, 0xFF)));
+        _mm_storeu_ps(&world[j][0], _mm256_castps256_ps128(r));
+        _mm_storeu_ps(&model[j][0], _mm256_extractf128_ps(r, 1));
+    }
+}
+#endif
+
+// the loop of compose(), once per instruction set : the products are inlined in it
+void composeScalar(const uint32_t* nodes, uint32_t count, const uint32_t* parents, const glm::mat4* propagate,
+                   const glm::mat4* self, glm::mat4* world, glm::mat4* model, glm::mat3* normal)
+{
+    for (uint32_t k = 0; k < count; k++)
+    {
+        uint32_t i = nodes[k];
+        uint32_t p = parents[i];
+        if (p == TransformKernel::NO_PARENT)
+        {
+            world[i] = propagate[i];
+            model[i] = self[i];
+        }
+        else mul2Scalar(world[p], propagate[i], self[i], world[i], model[i]);
+        normal[i] = TransformKernel::normalMatrix(model[i]);
+    }
+}
+
+#if defined(KERNEL_SSE)
+TARGET("sse")
+void composeSSE(const uint32_t* nodes, uint32_t count, const uint32_t* parents, const glm::mat4* propagate,
+                const glm::mat4* self, glm::mat4* world, glm::mat4* model, glm::mat3* normal)
+{
+    for (uint32_t k = 0; k < count; k++)
+    {
+        uint32_t i = nodes[k];
+        uint32_t p = parents[i];
+        if (p == TransformKernel::NO_PARENT)
+        {
+            world[i] = propagate[i];
+            model[i] = self[i];
+        }
+        else mul2SSE(world[p], propagate[i], self[i], world[i], model[i]);
+        normal[i] = TransformKernel::normalMatrix(model[i]);
+    }
+}
+#endif
+
+#if defined(KERNEL_AVX)
+TARGET("avx")
+void composeAVX(const uint32_t* nodes, uint32_t count, const uint32_t* parents, const glm::mat4* propagate,
+                const glm::mat4* self, glm::mat4* world, glm::mat4* model, glm::mat3* normal)
+{
+    for (uint32_t k = 0; k < count; k++)
+    {
+        uint32_t i = nodes[k];
+        uint32_t p = parents[i];
+        if (p == TransformKernel::NO_PARENT)
+        {
+            world[i] = propagate[i];
+            model[i] = self[i];
+        }
+        else mul2AVX(world[p], propagate[i], self[i], world[i], model[i]);
+        normal[i] = TransformKernel::normalMatrix(model[i]);
+    }
+}
+#endif
+
+TransformKernel::Path detect()
+{
+#if defined(KERNEL_AVX)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx")) return TransformKernel::Path::AVX;
+    if (__builtin_cpu_supports("sse")) return TransformKernel::Path::SSE;
+    return TransformKernel::Path::Scalar;
+#elif defined(KERNEL_SSE)
+    return TransformKernel::Path::SSE;
+#else
+    return TransformKernel::Path::Scalar;
+#endif
+}
+
+const TransformKernel::Path best = detect();
+TransformKernel::Path current = best;
+
+}
+
+void TransformKernel::compose(const uint32_t* nodes, uint32_t count, const uint32_t* parents,
+                              const glm::mat4* propagate, const glm::mat4* self,
+                              glm::mat4* world, glm::mat4* model, glm::mat3* normal)
+{
+    switch (current)
+    {
+#if defined(KERNEL_AVX)
+        case Path::AVX: composeAVX(nodes, count, parents, propagate, self, world, model, normal); break;
+#endif
+#if defined(KERNEL_SSE)
+        case Path::SSE: composeSSE(nodes, count, parents, propagate, self, world, model, normal); break;
+#endif
+        default: composeScalar(nodes, count, parents, propagate, self, world, model, normal); break;
+    }
+}
+
+void TransformKernel::composeReference(const uint32_t* nodes, uint32_t count, const uint32_t* parents,
+                                       const glm::mat4* propagate, const glm::mat4* self,
+                                       glm::mat4* world, glm::mat4* model, glm::mat3* normal)
+{
+    for (uint32_t k = 0; k < count; k++)
+    {
+        uint32_t i = nodes[k];
+        uint32_t p = parents[i];
+        if (p == NO_PARENT)
+        {
+            world[i] = propagate[i];
+            model[i] = self[i];
+        }
+        else
+        {
+            world[i] = world[p] * propagate[i];
+            model[i] = world[p] * self[i];
+        }
+        normal[i] = glm::inverse(glm::mat3(model[i]));
+    }
+}
+
+glm::mat3 TransformKernel::normalMatrix(glm::mat4 const& m)
+{
+    // m = R * diag(s) : inverse = diag(1/s) * transpose(R), the row k of which is the column k of m divided by s_k^2
+    glm::vec3 c0 = glm::vec3(m[0]), c1 = glm::vec3(m[1]), c2 = glm::vec3(m[2]);
+    float l0 = glm::dot(c0, c0), l1 = glm::dot(c1, c1), l2 = glm::dot(c2, c2);
+    const float tolerance = 1e-8f; // on the squared cosine of the angle between two columns
+    if (l0 > 0.f && l1 > 0.f && l2 > 0.f &&
+        glm::dot(c0, c1) * glm::dot(c0, c1) <= tolerance * l0 * l1 &&
+        glm::dot(c0, c2) * glm::dot(c0, c2) <= tolerance * l0 * l2 &&
+        glm::dot(c1, c2) * glm::dot(c1, c2) <= tolerance * l1 * l2)
+        return glm::transpose(glm::mat3(c0 / l0, c1 / l1, c2 / l2));
+    return glm::inverse(glm::mat3(m));
+}
+
+TransformKernel::Path TransformKernel::getBestPath()
+{
+    return best;
+}
+
+TransformKernel::Path TransformKernel::getPath()
+{
+    return current;
+}
+
+void TransformKernel::setPath(Path path)
+{
+    current = path <= best ? path : best;
+}
+
+const char* TransformKernel::getName(Path path)
+{
+    switch (path)
+    {
+        case Path::AVX: return "avx";
+        case Path::SSE: return "sse";
+        default: return "scalar";
+    }
+}
@@ -0,0 +1,117 @@
+#include "UniformBuffer.h"
+#include "GLState.h"
+#include "logger.h"
+
+#include <cstring>
+
+FrameUniformBuffer::FrameUniformBuffer()
+{
+    glGenBuffers(1, &bufferID);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, bufferID);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameBlock), nullptr, GL_STREAM_DRAW);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+FrameUniformBuffer::~FrameUniformBuffer()
+{
+    GLState::deleteBuffer(bufferID);
+}
+
+void FrameUniformBuffer::update(glm::mat4 const& view, glm::mat4 const& projection, glm::vec3 const& cameraPosition, const Light* lights, uint32_t nbLights)
+{
+    if (nbLights > MAX_LIGHTS) nbLights = MAX_LIGHTS;
+
+    block.view           = view;
+    block.projection     = projection;
+    block.viewProjection = projection * view;
+    block.cameraPosition = glm::vec4(cameraPosition, 1.f);
+    block.nbLights       = glm::ivec4(nbLights, 0, 0, 0);
+    for (uint32_t i = 0; i < nbLights; i++)
+    {
+        block.lightPos[i]   = glm::vec4(lights[i].getPosition(), 1.f);
+        block.lightColor[i] = glm::vec4(lights[i].getColor(), 1.f);
+    }
+
+    // the draws of the previous frame may still read the buffer : its storage is orphaned (the driver hands
+    // a fresh one) instead of waiting for them
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, bufferID);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameBlock), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameBlock), &block);
+    GLState::bindUniformBufferBase(FRAME_BLOCK_BINDING, bufferID);
+}
+
+UniformRing::UniformRing(GLuint binding, size_t blockSize, size_t blocksPerFrame) : binding(binding), blockSize(blockSize)
+{
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    stride = (blockSize + alignment - 1) / alignment * alignment;
+
+    glGenBuffers(1, &bufferID);
+    segmentSize = stride * blocksPerFrame;
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, bufferID);
+    glBufferData(GL_UNIFORM_BUFFER, segmentSize * NB_SEGMENTS, nullptr, GL_STREAM_DRAW);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+UniformRing::~UniformRing()
+{
+    for (uint32_t i = 0; i < NB_SEGMENTS; i++)
+        if (fences[i] != nullptr) glDeleteSync(fences[i]);
+    GLState::deleteBuffer(bufferID);
+}
+
+void UniformRing::begin(size_t nbBlocks)
+{
+    // the draws using the current segment have all been issued : fence it, then move to the next one
+    if (fences[segment] != nullptr) glDeleteSync(fences[segment]);
+    fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    segment = (segment + 1) % NB_SEGMENTS;
+    used = 0;
+
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, bufferID);
+    if (nbBlocks * stride > segmentSize)
+    {
+        // grow : the old storage is orphaned, so nothing to wait for
+        segmentSize = nbBlocks * stride * 2;
+        glBufferData(GL_UNIFORM_BUFFER, segmentSize * NB_SEGMENTS, nullptr, GL_STREAM_DRAW);
+        for (uint32_t i = 0; i < NB_SEGMENTS; i++)
+        {
+            if (fences[i] != nullptr) glDeleteSync(fences[i]);
+            fences[i] = nullptr;
+        }
+    }
+    else if (fences[segment] != nullptr)
+    {
+        // only blocks if the GPU is more than NB_SEGMENTS-1 frames late
+        glClientWaitSync(fences[segment], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(fences[segment]);
+        fences[segment] = nullptr;
+    }
+
+    if (nbBlocks == 0) return;
+    mapped = (uint8_t*)glMapBufferRange(GL_UNIFORM_BUFFER, segment * segmentSize, nbBlocks * stride,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (mapped == nullptr)
+        ERROR("could not map the uniform ring\n");
+}
+
+GLintptr UniformRing::push(const void* data)
+{
+    GLintptr offset = segment * segmentSize + used;
+    if (mapped != nullptr) memcpy(mapped + used, data, blockSize);
+    used += stride;
+    return offset;
+}
+
+void UniformRing::end()
+{
+    if (mapped == nullptr) return;
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, bufferID);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+    mapped = nullptr;
+}
+
+void UniformRing::bind(GLintptr offset) const
+{
+    GLState::bindUniformBufferRange(binding, bufferID, offset, blockSize);
+}
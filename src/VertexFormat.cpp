@@ -0,0 +1,116 @@
+#include "VertexFormat.h"
+#include <cstring>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#define INDICE_TO_PTR(x) ((void*)(uintptr_t)(x))
+
+/* \brief Fold a normal on the octahedron |x|+|y|+|z| = 1, then unfold the lower half on the square [-1, 1]²*/
+static glm::vec2 encodeOctahedral(glm::vec3 n)
+{
+    n /= (fabsf(n.x) + fabsf(n.y) + fabsf(n.z));
+    glm::vec2 e(n.x, n.y);
+    if(n.z < 0.0f)
+        e = glm::vec2((1.0f - fabsf(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+                      (1.0f - fabsf(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+    return e;
+}
+
+VertexFormat VertexFormat::fit(const Geometry& g) const
+{
+    VertexFormat f = *this;
+    for(uint32_t i = 0; i < 3*g.getNbVertices(); i++)
+        if(f.position == Position::Snorm16 && fabsf(g.getVertices()[i]) > 1.0f)
+            f.position = Position::Half;
+    for(uint32_t i = 0; i < 2*g.getNbVertices(); i++)
+        if(f.uv == UV::Unorm16 && (g.getUVs()[i] < 0.0f || g.getUVs()[i] > 1.0f))
+            f.uv = UV::Float;
+    return f;
+}
+
+uint32_t VertexFormat::getNormalOffset() const
+{
+    return position == Position::Float ? 12 : 8;
+}
+
+uint32_t VertexFormat::getUVOffset() const
+{
+    return getNormalOffset() + (normal == Normal::Float ? 12 : 4);
+}
+
+uint32_t VertexFormat::getStride() const
+{
+    return getUVOffset() + (uv == UV::Float ? 8 : 4);
+}
+
+void VertexFormat::pack(const Geometry& g, uint8_t* dst) const
+{
+    uint32_t stride = getStride();
+    uint32_t normalOffset = getNormalOffset(), uvOffset = getUVOffset();
+    memset(dst, 0, (uint64_t)stride*g.getNbVertices());
+
+    for(uint32_t i = 0; i < g.getNbVertices(); i++)
+    {
+        uint8_t* v = dst + (uint64_t)stride*i;
+        const float* p  = g.getVertices() + 3*i;
+        const float* n  = g.getNormals()  + 3*i;
+        const float* t  = g.getUVs()      + 2*i;
+
+        uint16_t packed[3];
+        switch(position)
+        {
+            case Position::Float:
+                memcpy(v, p, 3*sizeof(float));
+                break;
+            case Position::Half:
+                for(int k = 0; k < 3; k++) packed[k] = glm::packHalf1x16(p[k]);
+                memcpy(v, packed, sizeof(packed));
+                break;
+            case Position::Snorm16:
+                for(int k = 0; k < 3; k++) packed[k] = glm::packSnorm1x16(p[k]);
+                memcpy(v, packed, sizeof(packed));
+                break;
+        }
+
+        if(normal == Normal::Float)
+            memcpy(v + normalOffset, n, 3*sizeof(float));
+        else
+        {
+            glm::vec2 e = encodeOctahedral(glm::vec3(n[0], n[1], n[2]));
+            packed[0] = glm::packSnorm1x16(e.x);
+            packed[1] = glm::packSnorm1x16(e.y);
+            memcpy(v + normalOffset, packed, 2*sizeof(uint16_t));
+        }
+
+        if(uv == UV::Float)
+            memcpy(v + uvOffset, t, 2*sizeof(float));
+        else
+        {
+            packed[0] = glm::packUnorm1x16(t[0]);
+            packed[1] = glm::packUnorm1x16(t[1]);
+            memcpy(v + uvOffset, packed, 2*sizeof(uint16_t));
+        }
+    }
+}
+
+void VertexFormat::setupAttributes() const
+{
+    GLsizei stride = getStride();
+    switch(position)
+    {
+        case Position::Float:   glVertexAttribPointer(0, 3, GL_FLOAT,      GL_FALSE, stride, 0); break;
+        case Position::Half:    glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, stride, 0); break;
+        case Position::Snorm16: glVertexAttribPointer(0, 3, GL_SHORT,      GL_TRUE,  stride, 0); break;
+    }
+
+    if(uv == UV::Float) glVertexAttribPointer(1, 2, GL_FLOAT,          GL_FALSE, stride, INDICE_TO_PTR(getUVOffset()));
+    else                glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE,  stride, INDICE_TO_PTR(getUVOffset()));
+
+    if(normal == Normal::Float) glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, INDICE_TO_PTR(getNormalOffset()));
+    else                        glVertexAttribPointer(2, 2, GL_SHORT, GL_TRUE,  stride, INDICE_TO_PTR(getNormalOffset()));
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+}
@@ -0,0 +1,72 @@
+#include "World.h"
+
+namespace {
+
+// calls f(column, bit) for each component column of an archetype
+template <typename Columns, typename F, size_t... I>
+void forColumns(Columns& columns, F&& f, std::index_sequence<I...>)
+{
+    int expand[] = {0, (f(std::get<I>(columns), (uint32_t)I), 0)...};
+    (void)expand;
+}
+
+template <typename Columns, typename F>
+void forColumns(Columns& columns, F&& f)
+{
+    forColumns(columns, std::forward<F>(f), std::make_index_sequence<std::tuple_size<Columns>::value>());
+}
+
+}
+
+void World::destroy(Entity e)
+{
+    Record* r = records.get(e);
+    if (r == nullptr) return;
+    removeRow(r->archetype, r->row);
+    records.destroy(e);
+}
+
+uint32_t World::findArchetype(Mask mask)
+{
+    auto it = archetypeOf.find(mask);
+    if (it != archetypeOf.end()) return it->second;
+
+    uint32_t a = (uint32_t)archetypes.size();
+    archetypes.emplace_back();
+    archetypes[a].mask = mask;
+    archetypeOf[mask] = a;
+    return a;
+}
+
+void World::move(Record& r, Mask mask)
+{
+    uint32_t to = findArchetype(mask); // before taking references : it may add an archetype
+    Archetype& src = archetypes[r.archetype];
+    Archetype& dst = archetypes[to];
+
+    // the columns of the new archetype that the old one has too, the others are filled by the caller
+    uint32_t row = r.row;
+    forColumns(src.columns, [&](auto& column, uint32_t bit) {
+        if (src.mask & (1u << bit)) std::get<std::remove_reference_t<decltype(column)>>(dst.columns).push_back(column[row]);
+    });
+    Entity e = src.entities[row];
+    dst.entities.push_back(e);
+
+    removeRow(r.archetype, row);
+    r.archetype = to;
+    r.row = dst.size() - 1;
+}
+
+void World::removeRow(uint32_t archetype, uint32_t row)
+{
+    Archetype& a = archetypes[archetype];
+    uint32_t last = a.size() - 1;
+    forColumns(a.columns, [&](auto& column, uint32_t bit) {
+        if ((a.mask & (1u << bit)) == 0) return;
+        column[row] = column[last];
+        column.pop_back();
+    });
+    a.entities[row] = a.entities[last];
+    a.entities.pop_back();
+    if (row < last) records.get(a.entities[row])->row = row;
+}
@@ -14,12 +14,15 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <cstdint>
+#include <cctype>
 #include <vector>
 #include <stack>
 
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <memory>
+#include <algorithm>
 
 #include "Shader.h"
 #include "logger.h"
@@ -32,82 +35,110 @@
 #include "LensFlare.h"
 #include "Camera.h"
 #include "Material.h"
+#include "Mesh.h"
+#include "ShadingProgram.h"
+#include "RenderQueue.h"
+#include "UniformBuffer.h"
+#include "Scene.h"
+#include "InstanceBatch.h"
+#include "GLState.h"
+#include "Benchmark.h"
+#include "World.h"
+#include "RenderSystem.h"
+#include "BallPhysics.h"
 
 #define WIDTH     800
 #define HEIGHT    600
 #define FRAMERATE 60
 #define TIME_PER_FRAME_MS  (1.0f/FRAMERATE * 1e3)
-#define INDICE_TO_PTR(x) ((void*)(x))
 
 #define NB_TEXTURE_BOULE 15
 
-struct GameObjectGraph {
-    GLuint vboID = 0;
-    Material mtl = { {1,1,1},0.2,0.2,0.2,1 };
-    unsigned int nb_vertices = 0;
-    glm::mat4 matrix_local = glm::mat4(1.0f);           // pour repercuter la modif sur cet objet uniquement et pas ses enfants
-    glm::mat4 matrix_propagated = glm::mat4(1.0f);      // pour repercuter la modif sur lui et aussi ses enfants
-    Shader* shader = nullptr;
-
-    std::vector<GameObjectGraph*> children;
-};
-
-void draw(GameObjectGraph& go, std::stack<glm::mat4>& matrices, const Light& light, const glm::vec3& cameraPosition, const glm::mat4& view_projection) {
-
-    matrices.push(matrices.top() * go.matrix_propagated);
-
-    glm::mat4 model = matrices.top() * go.matrix_local;
-    glm::mat3 invModel3x3 = glm::inverse(glm::mat3(model));
-    glm::mat4 mvp = view_projection * model;
+int main(int argc, char* argv[])
+{
+    ////////////////////////////////////////
+    //Command line :
+    //  --benchmark [n]  : measure n frames (300 by default) without framerate limit, print the timings and exit
+    //  --legacy-attribs : set up the vertex attributes for every object instead of binding its VAO (to compare)
+    //  --bench-transforms [n] : compare the transform kernel against glm on n nodes (10000 by default) and exit
+    //  --bench-physics : time the simulation of a break on the table of Assets/salle.scene, check random breaks and exit
+    //  --event-physics : simulate the balls event driven (collisions at their exact time) instead of by fixed steps
+    //  --bench-broadphase [n] : time the collision grid and a physics step from 16 to n balls (100000 by default) and exit
+    //  --bench-narrowphase : time the collision tests of each instruction set, check them against the scalar path and exit
+    ////////////////////////////////////////
 
-    glUseProgram(go.shader->getProgramID());
+    //La physique des boules utilise les dimensions du fichier de la scene
+    auto parametresPhysique = [](SceneFile const& salle) {
+        BallPhysics::Params parametres;
+        parametres.length = salle.getVar("longueurTable");
+        parametres.width = salle.getVar("largeurTable");
+        parametres.radius = salle.getVar("rayonBoules");
+        parametres.unitsPerMeter = parametres.length / 2.54f; //une table de 9 pieds mesure 2.54 m
+        //Les bandes : le nez en haut des bords, les poches entre leurs extremites
+        parametres.noseHeight = 0.5f * (salle.getVar("hauteurBord") - salle.getVar("hauteurTable"));
+        parametres.railWidth = salle.getVar("longueurBordC");
+        parametres.cornerMouth = salle.getVar("ouverturePocheCoin");
+        parametres.sideMouth = salle.getVar("ouverturePocheMilieu");
+        return parametres;
+    };
+
+    uint32_t benchmarkFrames = 0;
+    bool legacyAttribs = false;
+    BallPhysics::Mode modePhysique = BallPhysics::Mode::FixedStep;
+    for (int i = 1; i < argc; i++)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, go.vboID);
-
-
-        //VBO
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, INDICE_TO_PTR(go.nb_vertices * (3 + 3) * sizeof(float)));
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, INDICE_TO_PTR(go.nb_vertices * 3 * sizeof(float)));
-        glEnableVertexAttribArray(0);
-        glEnableVertexAttribArray(1);
-        glEnableVertexAttribArray(2);
-
-
-        //Uniform for vertex shader
-        GLint uMVP         = glGetUniformLocation(go.shader->getProgramID(), "uMVP");
-        GLint uModel       = glGetUniformLocation(go.shader->getProgramID(), "uModel");
-        GLint uInvModel3x3 = glGetUniformLocation(go.shader->getProgramID(), "uInvModel3x3");
-        glUniformMatrix4fv(uMVP,         1, GL_FALSE, glm::value_ptr(mvp        ));
-        glUniformMatrix4fv(uModel,       1, GL_FALSE, glm::value_ptr(model      ));
-        glUniformMatrix3fv(uInvModel3x3, 1, GL_FALSE, glm::value_ptr(invModel3x3));
-
-        GLint uMtlColor       = glGetUniformLocation(go.shader->getProgramID(), "uMtlColor"      );
-        GLint uMtlCts         = glGetUniformLocation(go.shader->getProgramID(), "uMtlCts"        );
-        GLint uLightPos       = glGetUniformLocation(go.shader->getProgramID(), "uLightPos"      );
-        GLint uLightColor     = glGetUniformLocation(go.shader->getProgramID(), "uLightColor"    );
-        GLint uCameraPosition = glGetUniformLocation(go.shader->getProgramID(), "uCameraPosition");
-        glUniform3fv(uMtlColor,       1, glm::value_ptr(go.mtl.getColor  ()));
-        glUniform4fv(uMtlCts,         1, glm::value_ptr(go.mtl.getCoefs  ()));
-        glUniform3fv(uLightPos,       1, glm::value_ptr(light.getPosition()));
-        glUniform3fv(uLightColor,     1, glm::value_ptr(light.getColor   ()));
-        glUniform3fv(uCameraPosition, 1, glm::value_ptr(cameraPosition     ));
-
-        if (go.mtl.getTexture() != nullptr) go.mtl.getTexture()->bind();
-        glDrawArrays(GL_TRIANGLES, 0, go.nb_vertices);
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
-    glUseProgram(0);
-
-    for (size_t i = 0; i < go.children.size(); i++) {
-        draw(*(go.children[i]), matrices, light, cameraPosition, view_projection);
+        std::string arg = argv[i];
+        if (arg == "--benchmark")
+        {
+            benchmarkFrames = 300;
+            if (i + 1 < argc && isdigit(argv[i + 1][0]))
+                benchmarkFrames = (uint32_t)std::stoul(argv[++i]);
+        }
+        else if (arg == "--legacy-attribs")
+            legacyAttribs = true;
+        else if (arg == "--event-physics")
+            modePhysique = BallPhysics::Mode::EventDriven; //les collisions au temps exact au lieu de pas fixes
+        else if (arg == "--bench-transforms")
+        {
+            uint32_t nbNodes = 10000;
+            if (i + 1 < argc && isdigit(argv[i + 1][0]))
+                nbNodes = (uint32_t)std::stoul(argv[++i]);
+            Benchmark::transforms(nbNodes); //sans fenetre ni contexte openGL
+            return 0;
+        }
+        else if (arg == "--bench-physics")
+        {
+            SceneFile* salle = SceneFile::openCompiled("Assets/salle.scene", "Assets/salle.scnb");
+            if (salle == nullptr) return EXIT_FAILURE;
+            bool ok = Benchmark::physics(parametresPhysique(*salle));
+            delete salle;
+            return ok ? 0 : EXIT_FAILURE;
+        }
+        else if (arg == "--bench-narrowphase")
+        {
+            SceneFile* salle = SceneFile::openCompiled("Assets/salle.scene", "Assets/salle.scnb");
+            if (salle == nullptr) return EXIT_FAILURE;
+            bool ok = Benchmark::narrowphase(parametresPhysique(*salle)); //chaque jeu d'instructions du processeur
+            delete salle;
+            return ok ? 0 : EXIT_FAILURE;
+        }
+        else if (arg == "--bench-broadphase")
+        {
+            uint32_t nbBoules = 100000;
+            if (i + 1 < argc && isdigit(argv[i + 1][0]))
+                nbBoules = (uint32_t)std::stoul(argv[++i]);
+            SceneFile* salle = SceneFile::openCompiled("Assets/salle.scene", "Assets/salle.scnb");
+            if (salle == nullptr) return EXIT_FAILURE;
+            Benchmark::broadphase(parametresPhysique(*salle), nbBoules); //des tables agrandies avec les boules
+            delete salle;
+            return 0;
+        }
+        else
+            WARNING("Unknown option '%s'\n", argv[i]);
     }
+    bool benchmarking = benchmarkFrames > 0;
+    Benchmark benchmark(benchmarkFrames);
 
-    matrices.pop();
-};
-
-int main(int argc, char* argv[])
-{
     ////////////////////////////////////////
     //SDL2 / OpenGL Context initialization : 
     ////////////////////////////////////////
@@ -142,6 +173,16 @@ int main(int argc, char* argv[])
     glewExperimental = GL_TRUE;
     glewInit();
 
+    //Instanced attributes (glVertexAttribDivisor) need OpenGL 3.3
+    if (!GLEW_VERSION_3_3) {
+        ERROR("OpenGL 3.3 is required, the context only provides %s\n", glGetString(GL_VERSION));
+        return EXIT_FAILURE;
+    }
+
+    //No vsync when benchmarking, we want the CPU time of a frame
+    if (benchmarking)
+        SDL_GL_SetSwapInterval(0);
+
 
     //Start using OpenGL to draw something on screen
     glViewport(0, 0, WIDTH, HEIGHT); //Draw on ALL the screen
@@ -149,7 +190,8 @@ int main(int argc, char* argv[])
     //The OpenGL background color (RGBA, each component between 0.0f and 1.0f)
     glClearColor(0.0, 0.0, 0.0, 1.0); //Full Black
 
-    glEnable(GL_DEPTH_TEST); //Active the depth test
+    GLState::invalidate(); //Nothing is known about the state of the new context
+    GLState::enable(GL_DEPTH_TEST); //Active the depth test
 
 
     //Formes
@@ -168,317 +210,107 @@ int main(int argc, char* argv[])
     Light light({0.0f, 8.2f, -10.0f}, {1.0f, 0.9f, 0.7f});
 
 
-    GLuint vboCube; //id
-    glGenBuffers(1, &vboCube);//buffer
-
-    glBindBuffer(GL_ARRAY_BUFFER, vboCube);
-
-    glBufferData(GL_ARRAY_BUFFER, cube.getNbVertices() * (3 + 3) * sizeof(float), NULL, GL_DYNAMIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, cube.getNbVertices() * 3 * sizeof(float), cube.getVertices());
-    glBufferSubData(GL_ARRAY_BUFFER, cube.getNbVertices() * 3 * sizeof(float), cube.getNbVertices() * 3 * sizeof(float), cube.getNormals());
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    GLuint vboSphere;
-    glGenBuffers(1, &vboSphere);
-    glBindBuffer(GL_ARRAY_BUFFER, vboSphere);
-    glBufferData(GL_ARRAY_BUFFER, sphere.getNbVertices() * (3 + 3 + 2) * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sphere.getNbVertices() * 3 * sizeof(float), sphere.getVertices());
-    glBufferSubData(GL_ARRAY_BUFFER, sphere.getNbVertices() * 3 * sizeof(float), sphere.getNbVertices() * 3 * sizeof(float), sphere.getNormals());
-    glBufferSubData(GL_ARRAY_BUFFER, sphere.getNbVertices() * (3 + 3) * sizeof(float), sphere.getNbVertices() * 2 * sizeof(float), sphere.getUVs());
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    GLuint vboCone; //id
-    glGenBuffers(1, &vboCone);//buffer
-
-    glBindBuffer(GL_ARRAY_BUFFER, vboCone);
-
-    glBufferData(GL_ARRAY_BUFFER, cone.getNbVertices() * (3 + 3) * sizeof(float), NULL, GL_DYNAMIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, cone.getNbVertices() * 3 * sizeof(float), cone.getVertices());
-    glBufferSubData(GL_ARRAY_BUFFER, cone.getNbVertices() * 3 * sizeof(float), cone.getNbVertices() * 3 * sizeof(float), cone.getNormals());
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
     const char* vertPath = "Shaders/shading.vert";
     const char* fragPath = "Shaders/shading.frag";
 
-    FILE* vertFile = fopen(vertPath, "r");
-    FILE* fragFile = fopen(fragPath, "r");
-
-    Shader* shader = Shader::loadFromFiles(vertFile, fragFile);
-
-    fclose(vertFile);
-    fclose(fragFile);
+    ShadingProgram* shader = ShadingProgram::loadFromFiles(vertPath, fragPath);
 
     if (shader == nullptr) {
-        std::cerr << "The shader 'color' did not compile correctly. Exiting." << std::endl;
+        std::cerr << "The shader 'shading' did not load correctly. Exiting." << std::endl;
         return EXIT_FAILURE;
     }
 
-    glUseProgram(shader->getProgramID()); {
-        GLint uTexture = glGetUniformLocation(shader->getProgramID(), "uTexture");
-        glUniform1i(uTexture, 0);
-    } glUseProgram(0);
-
-    float coteSolPlafondMur = 20.0f;
-    float epaisseurSolplafondMur = 0.5f;
-
-    float hauteurMur = 12.0f;
-
-    float hauteurTige = 2.2f;
-    float coteTige = 0.3f;
-
-    //Table (+ bords + pieds)
-    float longueurTable = 8.0f;
-    float hauteurTable = 0.5f;
-    float largeurTable = 4.0f;
-
-    float longueurPieds = 0.3f;
-    float hauteurPieds = 1.5f;
-    float largeurPieds = 0.3f;
-
-    float longueurBordC = 0.4f;
-    float largeurBordC = largeurTable + 2 * longueurBordC;
-    float hauteurBord = hauteurTable + 0.1f;
-    float longueurBordL = longueurTable + 2 * longueurBordC;
-    float largeurBordL = longueurBordC;
-
-
-    GameObjectGraph Mur1;
-    GameObjectGraph Mur2;
-    GameObjectGraph Mur3;
-    GameObjectGraph Sol;
-    GameObjectGraph Plafond;
-    GameObjectGraph TigeLampe;
-    GameObjectGraph BaseLampe;
-    GameObjectGraph Ampoule;
-
-    GameObjectGraph Table;
-    GameObjectGraph Pied1;
-    GameObjectGraph Pied2;
-    GameObjectGraph Pied3;
-    GameObjectGraph Pied4;
-    GameObjectGraph BordC1;
-    GameObjectGraph BordC2;
-    GameObjectGraph BordL1;
-    GameObjectGraph BordL2;
-
-    Sol.children.push_back(&Table);
-    Sol.children.push_back(&Mur1);
-    Sol.children.push_back(&Mur2);
-    Sol.children.push_back(&Mur3);
-    Sol.children.push_back(&Plafond);
-
-    Plafond.children.push_back(&TigeLampe);
-
-    TigeLampe.children.push_back(&BaseLampe);
-    BaseLampe.children.push_back(&Ampoule);
-
-    Table.children.push_back(&Pied1);
-    Table.children.push_back(&Pied2);
-    Table.children.push_back(&Pied3);
-    Table.children.push_back(&Pied4);
-    Table.children.push_back(&BordC1);
-    Table.children.push_back(&BordC2);
-    Table.children.push_back(&BordL1);
-    Table.children.push_back(&BordL2);
-
-    Sol.nb_vertices = cube.getNbVertices();
-    Mur1.nb_vertices = cube.getNbVertices();
-    Mur2.nb_vertices = cube.getNbVertices();
-    Mur3.nb_vertices = cube.getNbVertices();
-    Plafond.nb_vertices = cube.getNbVertices();
-
-    TigeLampe.nb_vertices = cube.getNbVertices();
-    BaseLampe.nb_vertices = cone.getNbVertices();
-    Ampoule.nb_vertices = sphere.getNbVertices();
-
-
-    Table.nb_vertices = cube.getNbVertices();
-
-    Pied1.nb_vertices = cube.getNbVertices();
-    Pied2.nb_vertices = cube.getNbVertices();
-    Pied3.nb_vertices = cube.getNbVertices();
-    Pied4.nb_vertices = cube.getNbVertices();
-
-    BordC1.nb_vertices = cube.getNbVertices();
-    BordC2.nb_vertices = cube.getNbVertices();
-    BordL1.nb_vertices = cube.getNbVertices();
-    BordL2.nb_vertices = cube.getNbVertices();
-
-    Sol.vboID = vboCube;
-    Mur1.vboID = vboCube;
-    Mur2.vboID = vboCube;
-    Mur3.vboID = vboCube;
-    Plafond.vboID = vboCube;
-
-    TigeLampe.vboID = vboCube;
-    BaseLampe.vboID = vboCone;
-    Ampoule.vboID = vboSphere;
-
-
-    Table.vboID = vboCube;
-
-    Pied1.vboID = vboCube;
-    Pied2.vboID = vboCube;
-    Pied3.vboID = vboCube;
-    Pied4.vboID = vboCube;
-
-    BordC1.vboID = vboCube;
-    BordC2.vboID = vboCube;
-    BordL1.vboID = vboCube;
-    BordL2.vboID = vboCube;
-
-    Sol.mtl = solMtl;
-    Mur1.mtl = murMtl;
-    Mur2.mtl = murMtl;
-    Mur3.mtl = murMtl;
-    Plafond.mtl = murMtl;
-
-    TigeLampe.mtl = metalMtl;
-    BaseLampe.mtl = metalMtl;
-    Ampoule.mtl = verreMtl;
-
-    Table.mtl = tableMtl;
-
-    Pied1.mtl = boisMtl;
-    Pied2.mtl = boisMtl;
-    Pied3.mtl = boisMtl;
-    Pied4.mtl = boisMtl;
-
-    BordC1.mtl = boisMtl;
-    BordC2.mtl = boisMtl;
-    BordL1.mtl = boisMtl;
-    BordL2.mtl = boisMtl;
-
-    Sol.shader = shader;
-    Mur1.shader = shader;
-    Mur2.shader = shader;
-    Mur3.shader = shader;
-    Plafond.shader = shader;
-
-    TigeLampe.shader = shader;
-    BaseLampe.shader = shader;
-    Ampoule.shader = shader;
-
-    Table.shader = shader;
-
-    Pied1.shader = shader;
-    Pied2.shader = shader;
-    Pied3.shader = shader;
-    Pied4.shader = shader;
-
-    BordC1.shader = shader;
-    BordC2.shader = shader;
-    BordL1.shader = shader;
-    BordL2.shader = shader;
-
-    Sol.matrix_local = glm::mat4(1.0f);
-    Sol.matrix_local = glm::scale(Sol.matrix_local, glm::vec3(coteSolPlafondMur, epaisseurSolplafondMur, coteSolPlafondMur));
-    Sol.matrix_propagated = glm::mat4(1.0f);
-    Sol.matrix_propagated = glm::translate(Sol.matrix_propagated, glm::vec3(0.0f, 0.0f, -10.0f));
-
-    Plafond.matrix_local = glm::mat4(1.0f);
-    Plafond.matrix_local = glm::scale(Plafond.matrix_local, glm::vec3(coteSolPlafondMur, epaisseurSolplafondMur, coteSolPlafondMur));
-    Plafond.matrix_propagated = glm::mat4(1.0f);
-    Plafond.matrix_propagated = glm::translate(Plafond.matrix_propagated, glm::vec3(0.0f , hauteurMur, 0.0f));
-
-    Mur1.matrix_local = glm::mat4(1.0f);
-    Mur1.matrix_local = glm::scale(Mur1.matrix_local, glm::vec3(epaisseurSolplafondMur, hauteurMur, coteSolPlafondMur));
-    Mur1.matrix_propagated = glm::mat4(1.0f);
-    Mur1.matrix_propagated = glm::translate(Mur1.matrix_propagated, glm::vec3(-0.5f * coteSolPlafondMur + 0.5f * epaisseurSolplafondMur, - 0.5f * epaisseurSolplafondMur + 0.5f*hauteurMur, 0.0f));
-
-    Mur2.matrix_local = glm::mat4(1.0f);
-    Mur2.matrix_local = glm::scale(Mur2.matrix_local, glm::vec3(coteSolPlafondMur, hauteurMur, epaisseurSolplafondMur));
-    Mur2.matrix_propagated = glm::mat4(1.0f);
-    Mur2.matrix_propagated = glm::translate(Mur2.matrix_propagated, glm::vec3(0.0f, -0.5f * epaisseurSolplafondMur + 0.5f * hauteurMur, -0.5f * coteSolPlafondMur + 0.5f * epaisseurSolplafondMur));
-
-    Mur3.matrix_local = glm::mat4(1.0f);
-    Mur3.matrix_local = glm::scale(Mur3.matrix_local, glm::vec3(epaisseurSolplafondMur, hauteurMur, coteSolPlafondMur));
-    Mur3.matrix_propagated = glm::mat4(1.0f);
-    Mur3.matrix_propagated = glm::translate(Mur3.matrix_propagated, glm::vec3(0.5f * coteSolPlafondMur - 0.5f * epaisseurSolplafondMur, - 0.5f * epaisseurSolplafondMur + 0.5f*hauteurMur, 0.0f));
-
-    TigeLampe.matrix_local = glm::mat4(1.0f);
-    TigeLampe.matrix_local = glm::scale(TigeLampe.matrix_local, glm::vec3(coteTige, hauteurTige, coteTige));
-    TigeLampe.matrix_propagated = glm::mat4(1.0f);
-    TigeLampe.matrix_propagated = glm::translate(TigeLampe.matrix_propagated, glm::vec3(0.0f, -0.5f * epaisseurSolplafondMur - 0.5f * hauteurTige, 0.0f));
-
-    BaseLampe.matrix_local = glm::mat4(1.0f);
-    BaseLampe.matrix_local = glm::rotate(BaseLampe.matrix_local, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-    BaseLampe.matrix_local = glm::scale(BaseLampe.matrix_local, glm::vec3(1.3f, 1.3f, 1.3f));
-    BaseLampe.matrix_propagated = glm::mat4(1.0f);
-    BaseLampe.matrix_propagated = glm::translate(BaseLampe.matrix_propagated, glm::vec3(0.0f,- 0.5f * hauteurTige - 0.5f, 0.0f));
-
-    Ampoule.matrix_local = glm::mat4(1.0f);
-    //Ampoule.matrix_local = glm::scale(Ampoule.matrix_local, glm::vec3(0.8f, 0.8f, 0.8f));
-    Ampoule.matrix_propagated = glm::mat4(1.0f);
-    Ampoule.matrix_propagated = glm::translate(Ampoule.matrix_propagated, glm::vec3(0.0f, -0.5f, 0.0f));
-
-    Pied1.matrix_local = glm::mat4(1.0f);
-    Pied1.matrix_propagated = glm::mat4(1.0f);
-    Pied1.matrix_propagated = glm::translate(Pied1.matrix_propagated, glm::vec3(-0.5f * longueurTable + 0.5f * longueurPieds, -0.5f * hauteurPieds - 0.5f * hauteurTable, -0.5f * largeurTable + 0.5f * largeurPieds));
-    Pied1.matrix_propagated = glm::scale(Pied1.matrix_propagated, glm::vec3(longueurPieds, hauteurPieds, largeurPieds));
-
-    Pied2.matrix_local = glm::mat4(1.0f);
-    Pied2.matrix_propagated = glm::mat4(1.0f);
-    Pied2.matrix_propagated = glm::translate(Pied2.matrix_propagated, glm::vec3(-0.5f * longueurTable + 0.5f * longueurPieds, -0.5f * hauteurPieds - 0.5f * hauteurTable, 0.5f * largeurTable - 0.5f * largeurPieds));
-    Pied2.matrix_propagated = glm::scale(Pied2.matrix_propagated, glm::vec3(longueurPieds, hauteurPieds, largeurPieds));//local
-
-    Pied3.matrix_local = glm::mat4(1.0f);
-    Pied3.matrix_propagated = glm::mat4(1.0f);
-    Pied3.matrix_propagated = glm::translate(Pied3.matrix_propagated, glm::vec3(0.5f * longueurTable - 0.5f * longueurPieds, -0.5f * hauteurPieds - 0.5f * hauteurTable, -0.5f * largeurTable + 0.5f * largeurPieds));
-    Pied3.matrix_propagated = glm::scale(Pied3.matrix_propagated, glm::vec3(longueurPieds, hauteurPieds, largeurPieds));
-
-    Pied4.matrix_local = glm::mat4(1.0f);
-    Pied4.matrix_propagated = glm::mat4(1.0f);
-    Pied4.matrix_propagated = glm::translate(Pied4.matrix_propagated, glm::vec3(0.5f * longueurTable - 0.5f * longueurPieds, -0.5f * hauteurPieds - 0.5f * hauteurTable, 0.5f * largeurTable - 0.5f * largeurPieds));
-    Pied4.matrix_propagated = glm::scale(Pied4.matrix_propagated, glm::vec3(longueurPieds, hauteurPieds, largeurPieds));
-
-    BordC1.matrix_local = glm::mat4(1.0f);
-    BordC1.matrix_propagated = glm::mat4(1.0f);
-    BordC1.matrix_propagated = glm::translate(BordC1.matrix_propagated, glm::vec3(-0.5f * longueurTable - 0.5f * longueurBordC, 0.0f, 0.0f));
-    BordC1.matrix_propagated = glm::scale(BordC1.matrix_propagated, glm::vec3(longueurBordC, hauteurBord, largeurBordC));
-
-    BordC2.matrix_local = glm::mat4(1.0f);
-    BordC2.matrix_propagated = glm::mat4(1.0f);
-    BordC2.matrix_propagated = glm::translate(BordC2.matrix_propagated, glm::vec3(0.5f * longueurTable + 0.5f * longueurBordC, 0.0f, 0.0f));
-    BordC2.matrix_propagated = glm::scale(BordC2.matrix_propagated, glm::vec3(longueurBordC, hauteurBord, largeurBordC));
-
-    BordL1.matrix_local = glm::mat4(1.0f);
-    BordL1.matrix_propagated = glm::mat4(1.0f);
-    BordL1.matrix_propagated = glm::translate(BordL1.matrix_propagated, glm::vec3(0.0f, 0.0f, -0.5f * largeurTable - 0.5f * largeurBordL));
-    BordL1.matrix_propagated = glm::scale(BordL1.matrix_propagated, glm::vec3(longueurBordL, hauteurBord, largeurBordL));
-
-    BordL2.matrix_local = glm::mat4(1.0f);
-    BordL2.matrix_propagated = glm::mat4(1.0f);
-    BordL2.matrix_propagated = glm::translate(BordL2.matrix_propagated, glm::vec3(0.0f, 0.0f, 0.5f * largeurTable + 0.5f * largeurBordL));
-    BordL2.matrix_propagated = glm::scale(BordL2.matrix_propagated, glm::vec3(longueurBordL, hauteurBord, largeurBordL));
+    //Scene : chaque forme n'est envoyee qu'une fois a la carte graphique, tous les objets qui l'utilisent la partagent.
+    //Sommets entrelaces et compresses (16 octets au lieu de 32) : les shaders decodent les normales octaedriques
+    VertexFormat format = VertexFormat::packed();
+    Scene* scene = new Scene();
+
+    //La piece, la lampe et la table sont decrites dans Assets/salle.scene. Le fichier texte n'est analyse que s'il est
+    //plus recent que sa version compilee : sinon le bloc binaire est projete en memoire et instancie tel quel
+    SceneLibrary bibliotheque(shader, format);
+    bibliotheque.addMesh("cube", &cube);
+    bibliotheque.addMesh("cone", &cone);
+    bibliotheque.addMesh("sphere", &sphere);
+    bibliotheque.addMaterial("verre", &verreMtl);
+    bibliotheque.addMaterial("metal", &metalMtl);
+    bibliotheque.addMaterial("mur", &murMtl);
+    bibliotheque.addMaterial("sol", &solMtl);
+    bibliotheque.addMaterial("bois", &boisMtl);
+    bibliotheque.addMaterial("table", &tableMtl);
+
+    SceneFile* salle = SceneFile::openCompiled("Assets/salle.scene", "Assets/salle.scnb");
+    if (salle == nullptr) {
+        std::cerr << "The scene 'salle' did not load correctly. Exiting." << std::endl;
+        return EXIT_FAILURE;
+    }
+    scene->load(*salle, bibliotheque);
+
+    //Les dimensions utilisees par le programme viennent du meme fichier
+    float epaisseurSolplafondMur = salle->getVar("epaisseurSolplafondMur");
+    float longueurTable = salle->getVar("longueurTable");
+    float hauteurTable = salle->getVar("hauteurTable");
+    float largeurTable = salle->getVar("largeurTable");
+    float hauteurPieds = salle->getVar("hauteurPieds");
+    float rayonBoules = salle->getVar("rayonBoules");
+    BallPhysics physique(parametresPhysique(*salle), modePhysique);
+    delete salle;
+
+    //La table tourne : ses matrices sont mises a jour a chaque image. Les noms ne sont cherches qu'a la construction
+    PartHandle table = scene->findPart("Table");
 
     //Boules
-    float scaleBoules = 0.25f;
-    float rayonBoules = scaleBoules * 0.5f;
+    float scaleBoules = 2 * rayonBoules; //la sphere est de rayon 0.5
     float distBoules = 2 * rayonBoules;
 
 
-    GameObjectGraph Boules[16];
-
-    Table.children.push_back(&Boules[8]);
-    Table.children.push_back(&Boules[0]);
+    std::vector<Material> boulesMtl(16, bouleMtl); //chaque boule a sa propre couleur
+
+    //Toutes les textures des boules dans un seul tableau de textures : la boule n utilise la couche n-1
+    std::vector<std::string> texturesBoules;
+    for (int i = 1; i <= NB_TEXTURE_BOULE; i++)
+        texturesBoules.push_back("Assets/Boule_" + std::to_string(i) + ".png");
+    TextureArray* texBoules = new TextureArray(texturesBoules);
+
+    //Toutes les boules sont dessinees en un seul appel, avec le meme mesh que les noeuds des boules
+    MeshHandle sphereMesh = MeshRegistry::acquire(sphere, format);
+    InstanceBatch* lotBoules = new InstanceBatch(sphereMesh.get(), texBoules, &bouleMtl);
+
+    //Le monde : les composants de tous les objets (transformation, noeud, materiau, corps, lumiere) dans des tableaux
+    //contigus par archetype, lus par le rendu et la physique au lieu de suivre les pointeurs du graphe
+    World world;
+    TransformComponent transformLumiere;
+    transformLumiere.position = light.getPosition();
+    world.create(transformLumiere, LightComponent{&light});
+
+    //La table : ses dimensions sont l'echelle de sa transformation
+    TransformComponent transformTable;
+    transformTable.position = glm::vec3(0.0f, 0.5f*epaisseurSolplafondMur+hauteurPieds, 0.0f);
+    transformTable.scale = glm::vec3(longueurTable, hauteurTable, largeurTable);
+    Entity entiteTable = world.create(transformTable, MeshComponent{table}, MaterialComponent{&tableMtl});
+
+    //Chaque boule est un enfant de la table, avec son noeud, son materiau et son corps
+    Entity entitesBoules[16];
+    auto creerBoule = [&](int n, glm::vec3 position, glm::quat rotation) {
+        SceneNode* noeud = scene->createNode(&sphere, glm::mat4(1.0f), format);
+        noeud->setProgram(shader);
+        noeud->setInstances(lotBoules, n - 1); //La boule blanche (n = 0) n'a pas de texture
+        TransformComponent transform;
+        transform.position = position;
+        transform.rotation = rotation;
+        transform.scale = glm::vec3(scaleBoules);
+        BodyComponent corps;
+        corps.radius = rayonBoules;
+        entitesBoules[n] = world.create(transform, MeshComponent{scene->addPart("Boule" + std::to_string(n), table, noeud)},
+                                        MaterialComponent{&boulesMtl[n]}, corps);
+    };
 
     int ordre_boules[NB_TEXTURE_BOULE] = { 9, 12, 7, 1, 8, 15, 14, 3, 10, 6, 5, 4, 13, 2, 11 };
 
-    //La boule blanche n'a pas de texture et n'est pas dans le triangle
-    Boules[0].nb_vertices = sphere.getNbVertices();
-    Boules[0].mtl = bouleMtl;
-    Boules[0].vboID = vboSphere;
-    Boules[0].shader = shader;
-
-    Boules[0].matrix_local = glm::mat4(1.0f);
-    Boules[0].matrix_propagated = glm::mat4(1.0f);
-    Boules[0].matrix_propagated = glm::translate(Boules[0].matrix_propagated, glm::vec3(-0.5f * longueurTable + 1.0f, 0.5f * hauteurTable + rayonBoules, 0.0f));
-    Boules[0].matrix_propagated = glm::scale(Boules[0].matrix_propagated, glm::vec3(scaleBoules, scaleBoules, scaleBoules));
+    //La boule blanche n'est pas dans le triangle
+    creerBoule(0, glm::vec3(-0.5f * longueurTable + 1.0f, 0.5f * hauteurTable + rayonBoules, 0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
 
-    //Variables pour le positionnement des boules du triangle
+    //Variables pour le positionnement des boules du triangle, autour de la boule du milieu
+    glm::vec3 positionMilieu = glm::vec3(0.5f * longueurTable - 2.0f, 0.5f * hauteurTable + rayonBoules, 0.0f);
     float h = sqrt(3) / 2 * distBoules; //par le thorme de Pythagore : dist = h + (dist/2) avec dist/2 = demi_dist
     float x = -2 * h; //Position x de dpart pour que la boule du milieu (boule n8) est un x de 0
     float y_min = 0;
@@ -496,15 +328,6 @@ int main(int argc, char* argv[])
 
             float y = y_min + distBoules * j;
 
-            //Proprits de la boule
-            Boules[num_boule_n].nb_vertices = sphere.getNbVertices();
-            Boules[num_boule_n].mtl = bouleMtl;
-            Boules[num_boule_n].vboID = vboSphere;
-
-            //Placement de la boule
-            Boules[num_boule_n].matrix_local = glm::mat4(1.0f);
-            Boules[num_boule_n].matrix_propagated = glm::mat4(1.0f);
-
             int rand_rotation = rand();
             int bool_axeX = rand() % 2;
             int bool_axeY = rand() % 2;
@@ -512,23 +335,10 @@ int main(int argc, char* argv[])
             if (bool_axeX == 0 && bool_axeY == 0) {
                 bool_axeZ = 1; //il ne faut pas que les 3 axes soient sur 0
             }
+            glm::vec3 axe = glm::normalize(glm::vec3(bool_axeX % 2, bool_axeY % 2, bool_axeZ % 2));
 
-            Boules[num_boule_n].matrix_local = glm::rotate(Boules[num_boule_n].matrix_local, (float)rand_rotation, glm::vec3(bool_axeX % 2, bool_axeY % 2, bool_axeZ % 2)); //Rotation alatoire des boules
-
-            if (boule_n != 4) {//Pas la boule du milieu
-                Boules[ordre_boules[4]].children.push_back(&Boules[num_boule_n]);
-                Boules[num_boule_n].matrix_propagated = glm::translate(Boules[num_boule_n].matrix_propagated, glm::vec3(x, 0.0f, y));
-            }
-            else { //Boule du milieu
-                Boules[num_boule_n].matrix_propagated = glm::translate(Boules[num_boule_n].matrix_propagated, glm::vec3(0.5f * longueurTable - 2.0f, 0.5f * hauteurTable + rayonBoules, 0.0f));
-            }
-
-            Boules[num_boule_n].matrix_local = glm::scale(Boules[num_boule_n].matrix_local, glm::vec3(scaleBoules, scaleBoules, scaleBoules));
-
-
-            Boules[num_boule_n].mtl.setColor({0,0,0});
-            Boules[num_boule_n].mtl.setTexture(new Texture("Assets/Boule_" + std::to_string(num_boule_n) + ".png")); //Donner la texture  la Boule
-            Boules[num_boule_n].shader = shader;
+            boulesMtl[num_boule_n].setColor({0,0,0}); //La couleur vient de la texture
+            creerBoule(num_boule_n, positionMilieu + glm::vec3(x, 0.0f, y), glm::angleAxis((float)rand_rotation, axe)); //Rotation alatoire des boules
 
             boule_n++;
         }
@@ -536,36 +346,51 @@ int main(int argc, char* argv[])
         x = x + h;
     }
 
+    //Les boules dans la physique, qui ecrit leurs positions dans leurs entites a chaque image
+    uint32_t blanche = physique.addBall(world, entitesBoules[0]);
+    for (int n = 1; n < 16; n++)
+        physique.addBall(world, entitesBoules[n]);
 
 
+
+    //Cuisson des objets statiques : un seul appel de dessin par materiau et par ancre
+    scene->bakeStatic(format);
+    scene->reportMemory();
+
     // lens flare initialization
-    Texture* texLight1 = new Texture("Assets/shape_0.png");
-    Texture* texLight2 = new Texture("Assets/shape_1.png");
-    Texture* texLight3 = new Texture("Assets/shape_2.png");
-    Texture* texLight4 = new Texture("Assets/shape_3.png");
-    Texture* texLight5 = new Texture("Assets/shape_4.png");
-    Texture* texLight6 = new Texture("Assets/shape_5.png");
-    Texture* texLight7 = new Texture("Assets/shape_6.png");
-    Texture* texLight8 = new Texture("Assets/shape_7.png");
-    Texture* texLight9 = new Texture("Assets/shape_8.png");
+    //Les textures appartiennent a main (LensFlare ne fait que les utiliser) : texLights[n] est Assets/shape_n.png
+    std::vector<std::unique_ptr<Texture>> texLights;
+    for (int i = 0; i < 9; i++)
+        texLights.emplace_back(new Texture("Assets/shape_" + std::to_string(i) + ".png"));
     LensFlare::Init();
     LensFlare::setLight(&light);
-    LensFlare::addTexture(texLight6, 1.f);
-    LensFlare::addTexture(texLight4, 0.46f);
-    LensFlare::addTexture(texLight2, 0.2f);
-    LensFlare::addTexture(texLight7, 0.1f);
-    LensFlare::addTexture(texLight1, 0.04f);
-    LensFlare::addTexture(texLight3, 0.12f);
-    LensFlare::addTexture(texLight9, 0.24f);
-    LensFlare::addTexture(texLight5, 0.14f);
-    LensFlare::addTexture(texLight1, 0.024f);
-    LensFlare::addTexture(texLight7, 0.4f);
-    LensFlare::addTexture(texLight9, 0.2f);
-    LensFlare::addTexture(texLight3, 0.14f);
-    LensFlare::addTexture(texLight5, 0.6f);
-    LensFlare::addTexture(texLight4, 0.8f);
-    LensFlare::addTexture(texLight8, 1.2f);
-
+    LensFlare::addTexture(texLights[5].get(), 1.f);
+    LensFlare::addTexture(texLights[3].get(), 0.46f);
+    LensFlare::addTexture(texLights[1].get(), 0.2f);
+    LensFlare::addTexture(texLights[6].get(), 0.1f);
+    LensFlare::addTexture(texLights[0].get(), 0.04f);
+    LensFlare::addTexture(texLights[2].get(), 0.12f);
+    LensFlare::addTexture(texLights[8].get(), 0.24f);
+    LensFlare::addTexture(texLights[4].get(), 0.14f);
+    LensFlare::addTexture(texLights[0].get(), 0.024f);
+    LensFlare::addTexture(texLights[6].get(), 0.4f);
+    LensFlare::addTexture(texLights[8].get(), 0.2f);
+    LensFlare::addTexture(texLights[2].get(), 0.14f);
+    LensFlare::addTexture(texLights[4].get(), 0.6f);
+    LensFlare::addTexture(texLights[3].get(), 0.8f);
+    LensFlare::addTexture(texLights[7].get(), 1.2f);
+
+
+    RenderQueue opaqueQueue(RenderQueue::DepthOrder::FrontToBack);
+    opaqueQueue.setLegacyAttribs(legacyAttribs);
+
+    //Ce que le rendu lit de la scene (matrices, materiaux, visibilite) est copie dans des images publiees par un index atomique :
+    //un fil de simulation pourra ecrire l'image N+1 pendant que le rendu soumet l'image N, sans verrou
+    RenderSnapshot snapshot;
+
+    //Les uniforms communs  toute l'image, puis ceux de chaque objet, passent par des uniform buffers
+    FrameUniformBuffer* frameUniforms = new FrameUniformBuffer();
+    UniformRing* objectUniforms = new UniformRing(OBJECT_BLOCK_BINDING, sizeof(ObjectBlock));
 
     Camera cam;
     bool mouseLock = false;
@@ -577,6 +402,11 @@ int main(int argc, char* argv[])
     bool keySpace = false;
     float mouseX = 0;
     float mouseY = 0;
+    bool casse = false; //la boule blanche est a lancer vers le triangle
+    bool empochees[16] = {};
+    uint32_t debutImage = SDL_GetTicks();
+    bool clic = false; //clic gauche a traiter (selection de l'objet sous la souris)
+    float clicX = 0, clicY = 0;
     //Main application loop
     float t = 0.5f;
     bool isOpened = true;
@@ -584,6 +414,8 @@ int main(int argc, char* argv[])
     {
         //Time in ms telling us when this frame started. Useful for keeping a fix framerate
         uint32_t timeBegin = SDL_GetTicks();
+        if (benchmarking) benchmark.beginFrame();
+        GLState::beginFrame();
 
         //Fetch the SDL events
         SDL_Event event;
@@ -611,6 +443,7 @@ int main(int argc, char* argv[])
                     case SDLK_SPACE: keySpace = true; break;
                     case SDLK_LSHIFT: keyShift = true; break;
                     case SDLK_LCTRL: SDL_ShowCursor(mouseLock); mouseLock = !mouseLock; break;
+                    case SDLK_b: casse = true; break;
                     default: break;
                 }
                 break;
@@ -630,6 +463,14 @@ int main(int argc, char* argv[])
                 mouseX = event.motion.x - WIDTH/2.f;
                 mouseY = -event.motion.y + HEIGHT/2.f;
                 break;
+            case SDL_MOUSEBUTTONDOWN:
+                if (event.button.button == SDL_BUTTON_LEFT && !mouseLock)
+                {
+                    clic = true;
+                    clicX = 2.f * event.button.x / WIDTH - 1.f;
+                    clicY = 1.f - 2.f * event.button.y / HEIGHT;
+                }
+                break;
                 //We can add more event, like listening for the keyboard or the mouse. See SDL_Event documentation for more details
             }
         }
@@ -652,21 +493,62 @@ int main(int argc, char* argv[])
 
         glm::mat4 projection = glm::perspective(45.0f, WIDTH / (float)HEIGHT, 0.01f, 1000.0f);
 
-        Table.matrix_local = glm::mat4(1.0f);
-        Table.matrix_local = glm::scale(Table.matrix_local, glm::vec3(longueurTable, hauteurTable, largeurTable));
-        Table.matrix_propagated = glm::mat4(1.0f);
-        Table.matrix_propagated = glm::translate(Table.matrix_propagated, glm::vec3(0.0f, 0.5f*epaisseurSolplafondMur+hauteurPieds, 0.0f));
-        Table.matrix_propagated = glm::rotate(Table.matrix_propagated, t, glm::vec3(0.0f, 1.0f, 0.0f));
+        TransformComponent* tourneTable = world.get<TransformComponent>(entiteTable);
+        tourneTable->rotation = glm::angleAxis(t, glm::vec3(0.0f, 1.0f, 0.0f));
+        tourneTable->moved = true;
 
         t += 0.01f;
 
+        //Physique : des pas fixes pour le temps ecoule depuis l'image precedente (au plus 0.1 s, apres une pause)
+        if (casse)
+        {
+            physique.hit(blanche, glm::vec2(10.0f, 0.2f * (rand() / (float)RAND_MAX - 0.5f)) * physique.getParams().unitsPerMeter); //10 m/s
+            casse = false;
+        }
+        physique.advance(std::min(timeBegin - debutImage, 100u) / 1000.0f);
+        debutImage = timeBegin;
+        physique.write(world);
+
+        //Les boules empochees disparaissent dans l'epaisseur de la table
+        for (int n = 0; n < 16; n++)
+        {
+            if (empochees[n] || physique.getState(n) != BallPhysics::State::Pocketed) continue;
+            empochees[n] = true;
+            world.get<TransformComponent>(entitesBoules[n])->position.y = 0.0f;
+            INFO("Boule %d empochee\n", n);
+        }
+
+        //Selection : le noeud le plus proche sous la souris
+        if (clic)
+        {
+            RayHit hit = scene->raycast(cam.getRay(projection, clicX, clicY));
+            if (hit) INFO("clic sur '%s' a %.2f (%.2f, %.2f, %.2f)\n", scene->getPartName(hit.node),
+                          hit.distance, hit.point.x, hit.point.y, hit.point.z);
+            clic = false;
+        }
+        //En benchmark, un rayon par image au centre de l'ecran
+        if (benchmarking)
+        {
+            benchmark.beginPick();
+            scene->raycast(cam.getRay(projection, 0.f, 0.f));
+            benchmark.endPick();
+        }
 
-        std::stack<glm::mat4> matrices;
-        matrices.push(glm::mat4(1.0f));
 
-        //APPEL A DRAW
-        draw(Sol, matrices, light, cam.getPos(), projection * cam.getMat());
+        //APPEL A DRAW : parcours du graphe (sans ce qui est hors du champ de la camera), tri puis envoi des appels de dessin
+        if (benchmarking) benchmark.beginSubmit();
+        FrameData frame = {cam.getMat(), projection, cam.getPos(), &light, 1};
+        frameUniforms->update(frame.view, frame.projection, frame.cameraPosition, frame.lights, frame.nbLights);
+        RenderSystem::sync(world, *scene); //les composants modifies vers les noeuds de la scene
+        scene->snapshot(snapshot, cam.getFrustum(projection));
+        opaqueQueue.begin(frame);
+        lotBoules->clear();
+        snapshot.acquire().submit(opaqueQueue);
+        opaqueQueue.sort();
+        opaqueQueue.submit(*objectUniforms);
+        lotBoules->draw();
         LensFlare::render(projection);
+        if (benchmarking) benchmark.endSubmit();
 
 
         //Display on screen (swap the buffer on screen and the buffer you are drawing on)
@@ -675,29 +557,33 @@ int main(int argc, char* argv[])
         //Time in ms telling us when this frame ended. Useful for keeping a fix framerate
         uint32_t timeEnd = SDL_GetTicks();
 
+        if (benchmarking)
+        {
+            benchmark.countStateCalls(GLState::getStats().issued, GLState::getStats().elided);
+            benchmark.countUpdatedNodes(scene->getNbUpdatedNodes(), scene->getNbNodes());
+            benchmark.countCulledNodes(scene->getNbDrawn(), scene->getNbCulled());
+            benchmark.endFrame();
+            if (benchmark.isDone()) isOpened = false;
+            continue;
+        }
+
         //We want FRAMERATE FPS
         if (timeEnd - timeBegin < TIME_PER_FRAME_MS)
             SDL_Delay((uint32_t)(TIME_PER_FRAME_MS)-(timeEnd - timeBegin));
     }
 
-    glDeleteBuffers(1, &vboCube);
-    glDeleteBuffers(1, &vboCone);
-    glDeleteBuffers(1, &vboSphere);
-    for (int i = 0; i < 16; i++)
-    {
-        if (Boules[i].mtl.getTexture() != nullptr) delete Boules[i].mtl.getTexture();
-    }
+    if (benchmarking)
+        benchmark.report(legacyAttribs ? "legacy attribs" : "vao");
+
+    delete lotBoules;
+    sphereMesh = MeshHandle();
+    delete scene; //detruit tous les noeuds (pool de la scene) et libere les meshes qui ne sont plus utilises
+    delete texBoules;
+    delete frameUniforms;
+    delete objectUniforms;
     LensFlare::Cleanup();
     delete shader;
-    delete texLight1;
-    delete texLight2;
-    delete texLight3;
-    delete texLight4;
-    delete texLight5;
-    delete texLight6;
-    delete texLight7;
-    delete texLight8;
-    delete texLight9;
+    texLights.clear(); //avant de detruire le contexte openGL
 
     //Free everything
     if (context != NULL)